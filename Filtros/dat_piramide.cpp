@@ -0,0 +1,48 @@
+// dat_piramide.cpp
+// Genera la pirámide min/max/media (<archivo>.pir) de una grabación .dat para
+// que signal_plotter.m, multi_signal_plotter.m o cualquier visor lean solo el
+// nivel de detalle que necesitan (ver bloques/dat_piramide.h).
+// Uso: ./dat_piramide <archivo.dat> [decimacion_min] [hilos]
+// Ejemplo: ./dat_piramide captura.dat 64
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "../bloques/dat_piramide.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Uso: " << argv[0] << " <archivo.dat> [decimacion_min] [hilos]" << std::endl;
+        return 1;
+    }
+    const std::string archivo = argv[1];
+    const uint64_t decimacion = argc > 2 ? std::stoull(argv[2]) : 64;
+    const unsigned hilos = argc > 3 ? std::stoul(argv[3]) : 0;
+    const std::string salida = archivo + ".pir";
+
+    try {
+        const auto t0 = std::chrono::steady_clock::now();
+        construir_piramide(archivo, salida, decimacion, hilos);
+        const double segundos =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        dat_piramide pir(salida, archivo);
+        const pir_header& h = pir.cabecera();
+        const double mb = h.tam_original / 1e6;
+        std::printf("%s: %u streams, %llu muestras por stream, %.1f MB en %.2f s (%.0f MB/s)\n",
+                    salida.c_str(), h.num_streams, (unsigned long long)h.num_items, mb, segundos,
+                    mb / segundos);
+        std::printf("%8s %14s %14s\n", "nivel", "decimación", "bins");
+        for (size_t l = 0; l < pir.niveles().size(); l++) {
+            const pir_nivel& nv = pir.niveles()[l];
+            std::printf("%8zu %14llu %14llu\n", l, (unsigned long long)nv.decimacion,
+                        (unsigned long long)nv.num_bins);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
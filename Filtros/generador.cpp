@@ -1,12 +1,15 @@
-#include <gnuradio/analog/sig_source.h>
-#include <gnuradio/blocks/add_blk.h>
-#include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/head.h>
 #include <gnuradio/top_block.h>
 #include <iostream>
 #include <chrono>
 
+#include "../bloques/dat_file_sink.h"
+#include "../bloques/multitone_source.h"
+#include "../bloques/opciones_scheduler.h"
+
+// Acepta las opciones --gr-* de bloques/opciones_scheduler.h
 int main(int argc, char** argv) {
+    const auto sched = opciones_scheduler::tomar(argc, argv);
 
     // Parámetros de la señal
     const float fs = 44000.0f; // Frecuencia de muestreo
@@ -18,44 +21,22 @@ int main(int argc, char** argv) {
 
     auto tb = gr::make_top_block("generador");
 
-    // Fuentes de señal
-    auto src1 = gr::analog::sig_source_f::make(fs, gr::analog::GR_SIN_WAVE, f1, 1.0, 0.0);
-    auto src2 = gr::analog::sig_source_f::make(fs, gr::analog::GR_SIN_WAVE, f2, 0.7, 0.0);
-    auto src3 = gr::analog::sig_source_f::make(fs, gr::analog::GR_SIN_WAVE, f3, 0.25, 0.0);
-
-    // Suma src1 + src2
-    auto adder1 = gr::blocks::add_ff::make();
-    // Suma (src1+src2) + src3
-    auto adder2 = gr::blocks::add_ff::make();
-
-    // Escribir header personalizado en signal.dat
-    std::ofstream outfile("signal.dat", std::ios::binary | std::ios::trunc);
-    if (outfile.is_open()) {
-        outfile << "fs=" << fs << "\n";
-        outfile << "datatype=float\n";
-        outfile << "datasize=" << sizeof(float)*1 << "\n";
-        auto now = std::chrono::system_clock::now();
-        auto now_sec = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        outfile << "timestamp=" << now_sec << "\n";
-        outfile.close();
-    } else {
-        std::cerr << "No se pudo abrir signal.dat para escribir el header." << std::endl;
-        return 1;
-    }
+    // Fuente de señal: suma de las tres senoidales en un solo bloque
+    // (frecuencia, amplitud, fase inicial)
+    auto src = multitone_source::make(fs, { { f1, 1.0, 0.0 },
+                                             { f2, 0.7, 0.0 },
+                                             { f3, 0.25, 0.0 } });
 
-    // Sink de archivo para una señal
-    auto sink = gr::blocks::file_sink::make(sizeof(float)*1, "signal.dat", true); // true: append mode
+    // Sink de archivo con cabecera binaria (fs, tipo de dato, tiempo de inicio)
+    auto sink = dat_file_sink::make("signal.dat", fs, dat_dtype::FLOAT32, 1, num_muestras);
 
     // Limitador de muestras para cada señal
     auto head = gr::blocks::head::make(sizeof(float), num_muestras);
 
     // Conexiones
-    tb->connect(src1, 0, adder1, 0);
-    tb->connect(src2, 0, adder1, 1);
-    tb->connect(adder1, 0, adder2, 0);
-    tb->connect(src3, 0, adder2, 1);
-    tb->connect(adder2, 0, head, 0);
+    tb->connect(src, 0, head, 0);
     tb->connect(head, 0, sink, 0);
+    sched.aplicar(tb, { src, head, sink });
 
     // Ejecutar flujo
     tb->start();
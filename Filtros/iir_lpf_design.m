@@ -57,3 +57,26 @@ end
 fprintf(fid, "};\n");
 fclose(fid);
 disp("📄 Declaraciones de vectores en C++: 'iir_coeficientes.txt'");
+
+% Mismo diseno como cascada de secciones de segundo orden (SOS).
+% El polinomio completo pierde precision con polos cerca del circulo
+% unitario; la cascada de biquads (sos_iir_filter) no.
+[z, p, k] = cheby1(n, rp, Wn);
+[sos, g] = zp2sos(z, p, k);
+
+fid = fopen("iir_sos.txt", "w");
+fprintf(fid, "// Secciones de segundo orden del filtro IIR pasa bajas (Chebyshev Tipo I)\n");
+fprintf(fid, "// Frecuencia de muestreo: %d Hz, Corte: %d Hz, BW transicion: %d Hz\n", fs, fc, transition_bw);
+fprintf(fid, "// Cada fila: {b0, b1, b2, a0, a1, a2}\n\n");
+fprintf(fid, "std::vector<std::vector<double>> sos = {\n");
+for i = 1:rows(sos)
+    fprintf(fid, "    {%.17g, %.17g, %.17g, %.17g, %.17g, %.17g}", sos(i,:));
+    if i < rows(sos)
+        fprintf(fid, ",");
+    endif
+    fprintf(fid, "\n");
+end
+fprintf(fid, "};\n");
+fprintf(fid, "double ganancia = %.17g;\n", g);
+fclose(fid);
+disp("📄 Secciones de segundo orden en C++: 'iir_sos.txt'");
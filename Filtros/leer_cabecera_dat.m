@@ -0,0 +1,102 @@
+% leer_cabecera_dat.m
+% Lee la cabecera de un archivo .dat y regresa sus campos y la posición (en
+% bytes) donde inician los datos.
+%
+% Soporta la cabecera binaria de bloques/dat_file.h (magic 'SENALDAT') y la
+% cabecera de texto anterior (fs=..., datatype=..., timestamp=...).
+%
+% Campos de 'header' (numéricos salvo que se indique):
+%   fs, num_streams, item_size, num_items, bloque_items, timestamp [s]
+%   layout    : 'intercalado' o 'planar' (texto)
+%   precision : tipo para fread, p. ej. 'float32' (texto)
+%   complejo  : true si cada muestra es un par (real, imag)
+
+function [header, data_start] = leer_cabecera_dat(filename)
+    fid = fopen(filename, 'rb', 'ieee-le');
+    if fid < 0
+        error('No se pudo abrir %s', filename);
+    end
+    magic = fread(fid, [1 8], 'char=>char');
+    if strcmp(magic, 'SENALDAT')
+        [header, data_start] = leer_cabecera_binaria(fid);
+    else
+        [header, data_start] = leer_cabecera_texto(fid);
+    end
+    fclose(fid);
+end
+
+% -------------------------------------------------------------------------
+% Cabecera binaria (ver bloques/dat_file.h)
+% -------------------------------------------------------------------------
+function [header, data_start] = leer_cabecera_binaria(fid)
+    version      = fread(fid, 1, 'uint32');
+    if version ~= 1
+        error('Versión de cabecera no soportada: %d', version);
+    end
+    data_start   = fread(fid, 1, 'uint32');
+    header.fs    = fread(fid, 1, 'float64');
+    header.num_streams = fread(fid, 1, 'uint32');
+    layout       = fread(fid, 1, 'uint32');
+    dtype        = fread(fid, 1, 'uint32');
+    header.item_size    = fread(fid, 1, 'uint32');
+    header.bloque_items = fread(fid, 1, 'uint64');
+    header.num_items    = fread(fid, 1, 'uint64');
+    header.timestamp    = fread(fid, 1, 'int64') / 1e9;
+
+    layouts = {'intercalado', 'planar'};
+    header.layout = layouts{layout + 1};
+
+    % dtype: 0 float32, 1 complex64, 2 int16, 3 int32, 4 float64, 5 uint8
+    precisiones = {'float32', 'float32', 'int16', 'int32', 'float64', 'uint8'};
+    header.precision = precisiones{dtype + 1};
+    header.complejo = (dtype == 1);
+
+    % num_items = 0 si el archivo no se cerró bien: se deduce del tamaño
+    if header.num_items == 0
+        fseek(fid, 0, 'eof');
+        header.num_items = floor((ftell(fid) - data_start) / ...
+                                 (header.num_streams * header.item_size));
+    end
+end
+
+% -------------------------------------------------------------------------
+% Cabecera de texto (formato anterior)
+% -------------------------------------------------------------------------
+function [header, data_start] = leer_cabecera_texto(fid)
+    frewind(fid);
+    campos = struct();
+    while true
+        line = fgetl(fid);
+        if ~ischar(line) || isempty(line)
+            break;
+        end
+        equal_sym_idx = strfind(line, '=');
+        if ~isempty(equal_sym_idx)
+            key   = strtrim(line(1:equal_sym_idx-1));
+            value = strtrim(line(equal_sym_idx+1:end));
+            campos.(key) = value;
+        end
+        if strncmp(line, 'timestamp=', 10)
+            break;
+        end
+    end
+    data_start = ftell(fid);
+
+    header.fs = str2double(campos.fs);
+    header.num_streams = 1;
+    if isfield(campos, 'num_streams')
+        header.num_streams = str2double(campos.num_streams);
+    end
+    header.item_size = str2double(campos.datasize);
+    header.layout = 'intercalado';
+    header.precision = 'float32';
+    header.complejo = false;
+    header.bloque_items = 0;
+    header.timestamp = str2double(campos.timestamp);
+    if isfield(campos, 'mux_format')
+        header.mux_format = str2num(campos.mux_format);
+    end
+    fseek(fid, 0, 'eof');
+    header.num_items = floor((ftell(fid) - data_start) / ...
+                             (header.num_streams * header.item_size));
+end
@@ -0,0 +1,82 @@
+% leer_piramide_dat.m
+% Lee de la pirámide min/max/media (<archivo>.dat.pir, generada con
+% ./dat_piramide) solo los bins de un stream en un rango de tiempo, con el
+% nivel más fino que no excede max_puntos. Así una grabación de varios GB se
+% grafica leyendo unos cuantos KB. Formato en bloques/dat_piramide.h.
+%
+% Si existe el .dat original (archivo_pir sin '.pir'), se verifica que no
+% haya cambiado desde que se construyó la pirámide (tamaño e inicio_ns).
+%
+% [t, mn, mx, media, decimacion] = leer_piramide_dat(archivo_pir, stream, t0, t1, max_puntos)
+%   stream     : índice del stream (1 = primero)
+%   t0, t1     : rango en segundos desde la primera muestra ([] = todo)
+%   max_puntos : bins a lo más (2000 por omisión)
+%   t          : centro de cada bin [s]
+
+function [t, mn, mx, media, decimacion] = leer_piramide_dat(archivo_pir, stream, t0, t1, max_puntos)
+    if nargin < 2, stream = 1; end
+    if nargin < 5, max_puntos = 2000; end
+
+    fid = fopen(archivo_pir, 'rb', 'ieee-le');
+    if fid < 0
+        error('No se pudo abrir %s (generarla con ./dat_piramide)', archivo_pir);
+    end
+    magic = fread(fid, [1 8], 'char=>char');
+    if ~strcmp(magic, 'SENALPIR') || fread(fid, 1, 'uint32') ~= 1
+        fclose(fid);
+        error('%s no es una pirámide válida', archivo_pir);
+    end
+    fread(fid, 1, 'uint32');                 % tam_cabecera
+    fs          = fread(fid, 1, 'float64');
+    num_streams = fread(fid, 1, 'uint32');
+    num_niveles = fread(fid, 1, 'uint32');
+    num_items   = fread(fid, 1, 'uint64');
+    fseek(fid, 48, 'bof');
+    inicio_ns    = fread(fid, 1, 'int64=>int64');
+    tam_original = fread(fid, 1, 'uint64=>uint64');
+    if stream < 1 || stream > num_streams
+        fclose(fid);
+        error('stream %d fuera de rango (1..%d)', stream, num_streams);
+    end
+    % Una pirámide de una grabación que se regeneró no sirve
+    archivo_dat = regexprep(archivo_pir, '\.pir$', '');
+    if ~strcmp(archivo_dat, archivo_pir) && exist(archivo_dat, 'file')
+        fid_dat = fopen(archivo_dat, 'rb', 'ieee-le');
+        fseek(fid_dat, 0, 'eof');
+        tam_dat = uint64(ftell(fid_dat));
+        fseek(fid_dat, 56, 'bof');
+        inicio_dat = fread(fid_dat, 1, 'int64=>int64');
+        fclose(fid_dat);
+        if tam_dat ~= tam_original || inicio_dat ~= inicio_ns
+            fclose(fid);
+            error('%s no corresponde a %s (cambió después de construirla): volver a correr ./dat_piramide %s', ...
+                  archivo_pir, archivo_dat, archivo_dat);
+        end
+    end
+
+    fseek(fid, 64, 'bof');
+    niveles = fread(fid, [3 num_niveles], 'uint64'); % decimacion; num_bins; offset
+
+    % Rango en muestras
+    if nargin < 3 || isempty(t0), t0 = 0; end
+    if nargin < 4 || isempty(t1), t1 = num_items / fs; end
+    i0 = max(0, floor(t0 * fs));
+    i1 = min(num_items, ceil(t1 * fs));
+
+    % Nivel más fino con a lo más max_puntos bins en el rango
+    l = find(ceil((i1 - i0) ./ niveles(1, :)) <= max_puntos, 1);
+    if isempty(l), l = num_niveles; end
+    decimacion = niveles(1, l);
+    num_bins   = niveles(2, l);
+
+    b0 = floor(i0 / decimacion);
+    b1 = min(num_bins, ceil(i1 / decimacion));
+    fseek(fid, niveles(3, l) + ((stream-1)*num_bins + b0) * 12, 'bof');
+    bins = fread(fid, [3, b1 - b0], 'float32');
+    fclose(fid);
+
+    mn    = bins(1, :);
+    mx    = bins(2, :);
+    media = bins(3, :);
+    t = ((b0:b1-1) + 0.5) * decimacion / fs;
+end
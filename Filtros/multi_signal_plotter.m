@@ -7,45 +7,111 @@ function multi_signal_plotter(filename)
     end
 
     % Leer la cabecera y la posición donde inicia la señal
-    [header, data_start] = parse_header(filename);
+    [header, data_start] = leer_cabecera_dat(filename);
     disp('Cabecera leída del archivo:');
     disp(header);
 
-    % Extraer frecuencia de muestreo, tamaño de datos, número de streams y formato de mux desde la cabecera
-    fs = str2double(header.fs);             % Frecuencia de muestreo [Hz]
-    datasize = str2double(header.datasize); % Tamaño de los datos en bytes
-    num_streams = str2double(header.num_streams); % Número de streams multiplexados
-    mux_format = str2num(header.mux_format); % Formato de multiplexado (vector)
-    if isempty(mux_format)
+    % Extraer frecuencia de muestreo, número de streams y formato de mux desde la cabecera
+    % (mux_format solo aplica al formato intercalado)
+    fs = header.fs;                   % Frecuencia de muestreo [Hz]
+    num_streams = header.num_streams; % Número de streams multiplexados
+    if isfield(header, 'mux_format') && ~isempty(header.mux_format)
+        mux_format = header.mux_format; % Formato de multiplexado (vector)
+    else
         mux_format = ones(1, num_streams); % Por defecto, 1 elemento por stream
     end
     items_per_cycle = sum(mux_format);
 
-    % Abrir el archivo y leer la señal en formato float32
-    fid = fopen(filename, 'rb');
-    fseek(fid, data_start, 'bof');
-    raw_data = fread(fid, inf, 'float32');
-    fclose(fid);
+    % Grabaciones largas: graficar la envolvente min/max de la pirámide
+    % (./dat_piramide archivo.dat) en lugar de cargar el archivo completo
+    archivo_pir = [filename '.pir'];
+    if header.num_items > 2e6 && exist(archivo_pir, 'file')
+        figure('Color', 'w', 'Position', [100 100 1100 500]);
+        colores = lines(num_streams);
+        hold on;
+        for s = 1:num_streams
+            [t, mn, mx, media, dec] = leer_piramide_dat(archivo_pir, s);
+            t = t * 1000; % Tiempo [ms]
+            fill([t fliplr(t)], [mn fliplr(mx)], colores(s, :), 'EdgeColor', 'none', ...
+                 'FaceAlpha', 0.3, 'HandleVisibility', 'off');
+            plot(t, media, 'Color', colores(s, :), 'LineWidth', 1.2);
+        end
+        hold off;
+        legend(arrayfun(@(i) sprintf('Señal %d', i), 1:num_streams, 'UniformOutput', false));
+        title(sprintf('Señales desde %s (min/max cada %d muestras)', filename, dec));
+        xlabel('Tiempo [ms]', 'FontSize', 12);
+        ylabel('Amplitud', 'FontSize', 12);
+        grid on;
+        box on;
+        set(gca, 'FontSize', 11, 'LineWidth', 1);
+        disp('Presiona una tecla para cerrar la gráfica...');
+        waitforbuttonpress;
+        return;
+    elseif header.num_items > 2e6
+        printf('Archivo grande: ./dat_piramide %s permite graficarlo sin cargarlo completo\n', filename);
+    end
 
-    printf('Datos leídos: %d elementos\n', length(raw_data));
+    % Valores de 'precision' por muestra: 2 para complejos (real, imag)
+    valores_por_item = 1 + header.complejo;
 
-    % Validar datos suficientes
-    num_cycles = floor(length(raw_data) / items_per_cycle);
-    if num_cycles < 1 || isempty(raw_data)
-        error('No se encontraron datos para graficar.');
-    end
-    signals = zeros(num_cycles, num_streams);
-    for i = 1:num_cycles
-        idx = (i-1)*items_per_cycle + 1;
+    fid = fopen(filename, 'rb', 'ieee-le');
+    if strcmp(header.layout, 'planar')
+        % Planar (bloques/dat_multi_sink.h): bloques de bloque_items muestras
+        % de cada stream. Un solo fread por stream, saltando los bloques de
+        % los demás streams.
+        bloque_bytes = header.bloque_items * header.item_size;
+        bloque_valores = header.bloque_items * valores_por_item;
+        num_bloques = ceil(header.num_items / header.bloque_items);
+        formato = sprintf('%d*%s', bloque_valores, header.precision);
+        signals = zeros(header.num_items, num_streams);
         for s = 1:num_streams
-            signals(i, s) = mean(raw_data(idx:idx + mux_format(s) - 1));
-            idx = idx + mux_format(s);
+            fseek(fid, data_start + (s-1)*bloque_bytes, 'bof');
+            x = fread(fid, num_bloques * bloque_valores, formato, ...
+                      (num_streams-1)*bloque_bytes);
+            if header.complejo
+                x = x(1:2:end) + 1i * x(2:2:end);
+            end
+            % El último bloque viene rellenado con ceros
+            n = min(length(x), header.num_items);
+            signals(1:n, s) = x(1:n);
+        end
+        num_cycles = header.num_items;
+        printf('Datos leídos: %d muestras por stream (planar)\n', num_cycles);
+    else
+        % Abrir el archivo y leer la señal con el tipo indicado en la cabecera
+        fseek(fid, data_start, 'bof');
+        raw_data = fread(fid, header.num_items * items_per_cycle * valores_por_item, header.precision);
+        if header.complejo
+            raw_data = raw_data(1:2:end) + 1i * raw_data(2:2:end);
+        end
+
+        printf('Datos leídos: %d elementos\n', length(raw_data));
+
+        % Validar datos suficientes
+        num_cycles = floor(length(raw_data) / items_per_cycle);
+        if num_cycles < 1 || isempty(raw_data)
+            fclose(fid);
+            error('No se encontraron datos para graficar.');
+        end
+        signals = zeros(num_cycles, num_streams);
+        for i = 1:num_cycles
+            idx = (i-1)*items_per_cycle + 1;
+            for s = 1:num_streams
+                signals(i, s) = mean(raw_data(idx:idx + mux_format(s) - 1));
+                idx = idx + mux_format(s);
+            end
         end
     end
+    fclose(fid);
 
     % Crear vector de tiempo en milisegundos
     t = (0:num_cycles-1) / fs * 1000; % Tiempo [ms]
 
+    % Complejos: se grafica la parte real
+    if header.complejo
+        signals = real(signals);
+    end
+
     % Graficar todas las señales
     figure('Color', 'w', 'Position', [100 100 1100 500]);
     if isempty(signals)
@@ -68,34 +134,6 @@ function multi_signal_plotter(filename)
     waitforbuttonpress;
 end
 
-% -------------------------------------------------------------------------
-% Función para leer la cabecera del archivo y encontrar inicio de datos
-% -------------------------------------------------------------------------
-function [header, data_start] = parse_header(filename)
-    header = struct();
-    fid = fopen(filename, 'rb');
-    data_start = 0;
-    while true
-        line = fgetl(fid);
-        if ~ischar(line) || isempty(line)
-            break;
-        end
-        equal_sym_idx = strfind(line, '=');
-        if ~isempty(equal_sym_idx)
-            key   = strtrim(line(1:equal_sym_idx-1));
-            value = strtrim(line(equal_sym_idx+1:end));
-            header.(key) = value;
-        end
-        if strncmp(line, 'timestamp=', 10)
-            break;
-        end
-    end
-    % Avanzar hasta el primer byte binario (descartar salto de línea final)
-    fseek(fid, 0, 'cof');
-    data_start = ftell(fid);
-    fclose(fid);
-end
-
 % Ejecutar la función principal si se llama el script directamente
 if ~isdeployed
     if nargin == 0
@@ -6,18 +6,41 @@ function signal_plotter()
     filename = 'signal.dat';
     
     % Leer la cabecera y la posicion donde inicia la señal
-    [header, data_start] = parse_header(filename);
+    [header, data_start] = leer_cabecera_dat(filename);
     disp('Cabecera leída del archivo:');
     disp(header);
 
-    % Extraer frecuencia de muestreo y tamaño de datos desde la cabecera
-    fs = str2double(header.fs);             % Frecuencia de muestreo [Hz]
-    datasize = str2double(header.datasize); % Tamaño de los datos (no usado directamente)
+    % Extraer frecuencia de muestreo desde la cabecera
+    fs = header.fs;                     % Frecuencia de muestreo [Hz]
 
-    % Abrir el archivo y leer la señal en formato float32
-    fid = fopen(filename, 'rb');        % rb: leer en modo binario
+    % Grabaciones largas: graficar la envolvente min/max de la pirámide
+    % (./dat_piramide signal.dat) en lugar de cargar el archivo completo
+    archivo_pir = [filename '.pir'];
+    if header.num_items > 2e6 && exist(archivo_pir, 'file')
+        [t, mn, mx, media, dec] = leer_piramide_dat(archivo_pir, 1);
+        t = t * 1000; % Tiempo [ms]
+        figure('Color', 'w', 'Position', [100 100 1100 500]);
+        fill([t fliplr(t)], [mn fliplr(mx)], [0.7 0.8 1], 'EdgeColor', 'none'); % Envolvente
+        hold on;
+        plot(t, media, 'b-', 'LineWidth', 1.2);                                  % Media por bin
+        hold off;
+        title(sprintf('Señal desde %s (min/max cada %d muestras)', filename, dec));
+        xlabel('Tiempo [ms]', 'FontSize', 12);
+        ylabel('Amplitud', 'FontSize', 12);
+        grid on;
+        box on;
+        set(gca, 'FontSize', 11, 'LineWidth', 1);
+        disp('Presiona una tecla para cerrar la gráfica...');
+        waitforbuttonpress;
+        return;
+    elseif header.num_items > 2e6
+        printf('Archivo grande: ./dat_piramide %s permite graficarlo sin cargarlo completo\n', filename);
+    end
+
+    % Abrir el archivo y leer la señal con el tipo indicado en la cabecera
+    fid = fopen(filename, 'rb', 'ieee-le'); % rb: leer en modo binario
     fseek(fid, data_start, 'bof');      % Saltar la cabecera. bof: beginning of file
-    signal = fread(fid, inf, 'float32');% Leer todos los datos como flotantes de 32 bits
+    signal = fread(fid, header.num_items, header.precision); % Leer las muestras
     fclose(fid);
 
     % Crear vector de tiempo en milisegundos
@@ -38,31 +61,5 @@ function signal_plotter()
     waitforbuttonpress;                                  % Espera interacción del usuario
 end
 
-% -------------------------------------------------------------------------
-% Función para leer la cabecera del archivo y encontrar donde inicia la señal
-% -------------------------------------------------------------------------
-function [header, data_start] = parse_header(filename)
-    header = struct();                 % Estructura para guardar los datos de la cabecera
-    fid = fopen(filename, 'rb');       % Abrir archivo en modo binario
-    data_start = 0;                    % Inicializar posición de inicio de datos
-    while true
-        line = fgetl(fid);             % Leer línea como texto
-        if ~ischar(line) || isempty(line)
-            break;                     % Salir si se llega al final o línea vacía
-        end
-        equal_sym_idx = strfind(line, '=');   % Buscar el símbolo '='
-        if ~isempty(equal_sym_idx)
-            key   = strtrim(line(1:equal_sym_idx-1));   % Extraer nombre del campo
-            value = strtrim(line(equal_sym_idx+1:end)); % Extraer valor
-            header.(key) = value;              % Guardar en la estructura de header
-        end
-        if strncmp(line, 'timestamp=', 10)
-            break;                     % Parar al encontrar 'timestamp='
-        end
-    end
-    data_start = ftell(fid);           % Guardar posición de inicio de datos binarios
-    fclose(fid);                       % Cerrar archivo
-end
-
 % Ejecutar la función principal al correr el script
 signal_plotter();
\ No newline at end of file
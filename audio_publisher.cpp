@@ -0,0 +1,96 @@
+// audio_publisher.cpp
+// Publica la tarjeta de sonido en un anillo de memoria compartida
+// (bloques/shm_ring.h) para que varios programas la usen a la vez sin abrir
+// el dispositivo: audio_recorder y msk_phase_soundcard aceptan
+// "shm:<nombre>" como dispositivo de entrada. El anillo queda en
+// /dev/shm/<nombre> mientras corre el programa.
+//
+// Uso: ./audio_publisher [opciones] <nombre> <dispositivo_entrada>
+//      ./audio_publisher [opciones] --wav archivo.wav <nombre>
+//
+// Opciones:
+//   --fs F         frecuencia de muestreo (48000 por omisión)
+//   --canales N    número de canales (1 por omisión)
+//   --anillo S     segundos de señal en el anillo: cuánto puede atrasarse un
+//                  lector antes de perder datos (10 por omisión)
+//   --modo M       permisos del anillo en octal (600 por omisión: solo este
+//                  usuario). Los lectores escriben en la cabecera, así que
+//                  para lectores de otro usuario hace falta 660 y un grupo
+//                  común
+//   --wav A        en lugar de la tarjeta, reproduce el WAV a tiempo real
+//                  (throttle) y en ciclo; para probar sin hardware
+//   --gr-...       opciones del scheduler (bloques/opciones_scheduler.h)
+// Corre hasta SIGINT o SIGTERM; al terminar los lectores leen lo que quede y
+// sus flujos terminan, aunque corran sin duración fija.
+// Ejemplo: ./audio_publisher --fs 48000 vlf hw:1,0 &
+//          ./audio_recorder --segmento 3600 0 vlf.wav shm:vlf &
+//          ./msk_phase_soundcard --headless --dispositivo shm:vlf
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/audio/source.h>
+#include <gnuradio/blocks/throttle.h>
+#include <gnuradio/blocks/wavfile_source.h>
+#include <cstdlib>
+#include <iostream>
+
+#include "bloques/ejecucion_headless.h"
+#include "bloques/opciones_scheduler.h"
+#include "bloques/shm_ring.h"
+
+int main(int argc, char** argv) {
+    double samp_rate = tomar_valor(argc, argv, "--fs", 48000);
+    int nchan = static_cast<int>(tomar_valor(argc, argv, "--canales", 1));
+    const double segundos_anillo = tomar_valor(argc, argv, "--anillo", 10.0);
+    const std::string archivo_wav = tomar_texto(argc, argv, "--wav", "");
+    const std::string texto_modo = tomar_texto(argc, argv, "--modo", "600");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+
+    if (argc != (archivo_wav.empty() ? 3 : 2)) {
+        std::cerr << "Uso: " << argv[0] << " [--fs F] [--canales N] [--anillo S] [--modo M] " << opciones_scheduler::AYUDA
+                  << " <nombre> <dispositivo_entrada>\n"
+                  << "     " << argv[0] << " [--anillo S] [--modo M] --wav archivo.wav <nombre>" << std::endl;
+        return 1;
+    }
+    const std::string nombre = argv[1];
+    char* fin = nullptr;
+    const unsigned long modo = std::strtoul(texto_modo.c_str(), &fin, 8);
+    if (texto_modo.empty() || *fin != '\0' || modo > 0777) {
+        std::cerr << "--modo espera permisos en octal, por ejemplo 660" << std::endl;
+        return 1;
+    }
+
+    auto tb = gr::make_top_block("audio_publisher");
+    gr::block_sptr src;    // fuente de todos los canales
+    gr::block_sptr canal0; // de donde sale el canal 0 hacia el anillo
+    std::vector<gr::basic_block_sptr> bloques;
+    if (archivo_wav.empty()) {
+        src = canal0 = gr::audio::source::make(samp_rate, argv[2], nchan);
+        bloques.push_back(src);
+    } else {
+        auto wav = gr::blocks::wavfile_source::make(archivo_wav.c_str(), true);
+        samp_rate = wav->sample_rate();
+        nchan = wav->channels();
+        // El sumidero toma lo mismo de cada canal: basta limitar uno
+        auto throttle = gr::blocks::throttle::make(sizeof(float), samp_rate);
+        tb->connect(wav, 0, throttle, 0);
+        src = wav;
+        canal0 = throttle;
+        bloques = { wav, throttle };
+    }
+
+    std::cout << "Publicando " << nchan << " canales a " << samp_rate << " Hz de '"
+              << (archivo_wav.empty() ? argv[2] : archivo_wav) << "' en /dev/shm/" << nombre << " ("
+              << segundos_anillo << " s de anillo)..." << std::endl;
+
+    auto sink = shm_ring_sink::make(nombre, nchan, samp_rate, segundos_anillo, static_cast<mode_t>(modo));
+    tb->connect(canal0, 0, sink, 0);
+    for (int c = 1; c < nchan; c++) {
+        tb->connect(src, c, sink, c);
+    }
+    bloques.push_back(sink);
+    sched.aplicar(tb, bloques);
+
+    ejecutar_headless(tb, src, samp_rate, false);
+    std::cout << "Cuadros publicados: " << sink->anillo().escritos() << std::endl;
+    return 0;
+}
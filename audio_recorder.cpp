@@ -1,52 +1,210 @@
 // audio_recorder.cpp
 // Programa de línea de comandos para grabar audio usando GNU Radio
-// Uso: ./audio_recorder <duracion_segundos> <archivo_salida.wav> <dispositivo_entrada>
+// Uso: ./audio_recorder [opciones] <duracion_segundos> <archivo_salida.wav> <dispositivo_entrada>
 // Ejemplo: ./audio_recorder 5 grabacion.wav hw:0,0
+//
+// Opciones (modo por segmentos, para monitoreo continuo):
+//   --segmento S   archivos de S segundos: <archivo_salida>_NNNNNN.wav más el
+//                  índice <archivo_salida>_segmentos.csv (ver bloques/wav_segment_sink.h)
+//   --buffer S     segundos de señal en el buffer hacia el disco (30 por omisión)
+//   --fs F         frecuencia de muestreo (44100 por omisión)
+//   --canales N    número de canales (1 por omisión)
+//   --pcm24        PCM de 24 bits en lugar de 16
+//   --float        float de 32 bits en lugar de PCM
+//   --dither       dither TPDF de ±1 LSB al convertir a PCM (sin --segmento ni --flac)
+//   --flac         compresión FLAC sin pérdidas en hilos aparte (ver
+//                  bloques/flac_sink.h), con o sin --segmento. Requiere
+//                  libsndfile y compilar con -DCON_FLAC -lsndfile (make FLAC=1)
+//   --por-canal    con --flac, un archivo por canal en lugar de intercalados;
+//                  cada canal se codifica en su propio hilo (intercalados: uno
+//                  solo para todos)
+//   --gr-...       buffers, CPUs y tiempo real del scheduler (ver
+//                  bloques/opciones_scheduler.h)
+// En modo por segmentos la duración se cuenta en muestras y con duración 0 la
+// grabación sigue hasta recibir SIGINT o SIGTERM.
+// Sin --segmento ni --flac se escribe un solo archivo con bloques/wav_sink.h
+// (RF64 si pasa de 4 GB); con duración 0 sigue hasta SIGINT o SIGTERM.
+// Con dispositivo "shm:<nombre>" se graba el anillo de memoria compartida
+// que publica audio_publisher (bloques/shm_ring.h) en lugar de abrir la
+// tarjeta; --fs y --canales se toman del anillo.
+// Ejemplo: ./audio_recorder --segmento 3600 --fs 48000 0 vlf.wav hw:0,0
+//          ./audio_recorder --flac --por-canal --canales 4 --fs 192000 --segmento 3600 0 vlf hw:1,0
 
 #include <gnuradio/top_block.h>
 #include <gnuradio/audio/source.h>
-#include <gnuradio/blocks/wavfile_sink.h>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
+#include "bloques/ejecucion_headless.h"
+#ifdef CON_FLAC
+#include "bloques/flac_sink.h"
+#endif
+#include "bloques/opciones_scheduler.h"
+#include "bloques/shm_ring.h"
+#include "bloques/wav_segment_sink.h"
+#include "bloques/wav_sink.h"
+
 int main(int argc, char** argv) {
+    const double segundos_segmento = tomar_valor(argc, argv, "--segmento", 0.0);
+    const double segundos_buffer = tomar_valor(argc, argv, "--buffer", 30.0);
+    // Parámetros por defecto: frecuencia de muestreo estándar, mono
+    double samp_rate = tomar_valor(argc, argv, "--fs", 44100);
+    int nchan = static_cast<int>(tomar_valor(argc, argv, "--canales", 1));
+    const bool pcm24 = tomar_opcion(argc, argv, "--pcm24");
+    const bool en_float = tomar_opcion(argc, argv, "--float");
+    const bool dither = tomar_opcion(argc, argv, "--dither");
+    const bool flac = tomar_opcion(argc, argv, "--flac");
+    [[maybe_unused]] const bool por_canal = tomar_opcion(argc, argv, "--por-canal");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+
     if (argc != 4) {
-        std::cerr << "Uso: " << argv[0] << " <duracion_segundos> <archivo_salida.wav> <dispositivo_entrada>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " [--segmento S] [--buffer S] [--fs F] [--canales N]"
+                  << " [--pcm24 | --float] [--dither] [--flac [--por-canal]] " << opciones_scheduler::AYUDA
+                  << " <duracion_segundos> <archivo_salida.wav> <dispositivo_entrada>"
+                  << std::endl;
         return 1;
     }
 
     int duracion = std::stoi(argv[1]);
-    // archivo_salida debe ser char* para wavfile_sink::make
-    char* archivo_salida = argv[2];
+    const std::string archivo_salida = argv[2];
     std::string dispositivo = argv[3];
 
-    // Parámetros por defecto
-    double samp_rate = 44100; // Frecuencia de muestreo estándar
-    int nchan = 1; // Mono
+    // Crear bloques de GNU Radio: la tarjeta o el anillo de otro proceso
+    gr::block_sptr src;
+    shm_ring_source::sptr shm_src;
+    const std::string shm = nombre_shm(dispositivo);
+    if (!shm.empty()) {
+        auto anillo = shm_ring::abrir(shm);
+        samp_rate = anillo->samp_rate();
+        nchan = anillo->canales();
+        src = shm_src = shm_ring_source::make(anillo);
+    } else {
+        src = gr::audio::source::make(samp_rate, dispositivo, nchan);
+    }
+    auto tb = gr::make_top_block("audio_recorder");
 
-    std::cout << "Grabando " << duracion << " segundos de audio desde '" << dispositivo << "' en '" << archivo_salida << "'..." << std::endl;
+    // Con shm: datos que el productor sobrescribió antes de leerlos
+    auto reportar_perdidas = [&]() {
+        if (shm_src) {
+            std::cout << "Anillo '" << shm << "': " << shm_src->perdidas() << " muestras perdidas en "
+                      << shm_src->huecos() << " huecos." << std::endl;
+        }
+    };
 
-    // Crear bloques de GNU Radio
-    auto src = gr::audio::source::make(samp_rate, dispositivo, nchan);
-    // wavfile_sink::make espera un const char* como primer argumento
-    auto sink = gr::blocks::wavfile_sink::make(static_cast<const char*>(archivo_salida),
-                                                1, 
-                                                samp_rate,
-                                                gr::blocks::FORMAT_WAV,
-                                                gr::blocks::FORMAT_PCM_16,
-                                                false);
+    // Prefijo de los archivos: el nombre de salida sin extensión
+    std::string prefijo = archivo_salida;
+    for (const std::string ext : { ".wav", ".flac" }) {
+        if (prefijo.size() > ext.size() &&
+            prefijo.compare(prefijo.size() - ext.size(), ext.size(), ext) == 0) {
+            prefijo.resize(prefijo.size() - ext.size());
+        }
+    }
 
-    // Crear top block
-    auto tb = gr::make_top_block("audio_recorder");
-    tb->connect(src, 0, sink, 0);
+    if (flac) {
+#ifdef CON_FLAC
+        if (en_float) {
+            std::cerr << "FLAC solo admite PCM de 16 o 24 bits." << std::endl;
+            return 1;
+        }
+        auto sink = flac_sink::make(prefijo,
+                                    nchan,
+                                    samp_rate,
+                                    por_canal ? flac_sink::disposicion::POR_CANAL
+                                              : flac_sink::disposicion::INTERCALADO,
+                                    pcm24 ? 24 : 16,
+                                    std::llround(segundos_segmento * samp_rate),
+                                    std::llround(duracion * samp_rate),
+                                    std::llround(segundos_buffer * samp_rate));
+        for (int c = 0; c < nchan; c++) {
+            tb->connect(src, c, sink, c);
+        }
+        sched.aplicar(tb, { src, sink });
+
+        std::cout << "Grabando " << (duracion > 0 ? std::to_string(duracion) + " segundos" : "sin límite")
+                  << " de audio desde '" << dispositivo << "' en FLAC"
+                  << (por_canal ? " (un archivo por canal)" : "") << " con prefijo '" << prefijo
+                  << "'..." << std::endl;
+
+        // Con duración el sumidero termina el flujo al contar las muestras
+        ejecutar_headless(tb, src, samp_rate, duracion > 0);
+
+        std::cout << "Grabación finalizada: " << sink->archivos() << " archivos, "
+                  << sink->descartados() << " muestras perdidas, ocupación máxima del buffer "
+                  << sink->ocupacion_maxima() / samp_rate << " s." << std::endl;
+        reportar_perdidas();
+        if (!sink->error().empty()) {
+            std::cerr << "La grabación se detuvo por un error: " << sink->error() << std::endl;
+            return 1;
+        }
+        return 0;
+#else
+        std::cerr << "Compilado sin FLAC: recompilar con make FLAC=1 (requiere libsndfile)." << std::endl;
+        return 1;
+#endif
+    }
 
-    // Iniciar grabación
-    tb->start();
-    std::this_thread::sleep_for(std::chrono::seconds(duracion));
-    tb->stop();
-    tb->wait();
+    if (segundos_segmento > 0) {
+        const auto fmt = en_float ? wav_segment_sink::formato::FLOAT
+                         : pcm24  ? wav_segment_sink::formato::PCM24
+                                  : wav_segment_sink::formato::PCM16;
+        auto sink = wav_segment_sink::make(prefijo,
+                                           nchan,
+                                           samp_rate,
+                                           std::llround(segundos_segmento * samp_rate),
+                                           fmt,
+                                           std::llround(duracion * samp_rate),
+                                           std::llround(segundos_buffer * samp_rate));
+        for (int c = 0; c < nchan; c++) {
+            tb->connect(src, c, sink, c);
+        }
+        sched.aplicar(tb, { src, sink });
 
-    std::cout << "Grabación finalizada." << std::endl;
+        std::cout << "Grabando " << (duracion > 0 ? std::to_string(duracion) + " segundos" : "sin límite")
+                  << " de audio desde '" << dispositivo << "' en segmentos de " << segundos_segmento
+                  << " s con prefijo '" << prefijo << "'..." << std::endl;
+
+        // Con duración el sumidero termina el flujo al contar las muestras
+        ejecutar_headless(tb, src, samp_rate, duracion > 0);
+
+        std::cout << "Grabación finalizada: " << sink->segmentos() << " segmentos, "
+                  << sink->descartados() << " muestras perdidas, ocupación máxima del buffer "
+                  << sink->ocupacion_maxima() / samp_rate << " s." << std::endl;
+        reportar_perdidas();
+        if (!sink->error().empty()) {
+            std::cerr << "La grabación se detuvo por un error: " << sink->error() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::cout << "Grabando " << (duracion > 0 ? std::to_string(duracion) + " segundos" : "sin límite")
+              << " de audio desde '" << dispositivo << "' en '" << archivo_salida << "'..." << std::endl;
+
+    // Buffers de ~4 MiB hacia el disco para cubrir --buffer segundos
+    const auto fmt = en_float ? wav_sink::formato::FLOAT
+                     : pcm24  ? wav_sink::formato::PCM24
+                              : wav_sink::formato::PCM16;
+    const double bytes_por_segundo = samp_rate * nchan * (pcm24 ? 3 : en_float ? 4 : 2);
+    const int buffers = std::max(2, static_cast<int>(std::ceil(segundos_buffer * bytes_por_segundo / (4 << 20))));
+    auto sink = wav_sink::make(archivo_salida, nchan, samp_rate, fmt, dither,
+                               std::llround(duracion * samp_rate), buffers);
+
+    // Conectar cada canal al sumidero
+    for (int c = 0; c < nchan; c++) {
+        tb->connect(src, c, sink, c);
+    }
+    sched.aplicar(tb, { src, sink });
+
+    // Con duración el sumidero termina el flujo al contar las muestras
+    ejecutar_headless(tb, src, samp_rate, duracion > 0);
+
+    std::cout << "Grabación finalizada: " << sink->muestras_escritas() << " muestras, "
+              << sink->esperas() << " esperas al disco." << std::endl;
+    reportar_perdidas();
+    if (!sink->error().empty()) {
+        std::cerr << "La grabación se detuvo por un error: " << sink->error() << std::endl;
+        return 1;
+    }
     return 0;
 }
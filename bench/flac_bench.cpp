@@ -0,0 +1,124 @@
+// flac_bench.cpp
+// Verifica que la codificación FLAC de flac_sink alcance a la captura en
+// tiempo real: codifica 'segundos' de una señal sintética de 'canales'
+// canales a 'fs' Hz con la misma organización de hilos que flac_sink (un
+// hilo por archivo), en archivos intercalados y por canal, y reporta el
+// factor de tiempo real y el tamaño contra PCM de 16 bits.
+//
+// La señal imita una estación VLF: ruido gaussiano de fondo más varias
+// portadoras de transmisores y zumbido de 60 Hz, distintas en cada canal.
+// Uso: ./flac_bench [segundos] [fs] [canales] [bits]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "../bloques/flac_sink.h"
+
+// Un segundo de señal por canal
+std::vector<std::vector<float>> generar_senal(int fs, int canales) {
+    const double portadoras[] = { 19800.0, 21400.0, 24000.0, 37500.0, 45900.0 };
+    std::mt19937 gen(1234);
+    std::normal_distribution<float> ruido(0.0f, 0.01f);
+
+    std::vector<std::vector<float>> x(canales, std::vector<float>(fs));
+    for (int c = 0; c < canales; c++) {
+        for (int i = 0; i < fs; i++) {
+            const double t = double(i) / fs;
+            double v = 0.05 * std::sin(2 * M_PI * 60.0 * t + c);
+            for (double f : portadoras) {
+                if (f < fs / 2.0) {
+                    v += 0.02 * std::cos(2 * M_PI * f * t + 0.7 * c);
+                }
+            }
+            x[c][i] = static_cast<float>(v) + ruido(gen);
+        }
+    }
+    return x;
+}
+
+uint64_t tamano(const std::string& archivo) {
+    struct stat st;
+    return ::stat(archivo.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+// Codifica en 'archivos' hilos; cada uno escribe 'segundos' veces su bloque
+double codificar(const std::vector<std::vector<float>>& bloques,
+                 const std::vector<std::string>& nombres,
+                 int canales_por_archivo, int fs, int bits, int segundos) {
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> hilos;
+    for (size_t a = 0; a < nombres.size(); a++) {
+        hilos.emplace_back([&, a]() {
+            flac_codificador archivo(nombres[a], canales_por_archivo, fs, bits);
+            for (int s = 0; s < segundos; s++) {
+                archivo.escribir(bloques[a].data(), fs);
+            }
+        });
+    }
+    for (auto& h : hilos) {
+        h.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    const int segundos = argc > 1 ? std::stoi(argv[1]) : 30;
+    const int fs = argc > 2 ? std::stoi(argv[2]) : 192000;
+    const int canales = argc > 3 ? std::stoi(argv[3]) : 4;
+    const int bits = argc > 4 ? std::stoi(argv[4]) : 16;
+
+    const auto senal = generar_senal(fs, canales);
+    const double bytes_pcm = double(segundos) * fs * canales * bits / 8;
+
+    std::cout << "Codificando " << segundos << " s de " << canales << " canales a " << fs
+              << " Hz, " << bits << " bits" << std::endl;
+
+    // Un archivo con los canales intercalados (un hilo)
+    std::vector<float> intercalado(size_t(fs) * canales);
+    for (int i = 0; i < fs; i++) {
+        for (int c = 0; c < canales; c++) {
+            intercalado[size_t(i) * canales + c] = senal[c][i];
+        }
+    }
+    const std::vector<std::string> nombre_int = { "flac_bench_intercalado.flac" };
+    const double t_int = codificar({ intercalado }, nombre_int, canales, fs, bits, segundos);
+
+    // Un archivo por canal (un hilo por canal)
+    std::vector<std::string> nombres_canal;
+    for (int c = 0; c < canales; c++) {
+        nombres_canal.push_back("flac_bench_ch" + std::to_string(c) + ".flac");
+    }
+    const double t_canal = codificar(senal, nombres_canal, 1, fs, bits, segundos);
+
+    uint64_t bytes_int = tamano(nombre_int[0]);
+    uint64_t bytes_canal = 0;
+    for (const auto& n : nombres_canal) {
+        bytes_canal += tamano(n);
+    }
+
+    std::printf("%-12s %10s %14s %12s\n", "disposición", "tiempo (s)", "tiempo real", "tamaño/PCM");
+    std::printf("%-12s %10.2f %13.1fx %12.3f\n", "intercalado", t_int, segundos / t_int,
+                bytes_int / bytes_pcm);
+    std::printf("%-12s %10.2f %13.1fx %12.3f\n", "por canal", t_canal, segundos / t_canal,
+                bytes_canal / bytes_pcm);
+
+    std::remove(nombre_int[0].c_str());
+    for (const auto& n : nombres_canal) {
+        std::remove(n.c_str());
+    }
+
+    // Con factor < 1 el buffer de flac_sink terminaría por llenarse
+    const bool alcanza = segundos / t_int > 1.0 && segundos / t_canal > 1.0;
+    std::cout << (alcanza ? "El codificador alcanza a la captura en tiempo real."
+                          : "El codificador NO alcanza a la captura en tiempo real.")
+              << std::endl;
+    return alcanza ? 0 : 1;
+}
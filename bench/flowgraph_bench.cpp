@@ -0,0 +1,357 @@
+// flowgraph_bench.cpp
+// Mide el rendimiento de los flujos del repo sin GUI ni throttle.
+//
+// Cada flujo se arma igual que en su programa original, pero termina en
+// head + null_sink y corre hasta procesar un número fijo de muestras. Para
+// cada flujo se reporta:
+//   * Mmuestras/s (muestras que pasan por head entre tiempo de pared)
+//   * tiempo dentro de work() de cada bloque (contadores de rendimiento)
+//   * ocupación promedio de los buffers de entrada y salida de cada bloque
+// Los resultados se escriben en JSON para compararlos entre versiones.
+//
+// Uso: ./flowgraph_bench [muestras] [archivo_json] [flujo ...]
+// Ejemplo: ./flowgraph_bench 20000000 bench_results.json fir iir
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/analog/sig_source.h>
+#include <gnuradio/analog/random_uniform_source.h>
+#include <gnuradio/blocks/add_blk.h>
+#include <gnuradio/blocks/add_const_ff.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/multiply.h>
+#include <gnuradio/blocks/multiply_const.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/uchar_to_float.h>
+#include <gnuradio/blocks/wavfile_sink.h>
+#include <gnuradio/blocks/wavfile_source.h>
+#include <gnuradio/filter/firdes.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../bloques/bit_source.h"
+#include "../bloques/ddc_frontend.h"
+#include "../bloques/fast_fir_filter.h"
+#include "../bloques/msk_if_modulator.h"
+#include "../bloques/multitone_source.h"
+#include "../bloques/polyphase_resampler.h"
+#include "../bloques/sliding_goertzel.h"
+#include "../bloques/sos_iir_filter.h"
+
+// Un flujo listo para correr y los bloques cuyos contadores se reportan
+struct flujo {
+    gr::top_block_sptr tb;
+    std::vector<gr::block_sptr> bloques;
+};
+
+// Constructor de flujo: recibe el número de muestras que debe dejar pasar head
+struct definicion_flujo {
+    std::string nombre;
+    std::function<flujo(uint64_t)> construir;
+};
+
+const double fs_filtros = 44000.0;
+const char* wav_temporal = "flowgraph_bench_msk.wav";
+
+/*************************************************/
+/*        Flujos (mismos parámetros que los      */
+/*        programas de Filtros/ y msktools/)     */
+/*************************************************/
+
+// Suma de tres senoidales de Filtros/generador.cpp
+static std::vector<gr::block_sptr> tres_tonos(gr::top_block_sptr, gr::block_sptr& salida) {
+    auto src = multitone_source::make(fs_filtros, { { 200.0, 1.0, 0.0 },
+                                                    { 2000.0, 0.7, 0.0 },
+                                                    { 5000.0, 0.5, 0.0 } });
+    salida = src;
+    return { src };
+}
+
+// La misma suma con tres sig_source_f y dos add_ff, como antes de multitone_source
+static std::vector<gr::block_sptr> tres_tonos_original(gr::top_block_sptr tb, gr::block_sptr& salida) {
+    auto src1 = gr::analog::sig_source_f::make(fs_filtros, gr::analog::GR_SIN_WAVE, 200.0, 1.0, 0.0);
+    auto src2 = gr::analog::sig_source_f::make(fs_filtros, gr::analog::GR_SIN_WAVE, 2000.0, 0.7, 0.0);
+    auto src3 = gr::analog::sig_source_f::make(fs_filtros, gr::analog::GR_SIN_WAVE, 5000.0, 0.5, 0.0);
+    auto adder1 = gr::blocks::add_ff::make();
+    auto adder2 = gr::blocks::add_ff::make();
+    tb->connect(src1, 0, adder1, 0);
+    tb->connect(src2, 0, adder1, 1);
+    tb->connect(adder1, 0, adder2, 0);
+    tb->connect(src3, 0, adder2, 1);
+    salida = adder2;
+    return { src1, src2, src3, adder1, adder2 };
+}
+
+static flujo flujo_generador(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_generador"), {} };
+    gr::block_sptr suma;
+    f.bloques = tres_tonos(f.tb, suma);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(suma, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(head);
+    return f;
+}
+
+static flujo flujo_generador_original(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_generador_original"), {} };
+    gr::block_sptr suma;
+    f.bloques = tres_tonos_original(f.tb, suma);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(suma, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(head);
+    return f;
+}
+
+static flujo flujo_fir(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_fir"), {} };
+    gr::block_sptr suma;
+    f.bloques = tres_tonos(f.tb, suma);
+    auto taps = gr::filter::firdes::low_pass(
+        1.0, fs_filtros, 1000.0, 500.0, gr::fft::window::win_type::WIN_HAMMING);
+    auto lpf = fast_fir_filter_fff::make(1, taps);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(suma, 0, lpf, 0);
+    f.tb->connect(lpf, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(lpf);
+    f.bloques.push_back(head);
+    return f;
+}
+
+static flujo flujo_iir(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_iir"), {} };
+    gr::block_sptr suma;
+    f.bloques = tres_tonos(f.tb, suma);
+    std::vector<std::vector<double>> sos = {
+        {1, 2, 1, 1, -0.97746570952828626, 0},
+        {1, 2, 1, 1, -1.9552449282905668, 0.95809476396529636},
+        {1, 2, 1, 1, -1.9569565669385418, 0.96575671195539026},
+        {1, 2, 1, 1, -1.9619284002690585, 0.97755373599175943},
+        {1, 1, 0, 1, -1.9719746293196025, 0.99215572006936104}
+    };
+    auto iir = sos_iir_filter::make(sos, 3.4806276624944196e-13);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(suma, 0, iir, 0);
+    f.tb->connect(iir, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(iir);
+    f.bloques.push_back(head);
+    return f;
+}
+
+// Símbolos +/-1 de msktools/random_bits_generator.cpp
+static flujo flujo_bits(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_bits"), {} };
+    auto bits = bit_source::make(bit_source::generador::XOSHIRO, bit_source::formato::SIMBOLOS_F, 1);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(bits, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques = { bits, head };
+    return f;
+}
+
+// Los mismos símbolos con la cadena de cuatro bloques de antes de bit_source
+static flujo flujo_bits_original(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_bits_original"), {} };
+    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, 0);
+    auto uchar_to_float = gr::blocks::uchar_to_float::make();
+    auto map_to_bipolar = gr::blocks::add_const_ff::make(-0.5);
+    auto scale_to_pm = gr::blocks::multiply_const_ff::make(2.0);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(rand_src, 0, uchar_to_float, 0);
+    f.tb->connect(uchar_to_float, 0, map_to_bipolar, 0);
+    f.tb->connect(map_to_bipolar, 0, scale_to_pm, 0);
+    f.tb->connect(scale_to_pm, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques = { rand_src, uchar_to_float, map_to_bipolar, scale_to_pm, head };
+    return f;
+}
+
+// Modulador de msktools/msk_modulator.cpp: bits aleatorios -> señal real en FI
+static std::vector<gr::block_sptr>
+modulador_msk(gr::top_block_sptr tb, double samp_rate, int samples_per_sym, gr::block_sptr& salida) {
+    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, 0);
+    auto msk_mod = msk_if_modulator::make(samples_per_sym, samp_rate, 800.0);
+    tb->connect(rand_src, 0, msk_mod, 0);
+    salida = msk_mod;
+    return { rand_src, msk_mod };
+}
+
+static flujo flujo_msk_modulador(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_msk_modulador"), {} };
+    gr::block_sptr fi;
+    f.bloques = modulador_msk(f.tb, 200.0 * 32, 32, fi);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(fi, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(head);
+    return f;
+}
+
+// msk_wav_generator a 44100 Hz: modulador a 42 muestras por bit (8400 Hz) y
+// remuestreo polifásico 21/4
+static flujo flujo_msk_remuestreado(uint64_t muestras) {
+    flujo f{ gr::make_top_block("bench_msk_remuestreado"), {} };
+    gr::block_sptr fi;
+    f.bloques = modulador_msk(f.tb, 200.0 * 42, 42, fi);
+    const double fs_mod = 200.0 * 42, banda = 800.0 + 2 * 200.0;
+    auto resampler = polyphase_resampler::make(polyphase_resampler::disenar(
+        21, 4, polyphase_resampler::disenar_taps(21, banda / fs_mod, (fs_mod - banda) / fs_mod)));
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto sink = gr::blocks::null_sink::make(sizeof(float));
+    f.tb->connect(fi, 0, resampler, 0);
+    f.tb->connect(resampler, 0, head, 0);
+    f.tb->connect(head, 0, sink, 0);
+    f.bloques.push_back(resampler);
+    f.bloques.push_back(head);
+    return f;
+}
+
+// Demodulador de msktools/msk_phase_wav.cpp sobre un WAV generado antes
+static flujo flujo_msk_fase_wav(uint64_t muestras) {
+    const int samp_rate = 48000;
+    {
+        // Preparación (no se mide): WAV con exactamente 'muestras' muestras
+        auto tb = gr::make_top_block("bench_wav_temporal");
+        gr::block_sptr fi;
+        modulador_msk(tb, samp_rate, samp_rate / 200, fi);
+        auto head = gr::blocks::head::make(sizeof(float), muestras);
+        auto wav = gr::blocks::wavfile_sink::make(
+            wav_temporal, 1, samp_rate, gr::blocks::FORMAT_WAV, gr::blocks::FORMAT_PCM_16);
+        tb->connect(fi, 0, head, 0);
+        tb->connect(head, 0, wav, 0);
+        tb->run();
+    }
+
+    flujo f{ gr::make_top_block("bench_msk_fase_wav"), {} };
+    auto wav_source = gr::blocks::wavfile_source::make(wav_temporal, false);
+    auto frontend = ddc_frontend::make(samp_rate, 800.0, 400.0, 200.0, 2.0);
+    const double bb_rate = frontend->tasa_salida();
+    auto mult = gr::blocks::multiply_cc::make();
+    auto goertzel = sliding_goertzel::make(bb_rate, { 100.0, -100.0 },
+                                           static_cast<int>(bb_rate * 0.5),
+                                           static_cast<int>(bb_rate * 0.1));
+    auto sink_pos = gr::blocks::null_sink::make(sizeof(gr_complex));
+    auto sink_neg = gr::blocks::null_sink::make(sizeof(gr_complex));
+
+    // El head va justo después de la fuente para contar muestras del WAV
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    f.tb->connect(wav_source, 0, head, 0);
+    f.tb->connect(head, 0, frontend, 0);
+    f.tb->connect(frontend, 0, mult, 0);
+    f.tb->connect(frontend, 0, mult, 1);
+    f.tb->connect(mult, 0, goertzel, 0);
+    f.tb->connect(goertzel, 0, sink_pos, 0);
+    f.tb->connect(goertzel, 1, sink_neg, 0);
+    f.bloques = { wav_source, head, frontend, mult, goertzel };
+    return f;
+}
+
+/*************************************************/
+/*              Ejecución y reporte              */
+/*************************************************/
+
+static std::string lista_json(const std::vector<float>& v) {
+    std::string s = "[";
+    for (size_t i = 0; i < v.size(); i++) {
+        char num[32];
+        std::snprintf(num, sizeof(num), "%s%.4f", i ? ", " : "", v[i]);
+        s += num;
+    }
+    return s + "]";
+}
+
+static void correr(const definicion_flujo& def, uint64_t muestras, std::ostream& json, bool primero) {
+    flujo f = def.construir(muestras);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    f.tb->run();
+    const auto t1 = std::chrono::steady_clock::now();
+    const double segundos = std::chrono::duration<double>(t1 - t0).count();
+    const double msps = muestras / segundos / 1e6;
+
+    std::cout << def.nombre << ": " << muestras << " muestras en " << segundos << " s ("
+              << msps << " Mmuestras/s)" << std::endl;
+
+    const double tps = static_cast<double>(gr::high_res_timer_tps());
+    json << (primero ? "" : ",\n") << "    {\n"
+         << "      \"nombre\": \"" << def.nombre << "\",\n"
+         << "      \"segundos\": " << segundos << ",\n"
+         << "      \"msps\": " << msps << ",\n"
+         << "      \"bloques\": [\n";
+    for (size_t i = 0; i < f.bloques.size(); i++) {
+        const auto& b = f.bloques[i];
+        const double work_s = b->pc_work_time_total() / tps;
+        std::cout << "    " << b->identifier() << ": work " << work_s << " s" << std::endl;
+        json << "        {\"bloque\": \"" << b->identifier() << "\""
+             << ", \"work_s\": " << work_s
+             << ", \"work_pct\": " << 100.0 * work_s / segundos
+             << ", \"buffer_entrada\": " << lista_json(b->pc_input_buffers_full_avg())
+             << ", \"buffer_salida\": " << lista_json(b->pc_output_buffers_full_avg())
+             << "}" << (i + 1 < f.bloques.size() ? "," : "") << "\n";
+    }
+    json << "      ]\n    }";
+}
+
+int main(int argc, char** argv) {
+    // Los contadores de rendimiento deben activarse antes de crear bloques
+    setenv("GR_CONF_PERFCOUNTERS_ON", "True", 1);
+
+    const uint64_t muestras = argc > 1 ? std::stoull(argv[1]) : 20000000;
+    const std::string archivo_json = argc > 2 ? argv[2] : "bench_results.json";
+
+    const std::vector<definicion_flujo> flujos = {
+        { "generador", flujo_generador },
+        { "generador_original", flujo_generador_original },
+        { "fir", flujo_fir },
+        { "iir", flujo_iir },
+        { "bits", flujo_bits },
+        { "bits_original", flujo_bits_original },
+        { "msk_modulador", flujo_msk_modulador },
+        { "msk_remuestreado", flujo_msk_remuestreado },
+        { "msk_fase_wav", flujo_msk_fase_wav },
+    };
+
+    // Flujos pedidos por línea de comandos (todos si no se indica ninguno)
+    std::vector<std::string> pedidos(argv + std::min(argc, 3), argv + argc);
+
+    std::ofstream json(archivo_json);
+    if (!json.is_open()) {
+        std::cerr << "No se pudo abrir " << archivo_json << " para escribir." << std::endl;
+        return 1;
+    }
+    json << "{\n  \"muestras\": " << muestras << ",\n  \"flujos\": [\n";
+
+    bool primero = true;
+    for (const auto& def : flujos) {
+        if (!pedidos.empty() &&
+            std::find(pedidos.begin(), pedidos.end(), def.nombre) == pedidos.end()) {
+            continue;
+        }
+        correr(def, muestras, json, primero);
+        primero = false;
+    }
+    json << "\n  ]\n}\n";
+    std::remove(wav_temporal);
+
+    std::cout << "Resultados en " << archivo_json << std::endl;
+    return 0;
+}
@@ -0,0 +1,240 @@
+// bit_source.h
+// Fuente de bits de prueba reproducible, en el formato que necesita el
+// siguiente bloque: bytes empaquetados, un bit por byte o símbolos +-1
+// (float o int8). Reemplaza random_uniform_source_b + uchar_to_float +
+// add_const_ff + multiply_const_ff (tres buffers intermedios) con un solo
+// bloque.
+//
+// Generadores:
+//   XOSHIRO  xoshiro256** (64 bits por llamada), sembrado con splitmix64
+//   PRBS9    x^9 + x^5 + 1      (periodo 2^9 - 1)
+//   PRBS15   x^15 + x^14 + 1    (periodo 2^15 - 1)
+//   PRBS23   x^23 + x^18 + 1    (periodo 2^23 - 1)
+//   PRBS31   x^31 + x^28 + 1    (periodo 2^31 - 1)
+// Los PRBS usan la recurrencia b[k] = b[k-n] xor b[k-m] sobre un registro de
+// 64 bits y calculan hasta m bits por operación. Con la misma semilla la
+// secuencia es la misma, sin importar cómo el scheduler parta los buffers.
+//
+// Los bits se generan de 64 en 64 y se expanden al formato de salida; con
+// AVX2 cada instrucción produce 32 bits o símbolos int8, u 8 símbolos float.
+// El orden es MSB primero en el formato empaquetado (como la entrada
+// empaquetada de msk_if_modulator) y el símbolo de un bit b es 2b - 1.
+
+#ifndef BLOQUES_BIT_SOURCE_H
+#define BLOQUES_BIT_SOURCE_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BIT_SOURCE_X86 1
+#endif
+
+class bit_source : public gr::sync_block {
+public:
+    typedef std::shared_ptr<bit_source> sptr;
+
+    enum class generador { XOSHIRO, PRBS9, PRBS15, PRBS23, PRBS31 };
+    enum class formato {
+        EMPAQUETADO, // uint8, 8 bits por byte, MSB primero
+        BITS,        // uint8, 0 o 1
+        SIMBOLOS_F,  // float, -1 o +1
+        SIMBOLOS_I8  // int8, -1 o +1
+    };
+
+    // semilla: estado inicial (en PRBS, los n bits bajos; 0 = todos en 1)
+    static sptr make(generador gen = generador::XOSHIRO,
+                     formato fmt = formato::SIMBOLOS_F,
+                     uint64_t semilla = 1) {
+        return gnuradio::get_initial_sptr(new bit_source(gen, fmt, semilla));
+    }
+
+    static size_t tam_item(formato fmt) { return fmt == formato::SIMBOLOS_F ? sizeof(float) : 1; }
+
+    bit_source(generador gen, formato fmt, uint64_t semilla)
+        : gr::sync_block("bit_source",
+                         gr::io_signature::make(0, 0, 0),
+                         gr::io_signature::make(1, 1, tam_item(fmt))),
+          d_gen(gen),
+          d_formato(fmt) {
+        switch (gen) {
+        case generador::XOSHIRO: {
+            uint64_t x = semilla;
+            for (uint64_t& s : d_xoshiro) {
+                s = splitmix64(x);
+            }
+            break;
+        }
+        case generador::PRBS9: d_n = 9; d_m = 5; break;
+        case generador::PRBS15: d_n = 15; d_m = 14; break;
+        case generador::PRBS23: d_n = 23; d_m = 18; break;
+        case generador::PRBS31: d_n = 31; d_m = 28; break;
+        default: throw std::invalid_argument("bit_source: generador desconocido");
+        }
+        if (d_n > 0) {
+            const uint64_t mascara = (UINT64_C(1) << d_n) - 1;
+            d_registro = semilla & mascara;
+            if (d_registro == 0) {
+                d_registro = mascara;
+            }
+        }
+        // Una palabra de 64 bits por llamada al generador
+        set_output_multiple(fmt == formato::EMPAQUETADO ? 8 : 64);
+
+#ifdef BIT_SOURCE_X86
+        d_usar_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool usa_avx2() const { return d_usar_avx2; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star&,
+             gr_vector_void_star& output_items) override {
+        const int palabras = noutput_items / (d_formato == formato::EMPAQUETADO ? 8 : 64);
+        d_palabras.resize(palabras);
+        for (int i = 0; i < palabras; i++) {
+            d_palabras[i] = d_gen == generador::XOSHIRO ? xoshiro() : prbs();
+        }
+
+        switch (d_formato) {
+        case formato::EMPAQUETADO: {
+            uint8_t* out = (uint8_t*)output_items[0];
+            for (int i = 0; i < palabras; i++) {
+                const uint64_t be = __builtin_bswap64(d_palabras[i]);
+                std::memcpy(out + 8 * i, &be, 8);
+            }
+            break;
+        }
+        case formato::BITS:
+        case formato::SIMBOLOS_I8: {
+            const bool simbolos = d_formato == formato::SIMBOLOS_I8;
+            uint8_t* out = (uint8_t*)output_items[0];
+#ifdef BIT_SOURCE_X86
+            if (d_usar_avx2) {
+                expandir_bytes_avx2(out, palabras, simbolos);
+                break;
+            }
+#endif
+            for (int i = 0; i < palabras; i++) {
+                for (int k = 0; k < 64; k++) {
+                    const uint8_t b = (d_palabras[i] >> (63 - k)) & 1;
+                    out[64 * i + k] = simbolos ? static_cast<uint8_t>(2 * b - 1) : b;
+                }
+            }
+            break;
+        }
+        case formato::SIMBOLOS_F: {
+            float* out = (float*)output_items[0];
+#ifdef BIT_SOURCE_X86
+            if (d_usar_avx2) {
+                expandir_float_avx2(out, palabras);
+                break;
+            }
+#endif
+            for (int i = 0; i < palabras; i++) {
+                for (int k = 0; k < 64; k++) {
+                    out[64 * i + k] = (d_palabras[i] >> (63 - k)) & 1 ? 1.0f : -1.0f;
+                }
+            }
+            break;
+        }
+        }
+        return noutput_items;
+    }
+
+private:
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += UINT64_C(0x9e3779b97f4a7c15));
+        z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t xoshiro() {
+        uint64_t* s = d_xoshiro;
+        const uint64_t r = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return r;
+    }
+
+    // 64 bits de la recurrencia, el más antiguo en el MSB. En d_registro el
+    // bit i es b[k-1-i], así que los siguientes c <= m bits son
+    // (R >> (n-c)) ^ (R >> (m-c)), ya en orden MSB primero.
+    uint64_t prbs() {
+        uint64_t palabra = 0;
+        for (int hechos = 0; hechos < 64;) {
+            const int c = std::min(d_m, 64 - hechos);
+            const uint64_t mascara = (UINT64_C(1) << c) - 1;
+            const uint64_t nuevos = ((d_registro >> (d_n - c)) ^ (d_registro >> (d_m - c))) & mascara;
+            d_registro = (d_registro << c) | nuevos;
+            palabra = (palabra << c) | nuevos;
+            hechos += c;
+        }
+        return palabra;
+    }
+
+#ifdef BIT_SOURCE_X86
+    // 32 bits -> 32 bytes: cada byte toma su byte de origen (shuffle) y se
+    // compara contra su máscara de bit
+    __attribute__((target("avx2"))) void expandir_bytes_avx2(uint8_t* out, int palabras, bool simbolos) {
+        const __m256i origen = _mm256_setr_epi8(3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2,
+                                                1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i bits = _mm256_set1_epi64x(INT64_C(0x0102040810204080));
+        const __m256i uno = _mm256_set1_epi8(1);
+        const __m256i dos = _mm256_set1_epi8(2);
+        for (int i = 0; i < palabras; i++) {
+            for (int mitad = 0; mitad < 2; mitad++) {
+                const uint32_t w = static_cast<uint32_t>(d_palabras[i] >> (32 * (1 - mitad)));
+                const __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(w), origen);
+                const __m256i puesto = _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+                // BITS: 0/1; SIMBOLOS_I8: 2*b - 1
+                const __m256i r = simbolos ? _mm256_sub_epi8(_mm256_and_si256(puesto, dos), uno)
+                                           : _mm256_and_si256(puesto, uno);
+                _mm256_storeu_si256((__m256i*)(out + 64 * i + 32 * mitad), r);
+            }
+        }
+    }
+
+    // 8 bits -> 8 floats
+    __attribute__((target("avx2"))) void expandir_float_avx2(float* out, int palabras) {
+        const __m256i bits = _mm256_setr_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+        const __m256 mas = _mm256_set1_ps(1.0f);
+        const __m256 menos = _mm256_set1_ps(-1.0f);
+        for (int i = 0; i < palabras; i++) {
+            for (int k = 0; k < 8; k++) {
+                const int byte = (d_palabras[i] >> (56 - 8 * k)) & 0xff;
+                const __m256i puesto =
+                    _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(byte), bits), bits);
+                _mm256_storeu_ps(out + 64 * i + 8 * k,
+                                 _mm256_blendv_ps(menos, mas, _mm256_castsi256_ps(puesto)));
+            }
+        }
+    }
+#endif
+
+    const generador d_gen;
+    const formato d_formato;
+    bool d_usar_avx2 = false;
+    uint64_t d_xoshiro[4] = {};
+    int d_n = 0, d_m = 0;     // taps del PRBS
+    uint64_t d_registro = 0;  // últimos 64 bits del PRBS (bit 0 = el más reciente)
+    std::vector<uint64_t> d_palabras;
+};
+
+#endif // BLOQUES_BIT_SOURCE_H
@@ -0,0 +1,179 @@
+// dat_file.h
+// Formato binario de los archivos .dat de señales y lector por mmap.
+//
+// El archivo empieza con una cabecera de tamaño fijo (DAT_TAM_CABECERA bytes,
+// relleno con ceros) y después los datos, alineados a página. Todos los campos
+// son little-endian:
+//
+//   offset  tipo       campo
+//   0       char[8]    magic = "SENALDAT"
+//   8       uint32     version (1)
+//   12      uint32     tam_cabecera (bytes hasta el primer dato)
+//   16      float64    fs (Hz)
+//   24      uint32     num_streams
+//   28      uint32     layout (0 = intercalado, 1 = planar)
+//   32      uint32     dtype (ver dat_dtype)
+//   36      uint32     item_size (bytes por muestra de un stream)
+//   40      uint64     bloque_items (planar: muestras por stream en cada bloque)
+//   48      uint64     num_items (muestras por stream; el sumidero lo
+//                      actualiza en cada escritura, 0 si no llegó a escribir)
+//   56      int64      inicio_ns (tiempo de la primera muestra, ns desde 1970)
+//
+// Intercalado: s0[0] s1[0] ... s0[1] s1[1] ...
+// Planar: bloques de bloque_items muestras de s0, luego de s1, ..., y se repite.
+
+#ifndef BLOQUES_DAT_FILE_H
+#define BLOQUES_DAT_FILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char DAT_MAGIC[8] = { 'S', 'E', 'N', 'A', 'L', 'D', 'A', 'T' };
+static const uint32_t DAT_VERSION = 1;
+static const uint32_t DAT_TAM_CABECERA = 4096;
+
+enum class dat_layout : uint32_t { INTERCALADO = 0, PLANAR = 1 };
+
+enum class dat_dtype : uint32_t {
+    FLOAT32 = 0,
+    COMPLEX64 = 1,
+    INT16 = 2,
+    INT32 = 3,
+    FLOAT64 = 4,
+    UINT8 = 5,
+};
+
+inline uint32_t dat_item_size(dat_dtype dtype) {
+    switch (dtype) {
+    case dat_dtype::FLOAT32: return 4;
+    case dat_dtype::COMPLEX64: return 8;
+    case dat_dtype::INT16: return 2;
+    case dat_dtype::INT32: return 4;
+    case dat_dtype::FLOAT64: return 8;
+    case dat_dtype::UINT8: return 1;
+    }
+    throw std::invalid_argument("dat_item_size: dtype desconocido");
+}
+
+#pragma pack(push, 1)
+struct dat_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t tam_cabecera;
+    double fs;
+    uint32_t num_streams;
+    uint32_t layout;
+    uint32_t dtype;
+    uint32_t item_size;
+    uint64_t bloque_items;
+    uint64_t num_items;
+    int64_t inicio_ns;
+};
+#pragma pack(pop)
+static_assert(sizeof(dat_header) == 64, "dat_header debe medir 64 bytes");
+
+inline dat_header dat_header_nuevo(double fs, dat_dtype dtype, uint32_t num_streams) {
+    dat_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, DAT_MAGIC, sizeof(DAT_MAGIC));
+    h.version = DAT_VERSION;
+    h.tam_cabecera = DAT_TAM_CABECERA;
+    h.fs = fs;
+    h.num_streams = num_streams;
+    h.layout = static_cast<uint32_t>(dat_layout::INTERCALADO);
+    h.dtype = static_cast<uint32_t>(dtype);
+    h.item_size = dat_item_size(dtype);
+    return h;
+}
+
+// Lector de solo lectura: proyecta el archivo completo en memoria y entrega
+// apuntadores directos a los datos, sin copias ni fread.
+class dat_file {
+public:
+    explicit dat_file(const std::string& archivo) {
+        d_fd = ::open(archivo.c_str(), O_RDONLY);
+        if (d_fd < 0) {
+            throw std::runtime_error("dat_file: no se pudo abrir " + archivo);
+        }
+        struct stat st;
+        if (::fstat(d_fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(dat_header))) {
+            cerrar();
+            throw std::runtime_error("dat_file: archivo demasiado corto: " + archivo);
+        }
+        d_tam = st.st_size;
+
+        void* p = ::mmap(nullptr, d_tam, PROT_READ, MAP_SHARED, d_fd, 0);
+        if (p == MAP_FAILED) {
+            cerrar();
+            throw std::runtime_error("dat_file: mmap falló para " + archivo);
+        }
+        d_mapa = static_cast<const uint8_t*>(p);
+        ::madvise(p, d_tam, MADV_SEQUENTIAL);
+
+        std::memcpy(&d_cabecera, d_mapa, sizeof(d_cabecera));
+        if (std::memcmp(d_cabecera.magic, DAT_MAGIC, sizeof(DAT_MAGIC)) != 0 ||
+            d_cabecera.version != DAT_VERSION || d_cabecera.tam_cabecera > d_tam ||
+            d_cabecera.num_streams == 0 || d_cabecera.item_size == 0) {
+            cerrar();
+            throw std::runtime_error("dat_file: cabecera inválida en " + archivo);
+        }
+
+        // Con num_items en 0 (archivo sin datos o de un escritor anterior que no
+        // lo cerró) se deduce del tamaño
+        const uint64_t por_muestra = uint64_t(d_cabecera.num_streams) * d_cabecera.item_size;
+        const uint64_t en_disco = (d_tam - d_cabecera.tam_cabecera) / por_muestra;
+        d_num_items = (d_cabecera.num_items && d_cabecera.num_items <= en_disco)
+                          ? d_cabecera.num_items
+                          : en_disco;
+    }
+
+    ~dat_file() { cerrar(); }
+
+    dat_file(const dat_file&) = delete;
+    dat_file& operator=(const dat_file&) = delete;
+
+    const dat_header& cabecera() const { return d_cabecera; }
+    double fs() const { return d_cabecera.fs; }
+    uint32_t num_streams() const { return d_cabecera.num_streams; }
+    uint32_t item_size() const { return d_cabecera.item_size; }
+    dat_layout layout() const { return static_cast<dat_layout>(d_cabecera.layout); }
+    dat_dtype dtype() const { return static_cast<dat_dtype>(d_cabecera.dtype); }
+
+    // Muestras por stream
+    uint64_t num_items() const { return d_num_items; }
+
+    // Primer byte de datos (alineado a página)
+    const uint8_t* datos() const { return d_mapa + d_cabecera.tam_cabecera; }
+
+    template <class T>
+    const T* datos_como() const {
+        return reinterpret_cast<const T*>(datos());
+    }
+
+private:
+    void cerrar() {
+        if (d_mapa) {
+            ::munmap(const_cast<uint8_t*>(d_mapa), d_tam);
+            d_mapa = nullptr;
+        }
+        if (d_fd >= 0) {
+            ::close(d_fd);
+            d_fd = -1;
+        }
+    }
+
+    int d_fd = -1;
+    size_t d_tam = 0;
+    const uint8_t* d_mapa = nullptr;
+    dat_header d_cabecera;
+    uint64_t d_num_items = 0;
+};
+
+#endif // BLOQUES_DAT_FILE_H
@@ -0,0 +1,225 @@
+// dat_file_sink.h
+// Sumidero de archivos .dat con cabecera binaria (ver dat_file.h).
+//
+// Las muestras se acumulan en un buffer alineado de varios MB y se escriben
+// con pwrite en bloques grandes. El espacio se preasigna con fallocate
+// (completo si se conoce la duración, o en tramos si no) para evitar
+// fragmentación, sin cambiar el tamaño del archivo (FALLOC_FL_KEEP_SIZE):
+// tras un corte el archivo no tiene ceros de más al final. num_items en la
+// cabecera se actualiza después de cada escritura.
+//
+// stop() escribe lo pendiente, recorta el espacio sobrante y actualiza la
+// cabecera, pero deja el archivo abierto: un flujo que se vuelve a arrancar
+// sigue agregando muestras. El archivo se cierra en el destructor. Los
+// errores de disco en work() lanzan una excepción; en stop() y en el
+// destructor se reportan en stderr y error() regresa el mensaje.
+//
+// Entrada: muestras intercaladas de num_streams señales (por ejemplo, la
+// salida de stream_mux con {1,1,...}).
+
+#ifndef BLOQUES_DAT_FILE_SINK_H
+#define BLOQUES_DAT_FILE_SINK_H
+
+#include "dat_file.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+class dat_file_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<dat_file_sink> sptr;
+
+    // items_esperados: muestras por stream que se van a escribir (0 si no se sabe)
+    static sptr make(const std::string& archivo,
+                     double fs,
+                     dat_dtype dtype = dat_dtype::FLOAT32,
+                     int num_streams = 1,
+                     uint64_t items_esperados = 0) {
+        return gnuradio::get_initial_sptr(
+            new dat_file_sink(archivo, fs, dtype, num_streams, items_esperados));
+    }
+
+    dat_file_sink(const std::string& archivo,
+                  double fs,
+                  dat_dtype dtype,
+                  int num_streams,
+                  uint64_t items_esperados)
+        : gr::sync_block("dat_file_sink",
+                         gr::io_signature::make(1, 1, dat_item_size(dtype)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_archivo(archivo),
+          d_cabecera(dat_header_nuevo(fs, dtype, num_streams)),
+          d_item_size(dat_item_size(dtype)) {
+        d_fd = ::open(archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (d_fd < 0) {
+            throw std::runtime_error("dat_file_sink: no se pudo abrir " + archivo + ": " + std::strerror(errno));
+        }
+        if (::posix_memalign(&d_buffer, ALINEACION, TAM_BUFFER) != 0) {
+            ::close(d_fd);
+            throw std::runtime_error("dat_file_sink: sin memoria para el buffer");
+        }
+
+        try {
+            // Preasignar el archivo completo si se conoce su tamaño
+            const uint64_t bytes = items_esperados * num_streams * d_item_size;
+            if (bytes > 0) {
+                preasignar(DAT_TAM_CABECERA + bytes);
+            }
+            escribir_cabecera();
+        } catch (...) {
+            ::close(d_fd);
+            std::free(d_buffer);
+            throw;
+        }
+    }
+
+    ~dat_file_sink() override {
+        finalizar_sin_excepcion();
+        ::close(d_fd);
+        std::free(d_buffer);
+    }
+
+    // Muestras por stream escritas hasta ahora
+    uint64_t items_escritos() const {
+        return (d_bytes_escritos + d_llenado) / (uint64_t(d_cabecera.num_streams) * d_item_size);
+    }
+
+    // Error de disco al detener o destruir el bloque, o vacío
+    std::string error() const { return d_error; }
+
+    bool start() override {
+        // El tiempo de inicio se toma al arrancar el flujo por primera vez,
+        // no al crear el bloque
+        if (d_cabecera.inicio_ns == 0) {
+            d_cabecera.inicio_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::system_clock::now().time_since_epoch())
+                                       .count();
+        }
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        finalizar_sin_excepcion();
+        return gr::sync_block::stop();
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        const uint8_t* in = (const uint8_t*)input_items[0];
+        size_t pendientes = size_t(noutput_items) * d_item_size;
+
+        while (pendientes > 0) {
+            const size_t n = std::min(pendientes, TAM_BUFFER - d_llenado);
+            std::memcpy(static_cast<uint8_t*>(d_buffer) + d_llenado, in, n);
+            d_llenado += n;
+            in += n;
+            pendientes -= n;
+            if (d_llenado == TAM_BUFFER) {
+                vaciar();
+            }
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr size_t ALINEACION = 4096;
+    static constexpr size_t TAM_BUFFER = 4 << 20;  // 4 MiB por escritura
+    static constexpr uint64_t TRAMO = 64ull << 20; // preasignación sin tamaño conocido
+
+    void escribir_cabecera() {
+        uint8_t bloque[DAT_TAM_CABECERA] = { 0 };
+        std::memcpy(bloque, &d_cabecera, sizeof(d_cabecera));
+        if (::pwrite(d_fd, bloque, sizeof(bloque), 0) != static_cast<ssize_t>(sizeof(bloque))) {
+            throw std::runtime_error("dat_file_sink: error al escribir la cabecera de " + d_archivo + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    // Reserva espacio hasta 'hasta' bytes sin cambiar el tamaño del archivo.
+    // Un disco lleno se detecta aquí; si el sistema de archivos no preasigna,
+    // se sigue sin preasignar
+    void preasignar(uint64_t hasta) {
+        d_reservado = hasta;
+        if (::fallocate(d_fd, FALLOC_FL_KEEP_SIZE, 0, d_reservado) != 0 && errno != EOPNOTSUPP &&
+            errno != ENOSYS && errno != EINVAL) {
+            throw std::runtime_error("dat_file_sink: no se pudo preasignar " + d_archivo + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    void vaciar() {
+        if (d_llenado == 0) {
+            return;
+        }
+        const uint64_t offset = DAT_TAM_CABECERA + d_bytes_escritos;
+        if (offset + d_llenado > d_reservado) {
+            preasignar(offset + d_llenado + TRAMO);
+        }
+        size_t hecho = 0;
+        while (hecho < d_llenado) {
+            const ssize_t r = ::pwrite(d_fd, static_cast<uint8_t*>(d_buffer) + hecho,
+                                       d_llenado - hecho, offset + hecho);
+            if (r <= 0) {
+                throw std::runtime_error("dat_file_sink: error al escribir " + d_archivo + ": " +
+                                         std::strerror(r < 0 ? errno : ENOSPC));
+            }
+            hecho += r;
+        }
+        d_bytes_escritos += d_llenado;
+        d_llenado = 0;
+        // Punto de control: tras un corte la cabecera indica lo que sí llegó
+        d_cabecera.num_items = items_escritos();
+        escribir_cabecera();
+    }
+
+    void finalizar() {
+        vaciar();
+        // Liberar la preasignación sobrante
+        if (::ftruncate(d_fd, DAT_TAM_CABECERA + d_bytes_escritos) != 0) {
+            std::perror("dat_file_sink: ftruncate");
+        }
+        d_reservado = DAT_TAM_CABECERA + d_bytes_escritos;
+        d_cabecera.num_items = items_escritos();
+        escribir_cabecera();
+    }
+
+    // Para stop() y el destructor, que no deben lanzar: tras el primer error
+    // no se vuelve a intentar
+    void finalizar_sin_excepcion() {
+        if (!d_error.empty()) {
+            return;
+        }
+        try {
+            finalizar();
+        } catch (const std::exception& e) {
+            d_error = e.what();
+            std::fprintf(stderr, "%s\n", d_error.c_str());
+        }
+    }
+
+    const std::string d_archivo;
+    dat_header d_cabecera;
+    const uint32_t d_item_size;
+
+    int d_fd = -1;
+    void* d_buffer = nullptr;
+    std::string d_error;
+    size_t d_llenado = 0;          // bytes en el buffer
+    uint64_t d_bytes_escritos = 0; // bytes de datos ya en disco
+    uint64_t d_reservado = 0;      // bytes preasignados en disco
+};
+
+#endif // BLOQUES_DAT_FILE_SINK_H
@@ -0,0 +1,86 @@
+// dat_file_source.h
+// Fuente que reproduce un archivo .dat (ver dat_file.h) proyectado en memoria.
+//
+// Los datos se leen directamente del mapa de memoria: no hay fread ni buffers
+// intermedios, solo la copia al buffer de salida que exige el scheduler de
+// GNU Radio. Para recorrer el archivo sin esa copia (por ejemplo, para
+// estadísticas o gráficas) se puede usar dat_file directamente.
+//
+// Salida: muestras intercaladas de todos los streams (un item por muestra de
+// un stream), igual que las escribe dat_file_sink.
+
+#ifndef BLOQUES_DAT_FILE_SOURCE_H
+#define BLOQUES_DAT_FILE_SOURCE_H
+
+#include "dat_file.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+class dat_file_source : public gr::sync_block {
+public:
+    typedef std::shared_ptr<dat_file_source> sptr;
+
+    static sptr make(const std::string& archivo, bool repetir = false) {
+        return make(std::make_shared<dat_file>(archivo), repetir);
+    }
+
+    // Permite consultar la cabecera (fs, num_streams) antes de crear el bloque
+    static sptr make(std::shared_ptr<dat_file> archivo, bool repetir = false) {
+        return gnuradio::get_initial_sptr(new dat_file_source(archivo, repetir));
+    }
+
+    dat_file_source(std::shared_ptr<dat_file> archivo, bool repetir)
+        : gr::sync_block("dat_file_source",
+                         gr::io_signature::make(0, 0, 0),
+                         gr::io_signature::make(1, 1, archivo->item_size())),
+          d_archivo(archivo),
+          d_repetir(repetir),
+          d_total(archivo->num_items() * archivo->num_streams()) {
+        if (d_archivo->layout() != dat_layout::INTERCALADO) {
+            throw std::invalid_argument("dat_file_source: solo se soporta el layout intercalado");
+        }
+        // Mantener las muestras de cada instante juntas en el buffer
+        set_output_multiple(d_archivo->num_streams());
+    }
+
+    const dat_file& archivo() const { return *d_archivo; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star&,
+             gr_vector_void_star& output_items) override {
+        uint8_t* out = (uint8_t*)output_items[0];
+        const size_t item_size = d_archivo->item_size();
+
+        int producidos = 0;
+        while (producidos < noutput_items) {
+            if (d_posicion == d_total) {
+                if (!d_repetir || d_total == 0) {
+                    break;
+                }
+                d_posicion = 0;
+            }
+            const uint64_t n = std::min<uint64_t>(noutput_items - producidos, d_total - d_posicion);
+            std::memcpy(out + producidos * item_size,
+                        d_archivo->datos() + d_posicion * item_size,
+                        n * item_size);
+            d_posicion += n;
+            producidos += n;
+        }
+        return producidos > 0 ? producidos : WORK_DONE;
+    }
+
+private:
+    std::shared_ptr<dat_file> d_archivo;
+    const bool d_repetir;
+    const uint64_t d_total; // items en el archivo (muestras de todos los streams)
+    uint64_t d_posicion = 0;
+};
+
+#endif // BLOQUES_DAT_FILE_SOURCE_H
@@ -0,0 +1,410 @@
+// dat_multi_sink.h
+// Sumidero .dat (ver dat_file.h) con una entrada por señal, para grabar
+// varias señales de un flujo sin stream_mux ni un head por señal.
+//
+//   * INTERCALADO: frames s0[n] s1[n] ...; el intercalado se hace en un
+//     buffer de 4 MiB (con AVX para dos señales float) y se escribe con pwrite.
+//   * PLANAR: cada señal se acumula en su propio buffer de bloque_items
+//     muestras y cada bloque completo se escribe con una sola llamada a
+//     pwritev (un iovec por señal), sin intercalar nada. Si se conoce el
+//     número de muestras y cabe en un bloque, el archivo queda con un solo
+//     bloque por señal. El último bloque se rellena con ceros hasta
+//     bloque_items para que todos midan lo mismo; num_items en la cabecera
+//     indica cuántas muestras son válidas.
+//
+// El bloque cuenta las muestras por su cuenta: con muestras > 0 termina el
+// flujo (WORK_DONE) al recibirlas, igual que head. Como dat_file_sink,
+// preasigna espacio sin cambiar el tamaño del archivo, actualiza num_items
+// en la cabecera después de cada escritura, en stop() escribe lo pendiente
+// sin cerrar el archivo (se cierra en el destructor) y reporta en error()
+// los errores de disco de stop() y del destructor.
+
+#ifndef BLOQUES_DAT_MULTI_SINK_H
+#define BLOQUES_DAT_MULTI_SINK_H
+
+#include "dat_file.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define DAT_MULTI_X86 1
+#endif
+
+class dat_multi_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<dat_multi_sink> sptr;
+
+    // num_streams: número de entradas (una señal cada una)
+    // muestras: muestras por señal a grabar antes de terminar (0: sin límite)
+    // bloque_items: muestras por señal en cada bloque del layout planar
+    static sptr make(const std::string& archivo,
+                     double fs,
+                     dat_dtype dtype,
+                     int num_streams,
+                     dat_layout layout = dat_layout::INTERCALADO,
+                     uint64_t muestras = 0,
+                     uint64_t bloque_items = 1 << 16) {
+        return gnuradio::get_initial_sptr(
+            new dat_multi_sink(archivo, fs, dtype, num_streams, layout, muestras, bloque_items));
+    }
+
+    dat_multi_sink(const std::string& archivo,
+                   double fs,
+                   dat_dtype dtype,
+                   int num_streams,
+                   dat_layout layout,
+                   uint64_t muestras,
+                   uint64_t bloque_items)
+        : gr::sync_block("dat_multi_sink",
+                         gr::io_signature::make(num_streams, num_streams, dat_item_size(dtype)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_archivo(archivo),
+          d_cabecera(dat_header_nuevo(fs, dtype, num_streams)),
+          d_item_size(dat_item_size(dtype)),
+          d_streams(num_streams),
+          d_planar(layout == dat_layout::PLANAR),
+          d_muestras(muestras) {
+        if (num_streams < 1 || (d_planar && bloque_items == 0)) {
+            throw std::invalid_argument("dat_multi_sink: se requiere al menos un stream y bloque_items > 0");
+        }
+        if (d_planar) {
+            // Con duración conocida basta un bloque si no es más grande que lo pedido
+            d_bloque = (muestras > 0 && muestras <= bloque_items) ? muestras : bloque_items;
+            d_cabecera.layout = static_cast<uint32_t>(dat_layout::PLANAR);
+            d_cabecera.bloque_items = d_bloque;
+            d_buffers.resize(num_streams);
+            for (auto& b : d_buffers) {
+                b.resize(d_bloque * d_item_size);
+            }
+        } else {
+            d_buffer.resize(TAM_BUFFER / (size_t(num_streams) * d_item_size) *
+                            (size_t(num_streams) * d_item_size));
+        }
+
+        d_fd = ::open(archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (d_fd < 0) {
+            throw std::runtime_error("dat_multi_sink: no se pudo abrir " + archivo + ": " + std::strerror(errno));
+        }
+
+        try {
+            // Preasignar el archivo completo si se conoce su tamaño
+            if (muestras > 0) {
+                const uint64_t items = d_planar ? (muestras + d_bloque - 1) / d_bloque * d_bloque : muestras;
+                preasignar(DAT_TAM_CABECERA + items * num_streams * d_item_size);
+            }
+            escribir_cabecera();
+        } catch (...) {
+            ::close(d_fd);
+            throw;
+        }
+
+#ifdef DAT_MULTI_X86
+        d_usar_avx = __builtin_cpu_supports("avx");
+#endif
+    }
+
+    ~dat_multi_sink() override {
+        finalizar_sin_excepcion();
+        ::close(d_fd);
+    }
+
+    // Muestras por stream recibidas hasta ahora
+    uint64_t items_escritos() const { return d_items; }
+
+    // Error de disco al detener o destruir el bloque, o vacío
+    std::string error() const { return d_error; }
+
+    bool start() override {
+        // El tiempo de inicio se toma al arrancar el flujo por primera vez,
+        // no al crear el bloque
+        if (d_cabecera.inicio_ns == 0) {
+            d_cabecera.inicio_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::system_clock::now().time_since_epoch())
+                                       .count();
+        }
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        finalizar_sin_excepcion();
+        return gr::sync_block::stop();
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        uint64_t n = noutput_items;
+        if (d_muestras > 0) {
+            n = std::min(n, d_muestras - d_items);
+        }
+
+        for (uint64_t hecho = 0; hecho < n;) {
+            size_t k;
+            if (d_planar) {
+                // Copiar a los buffers por señal hasta completar el bloque
+                k = std::min<uint64_t>(n - hecho, d_bloque - d_en_bloque);
+                for (int s = 0; s < d_streams; s++) {
+                    std::memcpy(d_buffers[s].data() + d_en_bloque * d_item_size,
+                                (const uint8_t*)input_items[s] + hecho * d_item_size,
+                                k * d_item_size);
+                }
+                d_en_bloque += k;
+                if (d_en_bloque == d_bloque) {
+                    escribir_bloque();
+                }
+            } else {
+                // Intercalar directo en el buffer de escritura
+                const size_t frame = size_t(d_streams) * d_item_size;
+                k = std::min<uint64_t>(n - hecho, (d_buffer.size() - d_llenado) / frame);
+                intercalar(input_items, hecho, k, d_buffer.data() + d_llenado);
+                d_llenado += k * frame;
+                if (d_llenado == d_buffer.size()) {
+                    vaciar();
+                }
+            }
+            hecho += k;
+        }
+
+        d_items += n;
+        if (d_muestras > 0 && d_items >= d_muestras) {
+            return WORK_DONE;
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr size_t TAM_BUFFER = 4 << 20;  // 4 MiB por escritura (intercalado)
+    static constexpr uint64_t TRAMO = 64ull << 20; // preasignación sin tamaño conocido
+
+    void intercalar(gr_vector_const_void_star& in, size_t inicio, size_t k, uint8_t* out) const {
+#ifdef DAT_MULTI_X86
+        if (d_usar_avx && d_streams == 2 && d_item_size == 4) {
+            intercalar_2f_avx((const float*)in[0] + inicio, (const float*)in[1] + inicio, k,
+                              (float*)out);
+            return;
+        }
+#endif
+        switch (d_item_size) {
+        case 4:
+            intercalar_tipo<uint32_t>(in, inicio, k, out);
+            break;
+        case 8:
+            intercalar_tipo<uint64_t>(in, inicio, k, out);
+            break;
+        case 2:
+            intercalar_tipo<uint16_t>(in, inicio, k, out);
+            break;
+        default:
+            intercalar_tipo<uint8_t>(in, inicio, k, out);
+            break;
+        }
+    }
+
+    template <typename T>
+    void intercalar_tipo(gr_vector_const_void_star& in, size_t inicio, size_t k, uint8_t* out) const {
+        T* o = reinterpret_cast<T*>(out);
+        for (int s = 0; s < d_streams; s++) {
+            const T* x = (const T*)in[s] + inicio;
+            for (size_t i = 0; i < k; i++) {
+                o[i * d_streams + s] = x[i];
+            }
+        }
+    }
+
+#ifdef DAT_MULTI_X86
+    // a0 b0 a1 b1 ... con unpack + permutación de carriles de 128 bits
+    __attribute__((target("avx"))) static void
+    intercalar_2f_avx(const float* a, const float* b, size_t k, float* out) {
+        size_t i = 0;
+        for (; i + 8 <= k; i += 8) {
+            const __m256 va = _mm256_loadu_ps(a + i);
+            const __m256 vb = _mm256_loadu_ps(b + i);
+            const __m256 lo = _mm256_unpacklo_ps(va, vb); // a0 b0 a1 b1 | a4 b4 a5 b5
+            const __m256 hi = _mm256_unpackhi_ps(va, vb); // a2 b2 a3 b3 | a6 b6 a7 b7
+            _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        for (; i < k; i++) {
+            out[2 * i] = a[i];
+            out[2 * i + 1] = b[i];
+        }
+    }
+#endif
+
+    // Reserva espacio sin cambiar el tamaño del archivo, para que tras un
+    // corte no queden ceros de más al final. Un disco lleno se detecta aquí;
+    // si el sistema de archivos no preasigna, se sigue sin preasignar
+    void preasignar(uint64_t hasta) {
+        d_reservado = hasta;
+        if (::fallocate(d_fd, FALLOC_FL_KEEP_SIZE, 0, d_reservado) != 0 && errno != EOPNOTSUPP &&
+            errno != ENOSYS && errno != EINVAL) {
+            throw std::runtime_error("dat_multi_sink: no se pudo preasignar " + d_archivo + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    void reservar(uint64_t hasta) {
+        if (hasta > d_reservado) {
+            preasignar(hasta + TRAMO);
+        }
+    }
+
+    // Punto de control después de cada escritura: tras un corte la cabecera
+    // indica cuántas muestras llegaron al disco (en planar, los bloques
+    // escritos antes de cerrar siempre van completos)
+    void actualizar_cabecera() {
+        d_cabecera.num_items = d_bytes_escritos / (uint64_t(d_streams) * d_item_size);
+        escribir_cabecera();
+    }
+
+    // Intercalado: escribir el buffer completo
+    void vaciar() {
+        if (d_llenado == 0) {
+            return;
+        }
+        const uint64_t offset = DAT_TAM_CABECERA + d_bytes_escritos;
+        reservar(offset + d_llenado);
+        size_t hecho = 0;
+        while (hecho < d_llenado) {
+            const ssize_t r = ::pwrite(d_fd, d_buffer.data() + hecho, d_llenado - hecho, offset + hecho);
+            if (r <= 0) {
+                throw std::runtime_error("dat_multi_sink: error al escribir " + d_archivo + ": " +
+                                         std::strerror(r < 0 ? errno : ENOSPC));
+            }
+            hecho += r;
+        }
+        d_bytes_escritos += d_llenado;
+        d_llenado = 0;
+        actualizar_cabecera();
+    }
+
+    // Planar: un bloque de todas las señales en una sola llamada. Un bloque
+    // incompleto (al detener el flujo) no avanza la posición de escritura
+    void escribir_bloque(bool completo = true) {
+        const size_t bytes_bloque = d_bloque * d_item_size;
+        const uint64_t offset = DAT_TAM_CABECERA + d_bytes_escritos;
+        const size_t total = bytes_bloque * d_streams;
+        reservar(offset + total);
+
+        std::vector<iovec> iov(d_streams);
+        for (int s = 0; s < d_streams; s++) {
+            iov[s].iov_base = d_buffers[s].data();
+            iov[s].iov_len = bytes_bloque;
+        }
+        size_t hecho = 0;
+        int primero = 0;
+        while (hecho < total) {
+            const ssize_t r = ::pwritev(d_fd, &iov[primero], d_streams - primero, offset + hecho);
+            if (r <= 0) {
+                throw std::runtime_error("dat_multi_sink: error al escribir " + d_archivo + ": " +
+                                         std::strerror(r < 0 ? errno : ENOSPC));
+            }
+            hecho += r;
+            // Escritura parcial: avanzar los iovec ya escritos
+            for (size_t resto = r; resto > 0 && primero < d_streams;) {
+                const size_t c = std::min(resto, iov[primero].iov_len);
+                iov[primero].iov_base = static_cast<uint8_t*>(iov[primero].iov_base) + c;
+                iov[primero].iov_len -= c;
+                resto -= c;
+                if (iov[primero].iov_len == 0) {
+                    primero++;
+                }
+            }
+        }
+        if (completo) {
+            d_bytes_escritos += total;
+            d_en_bloque = 0;
+            actualizar_cabecera();
+        }
+    }
+
+    void escribir_cabecera() {
+        uint8_t bloque[DAT_TAM_CABECERA] = { 0 };
+        std::memcpy(bloque, &d_cabecera, sizeof(d_cabecera));
+        if (::pwrite(d_fd, bloque, sizeof(bloque), 0) != static_cast<ssize_t>(sizeof(bloque))) {
+            throw std::runtime_error("dat_multi_sink: error al escribir la cabecera de " + d_archivo + ": " +
+                                     std::strerror(errno));
+        }
+    }
+
+    void finalizar() {
+        uint64_t fin = DAT_TAM_CABECERA + d_bytes_escritos;
+        if (d_planar) {
+            // Rellenar el último bloque para que todos midan bloque_items. Se
+            // escribe sin darlo por completo: si el flujo vuelve a arrancar,
+            // el bloque se termina de llenar y se reescribe en su lugar
+            if (d_en_bloque > 0) {
+                for (auto& b : d_buffers) {
+                    std::fill(b.begin() + d_en_bloque * d_item_size, b.end(), 0);
+                }
+                escribir_bloque(false);
+                fin += d_bloque * d_item_size * d_streams;
+            }
+        } else {
+            vaciar();
+            fin = DAT_TAM_CABECERA + d_bytes_escritos;
+        }
+        // Liberar la preasignación sobrante y registrar cuántas muestras hay
+        if (::ftruncate(d_fd, fin) != 0) {
+            std::perror("dat_multi_sink: ftruncate");
+        }
+        d_reservado = fin;
+        d_cabecera.num_items = d_items;
+        escribir_cabecera();
+    }
+
+    // Para stop() y el destructor, que no deben lanzar: tras el primer error
+    // no se vuelve a intentar
+    void finalizar_sin_excepcion() {
+        if (!d_error.empty()) {
+            return;
+        }
+        try {
+            finalizar();
+        } catch (const std::exception& e) {
+            d_error = e.what();
+            std::fprintf(stderr, "%s\n", d_error.c_str());
+        }
+    }
+
+    const std::string d_archivo;
+    dat_header d_cabecera;
+    const uint32_t d_item_size;
+    const int d_streams;
+    const bool d_planar;
+    const uint64_t d_muestras;
+
+    int d_fd = -1;
+    std::string d_error;
+    uint64_t d_items = 0;          // muestras por stream recibidas
+    uint64_t d_bytes_escritos = 0; // bytes de datos ya en disco
+    uint64_t d_reservado = 0;      // bytes preasignados en disco
+    bool d_usar_avx = false;
+
+    // Intercalado
+    std::vector<uint8_t> d_buffer;
+    size_t d_llenado = 0; // bytes en el buffer
+
+    // Planar
+    uint64_t d_bloque = 0;                     // muestras por stream en cada bloque
+    std::vector<std::vector<uint8_t>> d_buffers; // un bloque por stream
+    uint64_t d_en_bloque = 0;                  // muestras en el bloque actual
+};
+
+#endif // BLOQUES_DAT_MULTI_SINK_H
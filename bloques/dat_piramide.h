@@ -0,0 +1,599 @@
+// dat_piramide.h
+// Pirámide de decimación min/max/media de un archivo .dat (ver dat_file.h),
+// para graficar grabaciones de varios GB sin cargarlas completas.
+//
+// construir_piramide() recorre el archivo una sola vez y escribe un archivo
+// acompañante (por convención <archivo>.pir) con niveles de decimación
+// decimacion_min * 2^k. Cada bin de un nivel guarda el mínimo, el máximo y
+// la media de sus muestras; el último nivel tiene un solo bin. La memoria es
+// constante (buffers de lectura con pread y un buffer de salida pequeño por
+// nivel), así que el tamaño de la grabación no importa:
+//   * intercalado: cada tramo se lee una sola vez y los hilos reparten sus
+//     streams mientras se lee el tramo siguiente,
+//   * planar: cada hilo lee solo los bloques de sus streams.
+// Con decimacion_min = 64 la pirámide de float32 mide ~9% del original.
+//
+// Un visor elige con dat_piramide::nivel_para() el nivel más fino que no
+// excede los puntos que puede dibujar en el rango visible y lee solo esos
+// bins (mmap); Filtros/leer_piramide_dat.m hace lo mismo en Octave. Ambos
+// rechazan una pirámide cuyo tamaño original o inicio_ns no coinciden con
+// los del .dat actual (la grabación se regeneró después de construirla).
+//
+// Formato (little-endian, cabecera de DAT_TAM_CABECERA bytes):
+//
+//   offset  tipo       campo
+//   0       char[8]    magic = "SENALPIR"
+//   8       uint32     version (1)
+//   12      uint32     tam_cabecera
+//   16      float64    fs (Hz, del archivo original)
+//   24      uint32     num_streams
+//   28      uint32     num_niveles
+//   32      uint64     num_items (muestras por stream del original)
+//   40      uint32     valor (0 = la muestra, 1 = magnitud de complex64)
+//   44      uint32     reservado
+//   48      int64      inicio_ns (copiado del original, para detectar si cambió)
+//   56      uint64     tam_original (bytes del .dat, para detectar si cambió)
+//   64      nivel[num_niveles]: { uint64 decimacion, uint64 num_bins, uint64 offset }
+//
+// Datos de un nivel a partir de su offset: los bins del stream 0, luego los
+// del stream 1, etc. Cada bin es float32[3] = { min, max, media }.
+
+#ifndef BLOQUES_DAT_PIRAMIDE_H
+#define BLOQUES_DAT_PIRAMIDE_H
+
+#include "dat_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PIR_MAGIC[8] = { 'S', 'E', 'N', 'A', 'L', 'P', 'I', 'R' };
+static const uint32_t PIR_VERSION = 1;
+static const uint32_t PIR_MAX_NIVELES = 64;
+
+#pragma pack(push, 1)
+struct pir_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t tam_cabecera;
+    double fs;
+    uint32_t num_streams;
+    uint32_t num_niveles;
+    uint64_t num_items;
+    uint32_t valor;
+    uint32_t reservado;
+    int64_t inicio_ns;
+    uint64_t tam_original;
+};
+
+struct pir_nivel {
+    uint64_t decimacion; // muestras del original por bin
+    uint64_t num_bins;   // bins por stream
+    uint64_t offset;     // bytes desde el inicio del archivo
+};
+
+struct pir_bin {
+    float min, max, media;
+};
+#pragma pack(pop)
+static_assert(sizeof(pir_header) == 64, "pir_header debe medir 64 bytes");
+static_assert(sizeof(pir_header) + PIR_MAX_NIVELES * sizeof(pir_nivel) <= DAT_TAM_CABECERA,
+              "la tabla de niveles debe caber en la cabecera");
+
+namespace detalle_piramide {
+
+static constexpr size_t TAM_LECTURA = 4 << 20; // bytes por pread
+static constexpr size_t BINS_BUFFER = 4096;    // bins por pwrite de cada nivel
+
+// Muestras de un stream a float (magnitud para complex64)
+template <typename T>
+inline void a_float(const uint8_t* p, size_t paso, size_t n, float* x) {
+    for (size_t i = 0; i < n; i++) {
+        T v;
+        std::memcpy(&v, p + i * paso, sizeof(T));
+        x[i] = static_cast<float>(v);
+    }
+}
+
+inline void convertir(dat_dtype dtype, const uint8_t* p, size_t paso, size_t n, float* x) {
+    switch (dtype) {
+    case dat_dtype::FLOAT32: a_float<float>(p, paso, n, x); break;
+    case dat_dtype::FLOAT64: a_float<double>(p, paso, n, x); break;
+    case dat_dtype::INT16: a_float<int16_t>(p, paso, n, x); break;
+    case dat_dtype::INT32: a_float<int32_t>(p, paso, n, x); break;
+    case dat_dtype::UINT8: a_float<uint8_t>(p, paso, n, x); break;
+    case dat_dtype::COMPLEX64:
+        for (size_t i = 0; i < n; i++) {
+            std::complex<float> v;
+            std::memcpy(&v, p + i * paso, sizeof(v));
+            x[i] = std::abs(v);
+        }
+        break;
+    }
+}
+
+// Acumulador de un nivel: el bin en curso y los bins listos para escribir
+struct nivel {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+    double suma = 0.0;
+    uint64_t cuenta = 0; // muestras del original en el bin en curso
+    uint32_t hijos = 0;  // bins del nivel anterior en el bin en curso
+    uint64_t escritos = 0;
+    std::vector<pir_bin> buffer;
+};
+
+inline void leer(int fd, uint8_t* destino, size_t bytes, uint64_t offset) {
+    size_t hecho = 0;
+    while (hecho < bytes) {
+        const ssize_t r = ::pread(fd, destino + hecho, bytes - hecho, offset + hecho);
+        if (r <= 0) {
+            throw std::runtime_error("dat_piramide: error al leer el archivo original");
+        }
+        hecho += r;
+    }
+}
+
+// Frames del intercalado por tramo leído
+inline size_t frames_por_lectura(const dat_header& h) {
+    return std::max<size_t>(1, TAM_LECTURA / (size_t(h.num_streams) * h.item_size));
+}
+
+// Construye la pirámide de un stream
+class constructor {
+public:
+    constructor(int fd_dat, int fd_pir, const dat_header& h, uint64_t num_items,
+                const std::vector<pir_nivel>& niveles, uint32_t stream)
+        : d_fd_dat(fd_dat), d_fd_pir(fd_pir), d_h(h), d_num_items(num_items),
+          d_niveles(niveles), d_stream(stream), d_acc(niveles.size()) {
+        for (auto& a : d_acc) {
+            a.buffer.reserve(BINS_BUFFER);
+        }
+    }
+
+    // Planar: cada bloque del stream es contiguo y se lee solo lo propio
+    void ejecutar_planar() {
+        const size_t item = d_h.item_size;
+        const uint64_t bloque = d_h.bloque_items;
+        const size_t por_lectura = std::max<size_t>(1, TAM_LECTURA / item);
+        std::vector<uint8_t> crudo(por_lectura * item);
+        d_x.resize(por_lectura);
+        for (uint64_t inicio = 0; inicio < d_num_items; inicio += bloque) {
+            const uint64_t en_bloque = std::min(bloque, d_num_items - inicio);
+            const uint64_t base = d_h.tam_cabecera +
+                                  ((inicio / bloque) * d_h.num_streams + d_stream) * bloque * item;
+            for (uint64_t k = 0; k < en_bloque; k += por_lectura) {
+                const size_t n = std::min<uint64_t>(por_lectura, en_bloque - k);
+                leer(d_fd_dat, crudo.data(), n * item, base + k * item);
+                convertir(static_cast<dat_dtype>(d_h.dtype), crudo.data(), item, n, d_x.data());
+                agregar(d_x.data(), n);
+            }
+        }
+        terminar();
+    }
+
+    // Intercalado: n frames completos ya leídos (compartidos por todos los
+    // streams); se toma el stream propio
+    void agregar_frames(const uint8_t* frames, size_t n) {
+        const size_t item = d_h.item_size;
+        d_x.resize(std::max(d_x.size(), n));
+        convertir(static_cast<dat_dtype>(d_h.dtype), frames + d_stream * item, d_h.num_streams * item, n,
+                  d_x.data());
+        agregar(d_x.data(), n);
+    }
+
+    // Bins incompletos al final: de abajo hacia arriba, cada uno alimenta al siguiente
+    void terminar() {
+        for (size_t l = 0; l < d_acc.size(); l++) {
+            if (d_acc[l].cuenta > 0) {
+                cerrar_bin(l);
+            }
+            vaciar(l);
+        }
+    }
+
+private:
+
+    // Nivel 0 directo de las muestras, en tramos hasta completar cada bin
+    void agregar(const float* x, size_t n) {
+        nivel& a = d_acc[0];
+        const uint64_t dec = d_niveles[0].decimacion;
+        size_t i = 0;
+        while (i < n) {
+            const size_t k = std::min<uint64_t>(n - i, dec - a.cuenta);
+            float mn = a.min, mx = a.max;
+            // Forma que el compilador vectoriza (minps/maxps)
+            for (size_t j = 0; j < k; j++) {
+                const float v = x[i + j];
+                mn = v < mn ? v : mn;
+                mx = v > mx ? v : mx;
+            }
+            double suma = 0.0;
+            for (size_t j = 0; j < k; j++) {
+                suma += x[i + j];
+            }
+            a.min = mn;
+            a.max = mx;
+            a.suma += suma;
+            a.cuenta += k;
+            i += k;
+            if (a.cuenta == dec) {
+                cerrar_bin(0);
+            }
+        }
+    }
+
+    // Emite el bin en curso del nivel l y lo acumula en el nivel l + 1
+    void cerrar_bin(size_t l) {
+        nivel& a = d_acc[l];
+        a.buffer.push_back({ a.min, a.max, static_cast<float>(a.suma / a.cuenta) });
+        if (a.buffer.size() == BINS_BUFFER) {
+            vaciar(l);
+        }
+        if (l + 1 < d_acc.size()) {
+            nivel& p = d_acc[l + 1];
+            p.min = std::min(p.min, a.min);
+            p.max = std::max(p.max, a.max);
+            p.suma += a.suma;
+            p.cuenta += a.cuenta;
+            if (++p.hijos == 2) {
+                cerrar_bin(l + 1);
+            }
+        }
+        a.min = std::numeric_limits<float>::infinity();
+        a.max = -std::numeric_limits<float>::infinity();
+        a.suma = 0.0;
+        a.cuenta = 0;
+        a.hijos = 0;
+    }
+
+    void vaciar(size_t l) {
+        nivel& a = d_acc[l];
+        if (a.buffer.empty()) {
+            return;
+        }
+        const pir_nivel& nv = d_niveles[l];
+        const uint64_t offset = nv.offset + (d_stream * nv.num_bins + a.escritos) * sizeof(pir_bin);
+        const size_t bytes = a.buffer.size() * sizeof(pir_bin);
+        if (::pwrite(d_fd_pir, a.buffer.data(), bytes, offset) != static_cast<ssize_t>(bytes)) {
+            throw std::runtime_error("dat_piramide: error al escribir la pirámide");
+        }
+        a.escritos += a.buffer.size();
+        a.buffer.clear();
+    }
+
+    const int d_fd_dat, d_fd_pir;
+    const dat_header& d_h;
+    const uint64_t d_num_items;
+    const std::vector<pir_nivel>& d_niveles;
+    const uint32_t d_stream;
+    std::vector<nivel> d_acc;
+    std::vector<float> d_x; // muestras del tramo en curso, a float
+};
+
+// Intercalado: lee cada tramo una vez, en dos buffers alternados. Mientras
+// 'hilos' hilos procesan un tramo (el hilo t toma los streams t, t + hilos,
+// ...), este hilo lee el siguiente. Regresa el primer error, o vacío.
+inline std::string recorrer_intercalado(int fd_dat, std::vector<constructor>& streams, const dat_header& h,
+                                        uint64_t num_items, unsigned hilos) {
+    const size_t frame = size_t(h.num_streams) * h.item_size;
+    const size_t por_lectura = frames_por_lectura(h);
+    std::vector<uint8_t> crudo[2] = { std::vector<uint8_t>(por_lectura * frame),
+                                      std::vector<uint8_t>(por_lectura * frame) };
+    std::vector<std::string> errores(hilos + 1);
+    auto leer_tramo = [&](uint64_t inicio, std::vector<uint8_t>& destino) {
+        try {
+            const size_t n = std::min<uint64_t>(por_lectura, num_items - inicio);
+            leer(fd_dat, destino.data(), n * frame, h.tam_cabecera + inicio * frame);
+        } catch (const std::exception& e) {
+            errores[hilos] = e.what();
+        }
+    };
+
+    if (num_items > 0) {
+        leer_tramo(0, crudo[0]);
+    }
+    int actual = 0;
+    for (uint64_t inicio = 0; inicio < num_items && errores[hilos].empty(); inicio += por_lectura) {
+        const size_t n = std::min<uint64_t>(por_lectura, num_items - inicio);
+        const uint8_t* frames = crudo[actual].data();
+        std::vector<std::thread> trabajadores;
+        for (unsigned t = 0; t < hilos; t++) {
+            trabajadores.emplace_back([&, t]() {
+                try {
+                    for (size_t s = t; s < streams.size(); s += hilos) {
+                        streams[s].agregar_frames(frames, n);
+                    }
+                } catch (const std::exception& e) {
+                    errores[t] = e.what();
+                }
+            });
+        }
+        if (inicio + por_lectura < num_items) {
+            leer_tramo(inicio + por_lectura, crudo[1 - actual]);
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+        for (unsigned t = 0; t < hilos; t++) {
+            if (!errores[t].empty()) {
+                return errores[t];
+            }
+        }
+        actual = 1 - actual;
+    }
+    if (!errores[hilos].empty()) {
+        return errores[hilos];
+    }
+    try {
+        for (auto& s : streams) {
+            s.terminar();
+        }
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+} // namespace detalle_piramide
+
+// Niveles decimacion_min * 2^k hasta el primero con un solo bin
+inline std::vector<pir_nivel> niveles_piramide(uint64_t num_items, uint32_t num_streams,
+                                               uint64_t decimacion_min) {
+    std::vector<pir_nivel> niveles;
+    uint64_t offset = DAT_TAM_CABECERA;
+    for (uint64_t dec = decimacion_min; niveles.size() < PIR_MAX_NIVELES; dec *= 2) {
+        pir_nivel nv;
+        nv.decimacion = dec;
+        nv.num_bins = (num_items + dec - 1) / dec;
+        nv.offset = offset;
+        niveles.push_back(nv);
+        offset += nv.num_bins * num_streams * sizeof(pir_bin);
+        if (nv.num_bins <= 1) {
+            break;
+        }
+    }
+    return niveles;
+}
+
+// Construye <archivo_pir> a partir de <archivo_dat>. decimacion_min debe ser
+// potencia de dos; hilos = 0 usa un hilo por stream (hasta los núcleos
+// disponibles). Regresa el número de niveles.
+inline size_t construir_piramide(const std::string& archivo_dat,
+                                 const std::string& archivo_pir,
+                                 uint64_t decimacion_min = 64,
+                                 unsigned hilos = 0) {
+    if (decimacion_min == 0 || (decimacion_min & (decimacion_min - 1)) != 0) {
+        throw std::invalid_argument("dat_piramide: decimacion_min debe ser potencia de dos");
+    }
+
+    // La cabecera y el número de muestras válidas, como los interpreta dat_file
+    dat_header h;
+    uint64_t num_items;
+    uint64_t tam_original;
+    {
+        dat_file original(archivo_dat);
+        h = original.cabecera();
+        num_items = original.num_items();
+        struct stat st;
+        ::stat(archivo_dat.c_str(), &st);
+        tam_original = st.st_size;
+    }
+    if (static_cast<dat_layout>(h.layout) == dat_layout::PLANAR) {
+        if (h.bloque_items == 0) {
+            throw std::runtime_error("dat_piramide: archivo planar sin bloque_items");
+        }
+        // dat_file deduce num_items sin considerar el relleno del último bloque
+        const uint64_t bloques = (tam_original - h.tam_cabecera) /
+                                 (uint64_t(h.num_streams) * h.bloque_items * h.item_size);
+        num_items = std::min(num_items, bloques * h.bloque_items);
+    }
+
+    const auto niveles = niveles_piramide(num_items, h.num_streams, decimacion_min);
+
+    const int fd_dat = ::open(archivo_dat.c_str(), O_RDONLY);
+    const int fd_pir = ::open(archivo_pir.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_dat < 0 || fd_pir < 0) {
+        if (fd_dat >= 0) ::close(fd_dat);
+        if (fd_pir >= 0) ::close(fd_pir);
+        throw std::runtime_error("dat_piramide: no se pudo abrir " + archivo_dat + " o " + archivo_pir);
+    }
+    ::posix_fadvise(fd_dat, 0, 0, POSIX_FADV_SEQUENTIAL);
+    const uint64_t tam_pir = niveles.back().offset +
+                             niveles.back().num_bins * h.num_streams * sizeof(pir_bin);
+    ::posix_fallocate(fd_pir, 0, tam_pir);
+
+    if (hilos == 0) {
+        hilos = std::max(1u, std::thread::hardware_concurrency());
+    }
+    hilos = std::min<unsigned>(hilos, h.num_streams);
+    std::vector<std::string> errores(hilos);
+    if (static_cast<dat_layout>(h.layout) == dat_layout::PLANAR) {
+        // Un stream por tarea; cada hilo toma el siguiente stream libre
+        std::atomic<uint32_t> siguiente(0);
+        std::vector<std::thread> trabajadores;
+        for (unsigned t = 0; t < hilos; t++) {
+            trabajadores.emplace_back([&, t]() {
+                try {
+                    for (uint32_t s; (s = siguiente++) < h.num_streams;) {
+                        detalle_piramide::constructor(fd_dat, fd_pir, h, num_items, niveles, s).ejecutar_planar();
+                    }
+                } catch (const std::exception& e) {
+                    errores[t] = e.what();
+                }
+            });
+        }
+        for (auto& t : trabajadores) {
+            t.join();
+        }
+    } else {
+        std::vector<detalle_piramide::constructor> streams;
+        streams.reserve(h.num_streams);
+        for (uint32_t s = 0; s < h.num_streams; s++) {
+            streams.emplace_back(fd_dat, fd_pir, h, num_items, niveles, s);
+        }
+        errores[0] = detalle_piramide::recorrer_intercalado(fd_dat, streams, h, num_items, hilos);
+    }
+
+    // La cabecera va al final: un .pir con cabecera válida está completo
+    uint8_t bloque[DAT_TAM_CABECERA] = { 0 };
+    pir_header ph;
+    std::memset(&ph, 0, sizeof(ph));
+    std::memcpy(ph.magic, PIR_MAGIC, sizeof(PIR_MAGIC));
+    ph.version = PIR_VERSION;
+    ph.tam_cabecera = DAT_TAM_CABECERA;
+    ph.fs = h.fs;
+    ph.num_streams = h.num_streams;
+    ph.num_niveles = niveles.size();
+    ph.num_items = num_items;
+    ph.valor = static_cast<dat_dtype>(h.dtype) == dat_dtype::COMPLEX64 ? 1 : 0;
+    ph.inicio_ns = h.inicio_ns;
+    ph.tam_original = tam_original;
+    std::memcpy(bloque, &ph, sizeof(ph));
+    std::memcpy(bloque + sizeof(ph), niveles.data(), niveles.size() * sizeof(pir_nivel));
+
+    bool ok = true;
+    for (const auto& e : errores) {
+        ok = ok && e.empty();
+    }
+    if (ok) {
+        ok = ::pwrite(fd_pir, bloque, sizeof(bloque), 0) == static_cast<ssize_t>(sizeof(bloque));
+    }
+    ::close(fd_dat);
+    ::close(fd_pir);
+    if (!ok) {
+        for (const auto& e : errores) {
+            if (!e.empty()) {
+                throw std::runtime_error(e);
+            }
+        }
+        throw std::runtime_error("dat_piramide: error al escribir la cabecera de " + archivo_pir);
+    }
+    return niveles.size();
+}
+
+// Lector de una pirámide por mmap, para visores. Con archivo_dat, verifica
+// que la pirámide se haya construido a partir de ese archivo tal como está
+// ahora (mismo tamaño e inicio_ns) y si no lanza una excepción.
+class dat_piramide {
+public:
+    explicit dat_piramide(const std::string& archivo, const std::string& archivo_dat = "") {
+        d_fd = ::open(archivo.c_str(), O_RDONLY);
+        if (d_fd < 0) {
+            throw std::runtime_error("dat_piramide: no se pudo abrir " + archivo);
+        }
+        struct stat st;
+        if (::fstat(d_fd, &st) != 0 || st.st_size < static_cast<off_t>(DAT_TAM_CABECERA)) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: archivo demasiado corto: " + archivo);
+        }
+        d_tam = st.st_size;
+        void* p = ::mmap(nullptr, d_tam, PROT_READ, MAP_SHARED, d_fd, 0);
+        if (p == MAP_FAILED) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: mmap falló para " + archivo);
+        }
+        d_mapa = static_cast<const uint8_t*>(p);
+
+        std::memcpy(&d_cabecera, d_mapa, sizeof(d_cabecera));
+        if (std::memcmp(d_cabecera.magic, PIR_MAGIC, sizeof(PIR_MAGIC)) != 0 ||
+            d_cabecera.version != PIR_VERSION || d_cabecera.num_niveles == 0 ||
+            d_cabecera.num_niveles > PIR_MAX_NIVELES) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: cabecera inválida en " + archivo);
+        }
+        d_niveles.resize(d_cabecera.num_niveles);
+        std::memcpy(d_niveles.data(), d_mapa + sizeof(pir_header),
+                    d_niveles.size() * sizeof(pir_nivel));
+        const pir_nivel& u = d_niveles.back();
+        if (u.offset + u.num_bins * d_cabecera.num_streams * sizeof(pir_bin) > d_tam) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: archivo truncado: " + archivo);
+        }
+        if (!archivo_dat.empty()) {
+            verificar_original(archivo, archivo_dat);
+        }
+    }
+
+    ~dat_piramide() { cerrar(); }
+
+    dat_piramide(const dat_piramide&) = delete;
+    dat_piramide& operator=(const dat_piramide&) = delete;
+
+    const pir_header& cabecera() const { return d_cabecera; }
+    const std::vector<pir_nivel>& niveles() const { return d_niveles; }
+
+    // Nivel más fino con a lo más max_puntos bins en [muestra0, muestra1);
+    // -1 si las muestras crudas ya caben (conviene leer el .dat directamente)
+    int nivel_para(uint64_t muestra0, uint64_t muestra1, uint64_t max_puntos) const {
+        const uint64_t n = muestra1 > muestra0 ? muestra1 - muestra0 : 0;
+        if (n <= max_puntos) {
+            return -1;
+        }
+        for (size_t l = 0; l < d_niveles.size(); l++) {
+            if ((n + d_niveles[l].decimacion - 1) / d_niveles[l].decimacion <= max_puntos) {
+                return static_cast<int>(l);
+            }
+        }
+        return static_cast<int>(d_niveles.size()) - 1;
+    }
+
+    // Bins de un stream en un nivel; el bin b cubre las muestras
+    // [b * decimacion, (b + 1) * decimacion)
+    const pir_bin* bins(int nivel, uint32_t stream) const {
+        const pir_nivel& nv = d_niveles.at(nivel);
+        return reinterpret_cast<const pir_bin*>(d_mapa + nv.offset) + stream * nv.num_bins;
+    }
+
+private:
+    void verificar_original(const std::string& archivo, const std::string& archivo_dat) {
+        struct stat st;
+        dat_header h;
+        const int fd = ::open(archivo_dat.c_str(), O_RDONLY);
+        const bool leido = fd >= 0 && ::fstat(fd, &st) == 0 &&
+                           ::pread(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!leido) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: no se pudo leer " + archivo_dat);
+        }
+        if (static_cast<uint64_t>(st.st_size) != d_cabecera.tam_original || h.inicio_ns != d_cabecera.inicio_ns) {
+            cerrar();
+            throw std::runtime_error("dat_piramide: " + archivo + " no corresponde a " + archivo_dat +
+                                     " (cambió después de construirla): volver a correr ./dat_piramide");
+        }
+    }
+
+    void cerrar() {
+        if (d_mapa) {
+            ::munmap(const_cast<uint8_t*>(d_mapa), d_tam);
+            d_mapa = nullptr;
+        }
+        if (d_fd >= 0) {
+            ::close(d_fd);
+            d_fd = -1;
+        }
+    }
+
+    int d_fd = -1;
+    size_t d_tam = 0;
+    const uint8_t* d_mapa = nullptr;
+    pir_header d_cabecera;
+    std::vector<pir_nivel> d_niveles;
+};
+
+#endif // BLOQUES_DAT_PIRAMIDE_H
@@ -0,0 +1,133 @@
+// ddc_frontend.h
+// Front-end de conversión a banda base para señales reales: mezcla con un
+// NCO y filtra pasa-bajas con decimación en un solo bloque.
+//
+// En lugar de mezclar cada muestra y luego filtrar, el oscilador se pasa a
+// los coeficientes del filtro (filtro pasa-banda complejo) y solo se calculan
+// las salidas que sobreviven a la decimación:
+//
+//     y[m] = sum_k h[k] x[mD-k] e^{jw(mD-k)}
+//          = e^{jwmD} * sum_k (h[k] e^{-jwk}) x[mD-k]
+//
+// Así el costo por muestra de entrada es ntaps/D multiplicaciones y el
+// oscilador solo corre a la tasa de salida. La convención de signo es la
+// misma que la de sig_source_c(GR_COS_WAVE) + multiply_cc.
+//
+// La fase del oscilador se calcula a partir del índice absoluto de la
+// muestra (acumulador de punto fijo de 64 bits), no por recurrencia. Con
+// muestra_inicial un flujo que empieza a la mitad de un archivo produce las
+// mismas salidas que el flujo completo (ver el modo por bloques de
+// msk_phase_wav).
+
+#ifndef BLOQUES_DDC_FRONTEND_H
+#define BLOQUES_DDC_FRONTEND_H
+
+#include <gnuradio/filter/fir_filter.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_decimator.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+class ddc_frontend : public gr::sync_decimator {
+public:
+    typedef std::shared_ptr<ddc_frontend> sptr;
+
+    // samp_rate: tasa de la señal real de entrada
+    // fc: frecuencia de la portadora a llevar a 0 Hz
+    // cutoff, trans: corte y ancho de transición del pasa-bajas (Hz)
+    // sobremuestreo: tasa de salida mínima en múltiplos de 2*(cutoff + trans)
+    // muestra_inicial: índice absoluto de la primera muestra de entrada
+    //                  (múltiplo de la decimación)
+    static sptr make(double samp_rate,
+                     double fc,
+                     double cutoff,
+                     double trans,
+                     double sobremuestreo = 1.0,
+                     uint64_t muestra_inicial = 0) {
+        return gnuradio::get_initial_sptr(
+            new ddc_frontend(samp_rate, fc, cutoff, trans, sobremuestreo, muestra_inicial));
+    }
+
+    // Mayor decimación entera que deja la banda de rechazo del filtro
+    // (cutoff + trans) por debajo de Nyquist de la tasa de salida.
+    static int elegir_decimacion(double samp_rate,
+                                 double cutoff,
+                                 double trans,
+                                 double sobremuestreo = 1.0) {
+        const double tasa_minima = 2.0 * (cutoff + trans) * sobremuestreo;
+        const int d = static_cast<int>(std::floor(samp_rate / tasa_minima));
+        return d > 1 ? d : 1;
+    }
+
+    ddc_frontend(double samp_rate,
+                 double fc,
+                 double cutoff,
+                 double trans,
+                 double sobremuestreo,
+                 uint64_t muestra_inicial)
+        : gr::sync_decimator("ddc_frontend",
+                             gr::io_signature::make(1, 1, sizeof(float)),
+                             gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                             elegir_decimacion(samp_rate, cutoff, trans, sobremuestreo)),
+          d_samp_rate(samp_rate),
+          d_fir(disenar_taps(samp_rate, fc, cutoff, trans)) {
+        if (muestra_inicial % decimation() != 0) {
+            throw std::invalid_argument("ddc_frontend: muestra_inicial debe ser múltiplo de la decimación");
+        }
+        // Avance del NCO por muestra de salida, en fracciones de ciclo * 2^64
+        const double ciclos = fc * decimation() / samp_rate;
+        d_nco_incr = static_cast<uint64_t>(
+            static_cast<int64_t>(std::ldexp(ciclos - std::round(ciclos), 63))) << 1;
+        d_salida = muestra_inicial / decimation();
+        set_history(d_fir.ntaps());
+    }
+
+    unsigned ntaps() const { return d_fir.ntaps(); }
+    double tasa_salida() const { return d_samp_rate / decimation(); }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        const float* in = (const float*)input_items[0];
+        gr_complex* out = (gr_complex*)output_items[0];
+
+        d_fir.filterNdec(out, in, noutput_items, decimation());
+        for (int i = 0; i < noutput_items; i++) {
+            const uint64_t fase = (d_salida + i) * d_nco_incr;
+            const double radianes = static_cast<int64_t>(fase) * (M_PI / 9223372036854775808.0);
+            out[i] *= gr_complex(std::cos(radianes), std::sin(radianes));
+        }
+        d_salida += noutput_items;
+        return noutput_items;
+    }
+
+private:
+    // Pasa-bajas de firdes desplazado a -fc: b[k] = h[k] e^{-jwk}
+    static std::vector<gr_complex>
+    disenar_taps(double samp_rate, double fc, double cutoff, double trans) {
+        if (cutoff <= 0 || trans <= 0 || cutoff + trans >= samp_rate / 2) {
+            throw std::invalid_argument("ddc_frontend: cutoff/trans fuera de rango");
+        }
+        const std::vector<float> h = gr::filter::firdes::low_pass(
+            1.0, samp_rate, cutoff, trans, gr::fft::window::win_type::WIN_HAMMING);
+
+        const double w = 2.0 * M_PI * fc / samp_rate;
+        std::vector<gr_complex> taps(h.size());
+        for (size_t k = 0; k < h.size(); k++) {
+            taps[k] = h[k] * std::polar(1.0f, static_cast<float>(-w * k));
+        }
+        return taps;
+    }
+
+    const double d_samp_rate;
+    gr::filter::kernel::fir_filter_fcc d_fir;
+    uint64_t d_nco_incr; // fase por muestra de salida (2^64 = un ciclo)
+    uint64_t d_salida;   // índice absoluto de la siguiente muestra de salida
+};
+
+#endif // BLOQUES_DDC_FRONTEND_H
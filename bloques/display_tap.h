@@ -0,0 +1,270 @@
+// display_tap.h
+// Derivación para visualización que nunca frena el procesamiento.
+//
+// Un time_sink de Qt conectado al flujo toma todas las muestras aunque solo
+// dibuje 1024 puntos cada 0.1 s, y si la ventana se atrasa (minimizada, un
+// equipo cargado) llena sus buffers de entrada y detiene a los bloques
+// anteriores, hasta causar sobreflujos en la tarjeta de sonido.
+//
+// display_tap es un sumidero que va en el flujo de procesamiento. Cada
+// 'periodo' segundos de señal arma un cuadro de 'puntos' valores:
+//   INSTANTANEA  los primeros 'puntos' valores del periodo, sin cambios
+//                (como el modo libre del time_sink); el resto solo se cuenta
+//   MINMAX       todo el periodo en puntos/2 intervalos, cada uno como su
+//                mínimo y su máximo (envolvente; por componente si es complejo)
+// y lo publica en un buffer compartido de tres cuadros: uno lo escribe el
+// tap, otro lo lee la GUI y el tercero es el último cuadro listo. Publicar o
+// tomar un cuadro es un intercambio atómico de índices, sin candados: work()
+// nunca espera a la GUI. Si un cuadro listo se reemplaza antes de que la GUI
+// lo tome, cuenta como descartado.
+//
+// display_source va en un flujo aparte (el de la GUI) y entrega cada cuadro
+// nuevo una sola vez, de 'puntos' en 'puntos', al time_sink. Si ese flujo se
+// atrasa, solo se atrasa él.
+//
+// Tipos: display_tap_f / display_source_f (float) y display_tap_c /
+// display_source_c (gr_complex).
+
+#ifndef BLOQUES_DISPLAY_TAP_H
+#define BLOQUES_DISPLAY_TAP_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Tres cuadros de 'puntos' valores para un escritor y un lector
+template <class T>
+class display_buffer {
+public:
+    explicit display_buffer(int puntos) : d_puntos(puntos) {
+        for (auto& c : d_cuadros) {
+            c.assign(puntos, T());
+        }
+    }
+
+    int puntos() const { return d_puntos; }
+
+    // Lado del tap: cuadro donde escribir el siguiente
+    T* cuadro_escritura() { return d_cuadros[d_atras].data(); }
+
+    // Lado del tap: publica el cuadro escrito. Regresa true si reemplazó un
+    // cuadro que la GUI no alcanzó a tomar.
+    bool publicar() {
+        const int previo = d_listo.exchange(d_atras | NUEVO, std::memory_order_acq_rel);
+        d_atras = previo & INDICE;
+        return previo & NUEVO;
+    }
+
+    // Lado de la GUI: el cuadro publicado más reciente, o nullptr si no hay
+    // uno nuevo desde la última llamada
+    const T* tomar() {
+        if (!(d_listo.load(std::memory_order_acquire) & NUEVO)) {
+            return nullptr;
+        }
+        d_frente = d_listo.exchange(d_frente, std::memory_order_acq_rel) & INDICE;
+        return d_cuadros[d_frente].data();
+    }
+
+private:
+    static constexpr int INDICE = 3;
+    static constexpr int NUEVO = 4;
+
+    const int d_puntos;
+    std::vector<T> d_cuadros[3];
+    int d_atras = 0;                  // del escritor
+    alignas(64) std::atomic<int> d_listo{ 1 };
+    alignas(64) int d_frente = 2;     // del lector
+};
+
+template <class T>
+class display_tap : public gr::sync_block {
+public:
+    typedef std::shared_ptr<display_tap<T>> sptr;
+
+    enum class modo { INSTANTANEA, MINMAX };
+
+    // samp_rate: tasa de la entrada
+    // puntos: valores por cuadro (el 'size' del time_sink)
+    // periodo: segundos de señal entre cuadros
+    static sptr make(double samp_rate, int puntos = 1024, double periodo = 0.1,
+                     modo m = modo::INSTANTANEA) {
+        return gnuradio::get_initial_sptr(new display_tap<T>(samp_rate, puntos, periodo, m));
+    }
+
+    display_tap(double samp_rate, int puntos, double periodo, modo m)
+        : gr::sync_block("display_tap",
+                         gr::io_signature::make(1, 1, sizeof(T)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_modo(m),
+          d_puntos(puntos),
+          d_buffer(std::make_shared<display_buffer<T>>(puntos)) {
+        if (puntos < 2 || (m == modo::MINMAX && puntos % 2 != 0)) {
+            throw std::invalid_argument("display_tap: puntos debe ser par y al menos 2");
+        }
+        if (samp_rate <= 0 || periodo <= 0) {
+            throw std::invalid_argument("display_tap: samp_rate y periodo deben ser positivos");
+        }
+        // Periodo en muestras; en MINMAX, múltiplo del largo de un intervalo
+        const int64_t periodo_muestras =
+            std::max<int64_t>(puntos, std::llround(periodo * samp_rate));
+        if (m == modo::MINMAX) {
+            d_intervalo = std::max<int64_t>(1, periodo_muestras / (puntos / 2));
+            d_periodo = d_intervalo * (puntos / 2);
+            d_tasa_vista = samp_rate * 2 / d_intervalo;
+        } else {
+            d_periodo = periodo_muestras;
+            d_tasa_vista = samp_rate;
+        }
+    }
+
+    std::shared_ptr<display_buffer<T>> buffer() const { return d_buffer; }
+    int puntos() const { return d_puntos; }
+    // Puntos por segundo de señal dentro de un cuadro (para el eje del time_sink)
+    double tasa_vista() const { return d_tasa_vista; }
+    uint64_t cuadros() const { return d_cuadros.load(std::memory_order_relaxed); }
+    uint64_t descartados() const { return d_descartados.load(std::memory_order_relaxed); }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        const T* in = (const T*)input_items[0];
+        for (int i = 0; i < noutput_items;) {
+            const int n = static_cast<int>(std::min<int64_t>(noutput_items - i, d_periodo - d_posicion));
+            if (d_modo == modo::INSTANTANEA) {
+                copiar(in + i, n);
+            } else {
+                envolvente(in + i, n);
+            }
+            i += n;
+            d_posicion += n;
+            if (d_posicion == d_periodo) {
+                d_posicion = 0;
+                if (d_buffer->publicar()) {
+                    d_descartados.fetch_add(1, std::memory_order_relaxed);
+                }
+                d_cuadros.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return noutput_items;
+    }
+
+private:
+    // Los primeros 'puntos' valores del periodo
+    void copiar(const T* in, int n) {
+        if (d_posicion < d_puntos) {
+            const int cuantos = static_cast<int>(std::min<int64_t>(n, d_puntos - d_posicion));
+            std::memcpy(d_buffer->cuadro_escritura() + d_posicion, in, cuantos * sizeof(T));
+        }
+    }
+
+    // Mínimo y máximo de cada intervalo; un intervalo puede quedar repartido
+    // entre dos llamadas
+    void envolvente(const T* in, int n) {
+        T* cuadro = d_buffer->cuadro_escritura();
+        int64_t pos = d_posicion;
+        for (int i = 0; i < n;) {
+            const int64_t en_intervalo = pos % d_intervalo;
+            const int m = static_cast<int>(std::min<int64_t>(n - i, d_intervalo - en_intervalo));
+            if (en_intervalo == 0) {
+                d_min = d_max = in[i];
+            }
+            acumular(in + i, m, d_min, d_max);
+            i += m;
+            pos += m;
+            if (pos % d_intervalo == 0) {
+                const int64_t k = pos / d_intervalo - 1;
+                cuadro[2 * k] = d_min;
+                cuadro[2 * k + 1] = d_max;
+            }
+        }
+    }
+
+    static void acumular(const float* x, int n, float& mn, float& mx) {
+        float a = mn, b = mx;
+        for (int i = 0; i < n; i++) {
+            a = x[i] < a ? x[i] : a;
+            b = x[i] > b ? x[i] : b;
+        }
+        mn = a;
+        mx = b;
+    }
+
+    static void acumular(const gr_complex* x, int n, gr_complex& mn, gr_complex& mx) {
+        // Los complejos se ven como pares de float (re, im)
+        const float* v = reinterpret_cast<const float*>(x);
+        float re_a = mn.real(), re_b = mx.real(), im_a = mn.imag(), im_b = mx.imag();
+        for (int i = 0; i < n; i++) {
+            const float re = v[2 * i], im = v[2 * i + 1];
+            re_a = re < re_a ? re : re_a;
+            re_b = re > re_b ? re : re_b;
+            im_a = im < im_a ? im : im_a;
+            im_b = im > im_b ? im : im_b;
+        }
+        mn = gr_complex(re_a, im_a);
+        mx = gr_complex(re_b, im_b);
+    }
+
+    const modo d_modo;
+    const int d_puntos;
+    int64_t d_periodo;       // muestras por cuadro
+    int64_t d_intervalo = 1; // MINMAX: muestras por par mínimo/máximo
+    double d_tasa_vista;
+    int64_t d_posicion = 0;  // muestra dentro del periodo actual
+    T d_min = T(), d_max = T();
+    std::shared_ptr<display_buffer<T>> d_buffer;
+    std::atomic<uint64_t> d_cuadros{ 0 };
+    std::atomic<uint64_t> d_descartados{ 0 };
+};
+
+template <class T>
+class display_source : public gr::sync_block {
+public:
+    typedef std::shared_ptr<display_source<T>> sptr;
+
+    static sptr make(const typename display_tap<T>::sptr& tap) {
+        return gnuradio::get_initial_sptr(new display_source<T>(tap->buffer()));
+    }
+
+    explicit display_source(std::shared_ptr<display_buffer<T>> buffer)
+        : gr::sync_block("display_source",
+                         gr::io_signature::make(0, 0, 0),
+                         gr::io_signature::make(1, 1, sizeof(T))),
+          d_buffer(buffer) {
+        set_output_multiple(d_buffer->puntos());
+    }
+
+    int work(int,
+             gr_vector_const_void_star&,
+             gr_vector_void_star& output_items) override {
+        // Sin cuadro nuevo se regresa sin salida tras una pausa corta, para
+        // no ocupar el CPU ni retrasar tb->stop()
+        const T* cuadro = d_buffer->tomar();
+        if (!cuadro) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return 0;
+        }
+        std::memcpy(output_items[0], cuadro, d_buffer->puntos() * sizeof(T));
+        return d_buffer->puntos();
+    }
+
+private:
+    std::shared_ptr<display_buffer<T>> d_buffer;
+};
+
+typedef display_tap<float> display_tap_f;
+typedef display_tap<gr_complex> display_tap_c;
+typedef display_source<float> display_source_f;
+typedef display_source<gr_complex> display_source_c;
+
+#endif // BLOQUES_DISPLAY_TAP_H
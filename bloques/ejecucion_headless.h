@@ -0,0 +1,128 @@
+// ejecucion_headless.h
+// Utilidades para correr los programas de Qt sin ventana (--headless).
+//
+// En modo headless no se crea QApplication ni los time sinks, así que el
+// programa funciona en servidores sin display:
+//   * Con entrada de archivo el flujo corre a toda velocidad hasta EOF.
+//   * Con entrada en vivo (tarjeta de sonido, generadores) corre hasta
+//     recibir SIGINT o SIGTERM, o hasta que el flujo termine solo (un
+//     anillo shm: cuyo productor se detuvo, un sumidero con error de disco).
+// Al terminar se imprime el total de muestras, el tiempo transcurrido y el
+// factor de tiempo real (segundos de señal procesados por segundo de reloj).
+
+#ifndef BLOQUES_EJECUCION_HEADLESS_H
+#define BLOQUES_EJECUCION_HEADLESS_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/top_block.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+// Busca la opción en argv y la quita, para que Qt no la vea
+inline bool tomar_opcion(int& argc, char** argv, const char* opcion) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], opcion) == 0) {
+            for (int j = i; j < argc - 1; j++) {
+                argv[j] = argv[j + 1];
+            }
+            argc--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Busca "opcion valor" en argv, lo quita y regresa el valor (o por_defecto)
+inline double tomar_valor(int& argc, char** argv, const char* opcion, double por_defecto) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (std::strcmp(argv[i], opcion) == 0) {
+            const double valor = std::atof(argv[i + 1]);
+            for (int j = i; j < argc - 2; j++) {
+                argv[j] = argv[j + 2];
+            }
+            argc -= 2;
+            return valor;
+        }
+    }
+    return por_defecto;
+}
+
+// Como tomar_valor, para opciones de texto (nombres de archivo)
+inline std::string tomar_texto(int& argc, char** argv, const char* opcion, const std::string& por_defecto) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (std::strcmp(argv[i], opcion) == 0) {
+            const std::string valor = argv[i + 1];
+            for (int j = i; j < argc - 2; j++) {
+                argv[j] = argv[j + 2];
+            }
+            argc -= 2;
+            return valor;
+        }
+    }
+    return por_defecto;
+}
+
+// Resumen de rendimiento al terminar una corrida sin GUI
+inline void imprimir_resumen(uint64_t muestras, double fs, double segundos) {
+    std::cout << "Muestras procesadas: " << muestras << std::endl;
+    std::cout << "Tiempo transcurrido: " << segundos << " s" << std::endl;
+    std::cout << "Factor de tiempo real: " << (muestras / fs) / segundos << "x" << std::endl;
+}
+
+// Corre el flujo sin GUI y reporta el rendimiento.
+// fuente: bloque cuyas muestras de salida se cuentan; fs: su tasa de muestreo.
+// hasta_eof: true si la fuente termina sola (archivo), false si es en vivo.
+inline void ejecutar_headless(gr::top_block_sptr tb,
+                              gr::block_sptr fuente,
+                              double fs,
+                              bool hasta_eof) {
+    const auto t0 = std::chrono::steady_clock::now();
+
+    if (hasta_eof) {
+        tb->run();
+    } else {
+        // Las señales se bloquean antes de crear los hilos del scheduler
+        // (los heredan) y se atienden aquí con sigwait
+        sigset_t senales;
+        sigemptyset(&senales);
+        sigaddset(&senales, SIGINT);
+        sigaddset(&senales, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &senales, nullptr);
+
+        tb->start();
+        std::cout << "Corriendo sin GUI, Ctrl+C para detener." << std::endl;
+
+        // Solo este hilo llama a wait(); si el flujo termina solo, despierta
+        // al sigwait con SIGTERM. 'detenido' decide quién llegó primero.
+        std::atomic<bool> detenido{ false };
+        std::thread espera([&] {
+            tb->wait();
+            if (!detenido.exchange(true)) {
+                std::cout << "El flujo terminó." << std::endl;
+                ::kill(::getpid(), SIGTERM);
+            }
+        });
+        int senal = 0;
+        sigwait(&senales, &senal);
+        if (!detenido.exchange(true)) {
+            tb->stop();
+        }
+        espera.join();
+    }
+
+    const double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    imprimir_resumen(fuente->nitems_written(0), fs, segundos);
+}
+
+#endif // BLOQUES_EJECUCION_HEADLESS_H
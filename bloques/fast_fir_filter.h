@@ -0,0 +1,221 @@
+// fast_fir_filter.h
+// Filtro FIR con la misma construcción que fir_filter_fff/ccf
+// (decimación, coeficientes) que elige entre dos implementaciones:
+//
+//  * Directa: el kernel fir_filter de GNU Radio (producto punto con VOLK).
+//    Cuesta ntaps/D multiplicaciones por muestra de entrada.
+//  * FFT overlap-save: convolución rápida por segmentos de nfft muestras,
+//    con los planes de FFTW y los buffers alineados de gr::fft creados una
+//    sola vez. Cuesta O(log nfft) por muestra, sin importar ntaps.
+//
+// Con umbral < 0 (por defecto) el cruce se decide con un microbenchmark al
+// construir el bloque: se miden ambas rutas con los mismos taps y se queda
+// la más rápida. El resultado se guarda por (tipo, ntaps, decimación) para
+// no repetir la medición en cada instancia.
+
+#ifndef BLOQUES_FAST_FIR_FILTER_H
+#define BLOQUES_FAST_FIR_FILTER_H
+
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/filter/fir_filter.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_decimator.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Convolución rápida overlap-save para taps reales y muestras T (float o
+// gr_complex). filtrar() sigue la convención de los bloques con historia:
+// in[0] es la muestra más antigua y debe haber (noutput-1)*D + ntaps muestras.
+template <class T>
+class overlap_save {
+public:
+    overlap_save(const std::vector<float>& taps, int nfft)
+        : d_ntaps(taps.size()),
+          d_nfft(nfft),
+          d_nuevas(nfft - taps.size() + 1),
+          d_fwd(nfft),
+          d_rev(nfft),
+          d_H(nbins()) {
+        if (d_nuevas < 1) {
+            throw std::invalid_argument("overlap_save: nfft debe ser mayor que ntaps");
+        }
+        // Respuesta en frecuencia de los taps, con la escala 1/N de la IFFT
+        T* x = d_fwd.get_inbuf();
+        std::fill(x, x + d_nfft, T(0));
+        for (size_t k = 0; k < taps.size(); k++) {
+            x[k] = T(taps[k] / d_nfft);
+        }
+        d_fwd.execute();
+        std::copy(d_fwd.get_outbuf(), d_fwd.get_outbuf() + nbins(), d_H.begin());
+    }
+
+    int nfft() const { return d_nfft; }
+
+    void filtrar(const T* in, T* out, int noutput, int decimacion) {
+        // Posiciones a tasa completa que hay que calcular
+        const int ncompletas = (noutput - 1) * decimacion + 1;
+        T* x = d_fwd.get_inbuf();
+        const T* y = d_rev.get_outbuf() + d_ntaps - 1; // primera salida válida
+
+        for (int inicio = 0; inicio < ncompletas; inicio += d_nuevas) {
+            const int m = std::min(d_nuevas, ncompletas - inicio);
+            const int nin = m + d_ntaps - 1;
+            std::copy(in + inicio, in + inicio + nin, x);
+            std::fill(x + nin, x + d_nfft, T(0));
+
+            d_fwd.execute();
+            volk_32fc_x2_multiply_32fc(d_rev.get_inbuf(), d_fwd.get_outbuf(), d_H.data(), nbins());
+            d_rev.execute();
+
+            if (decimacion == 1) {
+                std::copy(y, y + m, out + inicio);
+            } else {
+                // Primera posición del segmento que cae en la rejilla decimada
+                int j = (inicio + decimacion - 1) / decimacion * decimacion;
+                for (; j < inicio + m; j += decimacion) {
+                    out[j / decimacion] = y[j - inicio];
+                }
+            }
+        }
+    }
+
+private:
+    // La FFT real solo produce nfft/2+1 bins
+    int nbins() const { return std::is_same<T, float>::value ? d_nfft / 2 + 1 : d_nfft; }
+
+    const int d_ntaps;
+    const int d_nfft;
+    const int d_nuevas; // muestras nuevas por segmento
+    gr::fft::fft<T, true> d_fwd;
+    gr::fft::fft<T, false> d_rev;
+    volk::vector<gr_complex> d_H;
+};
+
+template <class T>
+class fast_fir_filter : public gr::sync_decimator {
+public:
+    typedef std::shared_ptr<fast_fir_filter<T>> sptr;
+
+    // umbral: ntaps a partir del cual se usa FFT; < 0 para decidirlo midiendo
+    static sptr make(int decimacion, const std::vector<float>& taps, int umbral = -1) {
+        return gnuradio::get_initial_sptr(new fast_fir_filter<T>(decimacion, taps, umbral));
+    }
+
+    fast_fir_filter(int decimacion, const std::vector<float>& taps, int umbral)
+        : gr::sync_decimator("fast_fir_filter",
+                             gr::io_signature::make(1, 1, sizeof(T)),
+                             gr::io_signature::make(1, 1, sizeof(T)),
+                             decimacion),
+          d_directo(taps) {
+        if (taps.empty()) {
+            throw std::invalid_argument("fast_fir_filter: se requiere al menos un tap");
+        }
+        int nfft = nfft_sugerido(taps.size());
+        if (umbral < 0) {
+            nfft = elegir_ruta(taps, decimacion);
+        } else if (static_cast<int>(taps.size()) < umbral) {
+            nfft = 0;
+        }
+        if (nfft > 0) {
+            d_fft.reset(new overlap_save<T>(taps, nfft));
+        }
+        set_history(taps.size());
+    }
+
+    bool usa_fft() const { return d_fft != nullptr; }
+    int nfft() const { return d_fft ? d_fft->nfft() : 0; }
+    unsigned ntaps() const { return d_directo.ntaps(); }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        const T* in = (const T*)input_items[0];
+        T* out = (T*)output_items[0];
+
+        if (d_fft) {
+            d_fft->filtrar(in, out, noutput_items, decimation());
+        } else {
+            d_directo.filterNdec(out, in, noutput_items, decimation());
+        }
+        return noutput_items;
+    }
+
+    // Tamaño de FFT razonable sin medir: potencia de 2 de al menos 4*ntaps
+    static int nfft_sugerido(size_t ntaps) {
+        int n = 64;
+        while (n < 4 * static_cast<int>(ntaps)) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+private:
+    // Microbenchmark: regresa el nfft más rápido, o 0 si gana la ruta directa
+    static int elegir_ruta(const std::vector<float>& taps, int decimacion) {
+        static std::mutex cache_mutex;
+        static std::map<std::tuple<size_t, int>, int> cache;
+
+        const auto clave = std::make_tuple(taps.size(), decimacion);
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(clave);
+        if (it != cache.end()) {
+            return it->second;
+        }
+
+        const int noutput = 16384 / decimacion;
+        std::vector<T> in(noutput * decimacion + taps.size(), T(0.5f));
+        std::vector<T> out(noutput);
+
+        gr::filter::kernel::fir_filter<T, T, float> directo(taps);
+        double mejor = medir([&] { directo.filterNdec(out.data(), in.data(), noutput, decimacion); });
+        int mejor_nfft = 0;
+
+        // Candidatos: de 2*ntaps a 16*ntaps en potencias de 2
+        for (int nfft = nfft_sugerido(taps.size()) / 2; nfft <= 4 * nfft_sugerido(taps.size());
+             nfft <<= 1) {
+            if (nfft <= static_cast<int>(taps.size())) {
+                continue;
+            }
+            overlap_save<T> os(taps, nfft);
+            const double t = medir([&] { os.filtrar(in.data(), out.data(), noutput, decimacion); });
+            if (t < mejor) {
+                mejor = t;
+                mejor_nfft = nfft;
+            }
+        }
+        cache[clave] = mejor_nfft;
+        return mejor_nfft;
+    }
+
+    // Mejor tiempo de varias repeticiones (descarta interrupciones del SO)
+    template <class F>
+    static double medir(F&& f) {
+        f(); // calentar caché
+        double mejor = 1e30;
+        for (int r = 0; r < 5; r++) {
+            const auto t0 = std::chrono::steady_clock::now();
+            f();
+            const auto t1 = std::chrono::steady_clock::now();
+            mejor = std::min(mejor, std::chrono::duration<double>(t1 - t0).count());
+        }
+        return mejor;
+    }
+
+    gr::filter::kernel::fir_filter<T, T, float> d_directo;
+    std::unique_ptr<overlap_save<T>> d_fft;
+};
+
+typedef fast_fir_filter<float> fast_fir_filter_fff;
+typedef fast_fir_filter<gr_complex> fast_fir_filter_ccf;
+
+#endif // BLOQUES_FAST_FIR_FILTER_H
@@ -0,0 +1,384 @@
+// flac_sink.h
+// Sumidero multicanal con compresión sin pérdidas (FLAC, vía libsndfile).
+//
+// Igual que wav_segment_sink, work() solo copia las muestras a buffers
+// circulares SPSC y nunca bloquea; la codificación corre en hilos aparte,
+// uno por archivo de salida (no un grupo de hilos compartido):
+//   * INTERCALADO: un archivo con todos los canales (<prefijo>_NNNNNN.flac),
+//     codificados en un solo hilo; ese núcleo limita la tasa total
+//   * POR_CANAL:   un archivo por canal (<prefijo>_chC_NNNNNN.flac), un hilo
+//     por canal: la carga se reparte entre varios núcleos
+// Si el factor de tiempo real intercalado de bench/flac_bench.cpp no pasa
+// de 1 con la tasa y canales de la captura, usar POR_CANAL.
+// Con muestras_por_segmento = 0 no hay rotación y el número de segmento se
+// omite del nombre. Cada archivo lleva en sus comentarios (Vorbis) la
+// muestra inicial, la tasa y el canal, y la hora UTC de inicio en la fecha;
+// el índice <prefijo>_segmentos.csv lista todos los archivos.
+//
+// Si un buffer se llena, las muestras que no caben se escriben como ceros
+// al reanudar (el hueco pasa por spsc_frames como un largo; descartados() las
+// cuenta) y los índices siguen siendo exactos. Un error al escribir detiene a
+// los codificadores: work() lo reporta en stderr y termina el flujo, y
+// error() regresa el mensaje.
+// Requiere enlazar con libsndfile (-lsndfile).
+//
+// Entrada: un puerto float por canal (como la salida de audio::source).
+
+#ifndef BLOQUES_FLAC_SINK_H
+#define BLOQUES_FLAC_SINK_H
+
+#include "spsc_ring.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <sndfile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Un archivo FLAC abierto para escritura con frames float intercalados
+class flac_codificador {
+public:
+    // bits: 16 o 24; comentario y fecha se guardan como comentarios Vorbis
+    flac_codificador(const std::string& archivo,
+                     int canales,
+                     double samp_rate,
+                     int bits,
+                     const std::string& comentario = "",
+                     const std::string& fecha = "")
+        : d_archivo(archivo) {
+        SF_INFO info = {};
+        info.samplerate = static_cast<int>(std::lround(samp_rate));
+        info.channels = canales;
+        info.format = SF_FORMAT_FLAC | (bits == 24 ? SF_FORMAT_PCM_24 : SF_FORMAT_PCM_16);
+        d_sf = sf_open(archivo.c_str(), SFM_WRITE, &info);
+        if (!d_sf) {
+            throw std::runtime_error("flac_codificador: no se pudo abrir " + archivo + ": " +
+                                     sf_strerror(nullptr));
+        }
+        // Saturar en lugar de dar la vuelta con muestras fuera de [-1, 1]
+        sf_command(d_sf, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+        // En FLAC los comentarios deben fijarse antes de la primera escritura
+        if (!comentario.empty()) {
+            sf_set_string(d_sf, SF_STR_COMMENT, comentario.c_str());
+        }
+        if (!fecha.empty()) {
+            sf_set_string(d_sf, SF_STR_DATE, fecha.c_str());
+        }
+        sf_set_string(d_sf, SF_STR_SOFTWARE, "flac_sink");
+    }
+
+    ~flac_codificador() { sf_close(d_sf); }
+
+    flac_codificador(const flac_codificador&) = delete;
+    flac_codificador& operator=(const flac_codificador&) = delete;
+
+    void escribir(const float* x, uint64_t frames) {
+        if (sf_writef_float(d_sf, x, frames) != static_cast<sf_count_t>(frames)) {
+            throw std::runtime_error("flac_codificador: error al escribir " + d_archivo + ": " +
+                                     sf_strerror(d_sf));
+        }
+    }
+
+private:
+    const std::string d_archivo;
+    SNDFILE* d_sf = nullptr;
+};
+
+class flac_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<flac_sink> sptr;
+
+    enum class disposicion { INTERCALADO, POR_CANAL };
+
+    // prefijo: nombre de los archivos sin sufijos ni ".flac"
+    // bits: 16 o 24
+    // muestras_por_segmento: muestras por canal de cada archivo (0: un solo archivo)
+    // muestras_totales: el flujo termina al recibirlas (0: sin límite)
+    // capacidad: tamaño de cada buffer circular en muestras por canal
+    static sptr make(const std::string& prefijo,
+                     int canales,
+                     double samp_rate,
+                     disposicion disp = disposicion::INTERCALADO,
+                     int bits = 16,
+                     uint64_t muestras_por_segmento = 0,
+                     uint64_t muestras_totales = 0,
+                     size_t capacidad = 1 << 21) {
+        return gnuradio::get_initial_sptr(new flac_sink(prefijo, canales, samp_rate, disp, bits,
+                                                        muestras_por_segmento, muestras_totales,
+                                                        capacidad));
+    }
+
+    flac_sink(const std::string& prefijo,
+              int canales,
+              double samp_rate,
+              disposicion disp,
+              int bits,
+              uint64_t muestras_por_segmento,
+              uint64_t muestras_totales,
+              size_t capacidad)
+        : gr::sync_block("flac_sink",
+                         gr::io_signature::make(canales, canales, sizeof(float)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_prefijo(prefijo),
+          d_samp_rate(samp_rate),
+          d_bits(bits),
+          d_por_segmento(muestras_por_segmento),
+          d_totales(muestras_totales) {
+        if (canales < 1 || samp_rate <= 0 || (bits != 16 && bits != 24)) {
+            throw std::invalid_argument("flac_sink: canales y samp_rate positivos, bits 16 o 24");
+        }
+        // Un flujo (buffer + hilo codificador) por archivo de salida
+        const bool por_canal = disp == disposicion::POR_CANAL && canales > 1;
+        const int nflujos = por_canal ? canales : 1;
+        for (int f = 0; f < nflujos; f++) {
+            d_flujos.emplace_back(new flujo(por_canal ? f : 0, por_canal ? 1 : canales, capacidad));
+            d_flujos.back()->sufijo = por_canal ? "_ch" + std::to_string(f) : "";
+        }
+    }
+
+    ~flac_sink() override { detener_codificadores(); }
+
+    // Muestras por canal reemplazadas por ceros porque algún buffer estaba lleno
+    uint64_t descartados() const { return d_descartados.load(std::memory_order_relaxed); }
+
+    // Ocupación máxima que alcanzó un buffer, en muestras por canal
+    size_t ocupacion_maxima() const { return d_ocupacion_maxima.load(std::memory_order_relaxed); }
+
+    // Archivos cerrados hasta ahora
+    unsigned archivos() const { return d_archivos.load(std::memory_order_relaxed); }
+
+    // Error que detuvo a un codificador, o vacío
+    std::string error() const { return d_fallo.load(std::memory_order_acquire) ? d_error : std::string(); }
+
+    bool start() override {
+        // La hora de la muestra 0 se toma al arrancar el flujo
+        d_inicio_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+        const std::string indice = d_prefijo + "_segmentos.csv";
+        d_indice = std::fopen(indice.c_str(), "w");
+        if (!d_indice) {
+            throw std::runtime_error("flac_sink: no se pudo abrir " + indice);
+        }
+        std::fputs("archivo,canal_inicial,canales,muestra_inicial,muestras,inicio_utc_ns\n", d_indice);
+
+        d_corriendo = true;
+        for (auto& f : d_flujos) {
+            f->hilo = std::thread(&flac_sink::codificador, this, f.get());
+        }
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        for (auto& f : d_flujos) {
+            f->frames.terminar();
+        }
+        detener_codificadores();
+        return gr::sync_block::stop();
+    }
+
+    // Solo intercala y copia a los buffers: sin E/S ni reservas de memoria
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        if (d_fallo.load(std::memory_order_acquire)) {
+            std::fprintf(stderr, "%s\n", d_error.c_str());
+            return WORK_DONE;
+        }
+        uint64_t n = noutput_items;
+        if (d_totales > 0) {
+            n = std::min(n, d_totales - d_recibidas);
+        }
+
+        bool descartado = false;
+        for (auto& f : d_flujos) {
+            // Frames completos o nada; lo que no cabe se escribe como ceros después
+            if (!f->frames.escribir(input_items.data() + f->canal0, n)) {
+                descartado = true;
+            }
+
+            const size_t ocupados = f->frames.ocupados();
+            if (ocupados > d_ocupacion_maxima.load(std::memory_order_relaxed)) {
+                d_ocupacion_maxima.store(ocupados, std::memory_order_relaxed);
+            }
+        }
+        // Una vez por muestra aunque falte en varios archivos por canal
+        if (descartado) {
+            d_descartados.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        d_recibidas += n;
+        if (d_totales > 0 && d_recibidas >= d_totales) {
+            return WORK_DONE;
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr size_t LOTE = spsc_frames::LOTE; // frames por lectura del buffer
+
+    // Buffer, hilo y archivo actual de un archivo de salida
+    struct flujo {
+        flujo(int c0, int nc, size_t capacidad) : canal0(c0), canales(nc), frames(nc, capacidad) {}
+
+        const int canal0;  // primer canal de entrada
+        const int canales; // canales en el archivo
+        std::string sufijo;
+        spsc_frames frames;
+        std::thread hilo;
+
+        // Lado del codificador
+        std::unique_ptr<flac_codificador> archivo;
+        std::string nombre;
+        unsigned segmento = 0;
+        uint64_t muestra_segmento = 0; // índice de la primera muestra del archivo
+        uint64_t frames_segmento = 0;  // muestras por canal escritas en el archivo
+    };
+
+    void codificador(flujo* f) {
+        std::vector<float> lote(LOTE * f->canales);
+        const std::vector<float> ceros(LOTE * f->canales, 0.0f);
+
+        try {
+            bool ultimo_pase = false;
+            while (!ultimo_pase && !d_fallo.load(std::memory_order_relaxed)) {
+                // Se lee la bandera antes de vaciar para no perder el último lote
+                ultimo_pase = !d_corriendo.load(std::memory_order_acquire);
+                size_t n;
+                uint64_t hueco;
+                while ((n = f->frames.leer(lote.data(), LOTE, hueco)) > 0 || hueco > 0) {
+                    agregar(f, lote.data(), n);
+                    for (; hueco > 0; hueco -= std::min<uint64_t>(hueco, LOTE)) {
+                        agregar(f, ceros.data(), std::min<uint64_t>(hueco, LOTE));
+                    }
+                }
+                if (!ultimo_pase) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            }
+            cerrar_archivo(f);
+        } catch (const std::exception& e) {
+            // Sin excepciones fuera del hilo (std::terminate): work() reporta
+            f->archivo.reset();
+            std::lock_guard<std::mutex> lock(d_mutex_indice);
+            if (!d_fallo.load(std::memory_order_relaxed)) {
+                d_error = e.what();
+                d_fallo.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    void agregar(flujo* f, const float* x, size_t frames) {
+        while (frames > 0) {
+            if (!f->archivo) {
+                abrir_archivo(f);
+            }
+            size_t k = frames;
+            if (d_por_segmento > 0) {
+                k = std::min<uint64_t>(k, d_por_segmento - f->frames_segmento);
+            }
+            f->archivo->escribir(x, k);
+            f->frames_segmento += k;
+            x += k * f->canales;
+            frames -= k;
+            if (d_por_segmento > 0 && f->frames_segmento == d_por_segmento) {
+                cerrar_archivo(f);
+            }
+        }
+    }
+
+    void abrir_archivo(flujo* f) {
+        f->nombre = d_prefijo + f->sufijo;
+        if (d_por_segmento > 0) {
+            char numero[16];
+            std::snprintf(numero, sizeof(numero), "_%06u", f->segmento);
+            f->nombre += numero;
+        }
+        f->nombre += ".flac";
+
+        const int64_t ns = inicio_ns(f->muestra_segmento);
+        const std::time_t segundos = ns / 1000000000;
+        std::tm utc;
+        gmtime_r(&segundos, &utc);
+        char fecha[32];
+        std::strftime(fecha, sizeof(fecha), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        char comentario[128];
+        std::snprintf(comentario, sizeof(comentario),
+                      "muestra_inicial=%llu fs=%g canal_inicial=%d canales=%d segmento=%u",
+                      (unsigned long long)f->muestra_segmento, d_samp_rate, f->canal0,
+                      f->canales, f->segmento);
+
+        f->archivo.reset(new flac_codificador(f->nombre, f->canales, d_samp_rate, d_bits,
+                                              comentario, fecha));
+        f->frames_segmento = 0;
+    }
+
+    void cerrar_archivo(flujo* f) {
+        if (!f->archivo) {
+            return;
+        }
+        f->archivo.reset();
+        {
+            std::lock_guard<std::mutex> lock(d_mutex_indice);
+            std::fprintf(d_indice, "%s,%d,%d,%llu,%llu,%lld\n", f->nombre.c_str(), f->canal0,
+                         f->canales, (unsigned long long)f->muestra_segmento,
+                         (unsigned long long)f->frames_segmento,
+                         (long long)inicio_ns(f->muestra_segmento));
+            std::fflush(d_indice);
+        }
+        f->muestra_segmento += f->frames_segmento;
+        f->segmento++;
+        d_archivos++;
+    }
+
+    int64_t inicio_ns(uint64_t muestra) const {
+        return d_inicio_ns + static_cast<int64_t>(std::llround(muestra * 1e9 / d_samp_rate));
+    }
+
+    void detener_codificadores() {
+        d_corriendo = false;
+        for (auto& f : d_flujos) {
+            if (f->hilo.joinable()) {
+                f->hilo.join();
+            }
+        }
+        if (d_indice) {
+            std::fclose(d_indice);
+            d_indice = nullptr;
+        }
+    }
+
+    const std::string d_prefijo;
+    const double d_samp_rate;
+    const int d_bits;
+    const uint64_t d_por_segmento;
+    const uint64_t d_totales;
+
+    std::vector<std::unique_ptr<flujo>> d_flujos;
+    uint64_t d_recibidas = 0; // muestras por canal aceptadas por work()
+    std::atomic<uint64_t> d_descartados{ 0 };
+    std::atomic<size_t> d_ocupacion_maxima{ 0 };
+
+    std::atomic<bool> d_corriendo{ false };
+    std::atomic<bool> d_fallo{ false };
+    std::string d_error; // el primero; se escribe antes de d_fallo
+    std::atomic<unsigned> d_archivos{ 0 };
+    int64_t d_inicio_ns = 0;
+    std::FILE* d_indice = nullptr;
+    std::mutex d_mutex_indice;
+};
+
+#endif // BLOQUES_FLAC_SINK_H
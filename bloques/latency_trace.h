@@ -0,0 +1,286 @@
+// latency_trace.h
+// Medición de latencia de punta a punta con etiquetas (stream tags).
+//
+// latency_tagger se coloca justo después de la fuente en vivo y copia las
+// muestras sin cambios. Cada 'cada' muestras les pone la etiqueta "t_mono" con
+// la tupla (id, t_ns): id es el número de etiqueta y t_ns es la hora
+// estimada de llegada de esa muestra en el reloj monotónico. La hora se
+// estima como el momento de work() menos lo que tardaron en llegar las
+// muestras posteriores del mismo lote, a la tasa fs. La primera muestra lleva
+// también "rx_time" (segundos enteros y fracción del reloj de pared, como
+// lo hacen las fuentes UHD).
+//
+// La propagación de etiquetas por omisión de GNU Radio (TPP_ALL_TO_ALL,
+// con el offset escalado por la decimación) las lleva por filtros,
+// multiplicadores y decimadores. latency_probe es un sumidero que se conecta
+// en paralelo a la salida de una etapa y anota, por id, cuánto tiempo pasó
+// desde la captura hasta que la muestra salió de esa etapa. Si una etiqueta
+// llega duplicada (por ejemplo, multiply_cc con la misma señal en sus dos
+// entradas) solo cuenta la primera vez.
+//
+// registro_latencia crea el tagger y las sondas (en el orden de las etapas)
+// y al terminar escribe p50/p99/máx e histogramas, acumulados desde la
+// captura y por etapa (diferencia con la sonda anterior para el mismo id).
+// Cada sonda guarda 8 bytes por etiqueta: con una etiqueta cada 0.1 s son
+// unos 7 MB por etapa por día.
+
+#ifndef BLOQUES_LATENCY_TRACE_H
+#define BLOQUES_LATENCY_TRACE_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <pmt/pmt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+inline int64_t reloj_monotonico_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+class latency_tagger : public gr::sync_block {
+public:
+    typedef std::shared_ptr<latency_tagger> sptr;
+
+    // item_size: tamaño de la muestra de la fuente (se copia sin cambios)
+    // fs: tasa de la fuente; cada: muestras entre etiquetas
+    static sptr make(size_t item_size, double fs, uint64_t cada) {
+        return gnuradio::get_initial_sptr(new latency_tagger(item_size, fs, cada));
+    }
+
+    latency_tagger(size_t item_size, double fs, uint64_t cada)
+        : gr::sync_block("latency_tagger",
+                         gr::io_signature::make(1, 1, item_size),
+                         gr::io_signature::make(1, 1, item_size)),
+          d_item_size(item_size),
+          d_ns_por_muestra(1e9 / fs),
+          d_cada(cada),
+          d_clave(pmt::intern("t_mono")),
+          d_srcid(pmt::intern(alias())) {
+        if (fs <= 0 || cada == 0) {
+            throw std::invalid_argument("latency_tagger: fs y cada deben ser positivos");
+        }
+    }
+
+    uint64_t etiquetas() const { return d_siguiente / d_cada; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        std::memcpy(output_items[0], input_items[0], noutput_items * d_item_size);
+
+        const int64_t ahora = reloj_monotonico_ns();
+        const uint64_t n0 = nitems_written(0);
+        const uint64_t fin = n0 + noutput_items;
+
+        if (n0 == 0 && noutput_items > 0) {
+            const double pared = std::chrono::duration<double>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count() -
+                                 (noutput_items - 1) * d_ns_por_muestra * 1e-9;
+            const double segundos = std::floor(pared);
+            add_item_tag(0, 0, pmt::intern("rx_time"),
+                         pmt::make_tuple(pmt::from_uint64(static_cast<uint64_t>(segundos)),
+                                         pmt::from_double(pared - segundos)),
+                         d_srcid);
+        }
+
+        // La última muestra del lote llegó "ahora"; las anteriores, antes
+        for (; d_siguiente < fin; d_siguiente += d_cada) {
+            const int64_t t = ahora - static_cast<int64_t>((fin - 1 - d_siguiente) * d_ns_por_muestra);
+            add_item_tag(0, d_siguiente, d_clave,
+                         pmt::make_tuple(pmt::from_uint64(d_siguiente / d_cada),
+                                         pmt::from_uint64(static_cast<uint64_t>(t))),
+                         d_srcid);
+        }
+        return noutput_items;
+    }
+
+private:
+    const size_t d_item_size;
+    const double d_ns_por_muestra;
+    const uint64_t d_cada;
+    const pmt::pmt_t d_clave;
+    const pmt::pmt_t d_srcid;
+    uint64_t d_siguiente = 0; // offset de la próxima etiqueta
+};
+
+class latency_probe : public gr::sync_block {
+public:
+    typedef std::shared_ptr<latency_probe> sptr;
+
+    static constexpr int64_t SIN_DATO = -1;
+
+    static sptr make(const std::string& etapa, size_t item_size) {
+        return gnuradio::get_initial_sptr(new latency_probe(etapa, item_size));
+    }
+
+    latency_probe(const std::string& etapa, size_t item_size)
+        : gr::sync_block("latency_probe",
+                         gr::io_signature::make(1, 1, item_size),
+                         gr::io_signature::make(0, 0, 0)),
+          d_etapa(etapa),
+          d_clave(pmt::intern("t_mono")) {}
+
+    const std::string& etapa() const { return d_etapa; }
+
+    // Latencia desde la captura (ns) por id de etiqueta; SIN_DATO si no llegó
+    const std::vector<int64_t>& latencias() const { return d_latencia; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star&,
+             gr_vector_void_star&) override {
+        const uint64_t n0 = nitems_read(0);
+        get_tags_in_range(d_tags, 0, n0, n0 + noutput_items, d_clave);
+        if (!d_tags.empty()) {
+            const int64_t ahora = reloj_monotonico_ns();
+            for (const gr::tag_t& tag : d_tags) {
+                const uint64_t id = pmt::to_uint64(pmt::tuple_ref(tag.value, 0));
+                const int64_t t = static_cast<int64_t>(pmt::to_uint64(pmt::tuple_ref(tag.value, 1)));
+                if (id >= d_latencia.size()) {
+                    d_latencia.resize(std::max<size_t>(id + 1, 2 * d_latencia.size()), SIN_DATO);
+                }
+                if (d_latencia[id] == SIN_DATO) {
+                    d_latencia[id] = std::max<int64_t>(0, ahora - t);
+                }
+            }
+        }
+        return noutput_items;
+    }
+
+private:
+    const std::string d_etapa;
+    const pmt::pmt_t d_clave;
+    std::vector<gr::tag_t> d_tags; // reutilizado entre llamadas a work()
+    std::vector<int64_t> d_latencia;
+};
+
+// Crea el tagger y las sondas de una cadena y resume sus mediciones
+class registro_latencia {
+public:
+    registro_latencia(double fs, uint64_t cada) : d_fs(fs), d_cada(cada) {}
+
+    latency_tagger::sptr tagger(size_t item_size) {
+        d_tagger = latency_tagger::make(item_size, d_fs, d_cada);
+        return d_tagger;
+    }
+
+    // Las sondas deben crearse en el orden de las etapas de la cadena
+    latency_probe::sptr sonda(const std::string& etapa, size_t item_size) {
+        d_sondas.push_back(latency_probe::make(etapa, item_size));
+        return d_sondas.back();
+    }
+
+    // Tagger y sondas creados, por ejemplo para opciones_scheduler::aplicar
+    std::vector<gr::basic_block_sptr> bloques() const {
+        std::vector<gr::basic_block_sptr> r;
+        if (d_tagger) {
+            r.push_back(d_tagger);
+        }
+        r.insert(r.end(), d_sondas.begin(), d_sondas.end());
+        return r;
+    }
+
+    // Escribe el reporte en 'archivo' y el resumen en stdout. Llamar después
+    // de tb->wait(), cuando los hilos del scheduler ya terminaron.
+    void escribir(const std::string& archivo) const {
+        FILE* f = std::fopen(archivo.c_str(), "w");
+        if (!f) {
+            throw std::runtime_error("registro_latencia: no se pudo abrir " + archivo);
+        }
+        std::fprintf(f, "# Latencia en ms; una etiqueta cada %llu muestras (%.3f s)\n",
+                     (unsigned long long)d_cada, d_cada / d_fs);
+        if (!d_sondas.empty()) {
+            std::fprintf(f, "# Punta a punta: %s desde captura\n", d_sondas.back()->etapa().c_str());
+        }
+
+        std::vector<serie> series;
+        for (size_t k = 0; k < d_sondas.size(); k++) {
+            const auto& lat = d_sondas[k]->latencias();
+            // Acumulada desde la captura
+            serie acumulada{ d_sondas[k]->etapa(), "captura", {} };
+            for (int64_t v : lat) {
+                if (v != latency_probe::SIN_DATO) {
+                    acumulada.ms.push_back(v * 1e-6);
+                }
+            }
+            series.push_back(std::move(acumulada));
+            // Propia de la etapa: contra la sonda anterior, mismo id
+            if (k > 0) {
+                const auto& previa = d_sondas[k - 1]->latencias();
+                serie propia{ d_sondas[k]->etapa(), d_sondas[k - 1]->etapa(), {} };
+                for (size_t id = 0; id < std::min(lat.size(), previa.size()); id++) {
+                    if (lat[id] != latency_probe::SIN_DATO && previa[id] != latency_probe::SIN_DATO) {
+                        propia.ms.push_back((lat[id] - previa[id]) * 1e-6);
+                    }
+                }
+                series.push_back(std::move(propia));
+            }
+        }
+        for (auto& s : series) {
+            std::sort(s.ms.begin(), s.ms.end());
+        }
+
+        std::fprintf(f, "etapa,desde,etiquetas,p50_ms,p99_ms,max_ms\n");
+        std::printf("%-20s %-20s %9s %10s %10s %10s\n", "etapa", "desde", "etiquetas", "p50 ms",
+                    "p99 ms", "máx ms");
+        for (const auto& s : series) {
+            std::fprintf(f, "%s,%s,%zu,%.3f,%.3f,%.3f\n", s.etapa.c_str(), s.desde.c_str(),
+                         s.ms.size(), percentil(s.ms, 0.50), percentil(s.ms, 0.99),
+                         s.ms.empty() ? 0.0 : s.ms.back());
+            std::printf("%-20s %-20s %9zu %10.3f %10.3f %10.3f\n", s.etapa.c_str(), s.desde.c_str(),
+                        s.ms.size(), percentil(s.ms, 0.50), percentil(s.ms, 0.99),
+                        s.ms.empty() ? 0.0 : s.ms.back());
+        }
+
+        // Histogramas con cubetas 1-2-5 (límite superior en ms)
+        std::fprintf(f, "\netapa,desde,hasta_ms,etiquetas\n");
+        for (const auto& s : series) {
+            size_t i = 0;
+            for (double decada = 0.01; i < s.ms.size(); decada *= 10) {
+                for (double m : { 1.0, 2.0, 5.0 }) {
+                    const double limite = m * decada;
+                    size_t c = 0;
+                    for (; i < s.ms.size() && s.ms[i] <= limite; i++) {
+                        c++;
+                    }
+                    if (c > 0) {
+                        std::fprintf(f, "%s,%s,%g,%zu\n", s.etapa.c_str(), s.desde.c_str(), limite, c);
+                    }
+                }
+            }
+        }
+        std::fclose(f);
+    }
+
+private:
+    struct serie {
+        std::string etapa;
+        std::string desde;
+        std::vector<double> ms; // ordenadas
+    };
+
+    static double percentil(const std::vector<double>& v, double p) {
+        if (v.empty()) {
+            return 0.0;
+        }
+        return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+    }
+
+    const double d_fs;
+    const uint64_t d_cada;
+    latency_tagger::sptr d_tagger;
+    std::vector<latency_probe::sptr> d_sondas;
+};
+
+#endif // BLOQUES_LATENCY_TRACE_H
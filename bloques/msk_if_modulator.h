@@ -0,0 +1,141 @@
+// msk_if_modulator.h
+// Modulador MSK/CPFSK que entrega directamente la señal real en FI.
+//
+// Reemplaza la cadena uchar_to_float + add_const_ff + multiply_const_ff +
+// float_to_char + cpmmod_bc(LREC, h, sps, L=1) + sig_source_c + multiply_cc +
+// complex_to_float (parte real) de msktools:
+//
+//     y[m] = cos(fase_msk[m] + w_c m)
+//     fase_msk[m] = (pi h / sps) * sum_{i <= m} a[i / sps],   a = 2*bit - 1
+//
+// La fase se acumula en punto fijo de 32 bits (2^32 = 2*pi), así que el
+// desborde del entero es la reducción módulo 2*pi y la fase no se degrada en
+// archivos largos. Por cada símbolo se suma una tabla precalculada de sps
+// incrementos (portadora + rampa de +/-pi h), una por valor del bit, y el
+// coseno se evalúa por lotes con VOLK (volk_32f_cos_32f, con SIMD).
+//
+// Las tablas dependen solo de (sps, fs, fc, h): msk_if_modulator::disenar las
+// calcula una vez y varios moduladores pueden compartirlas (por ejemplo los
+// trabajos de msk_wav_generator --lote).
+//
+// Entrada: bytes con un bit por byte (bit en el LSB, como random_uniform_source_b
+// con (0, 2)) o empaquetados 8 bits por byte (MSB primero).
+
+#ifndef BLOQUES_MSK_IF_MODULATOR_H
+#define BLOQUES_MSK_IF_MODULATOR_H
+
+#include <gnuradio/fxpt.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_interpolator.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+class msk_if_modulator : public gr::sync_interpolator {
+public:
+    typedef std::shared_ptr<msk_if_modulator> sptr;
+
+    // Tablas de fase de una configuración, de solo lectura una vez calculadas
+    struct tablas {
+        int sps;
+        uint32_t inc_portadora;
+        std::vector<uint32_t> fase[2]; // fase relativa al inicio del símbolo, por bit
+        uint32_t avance[2];            // avance de fase en un símbolo completo, por bit
+    };
+
+    static std::shared_ptr<const tablas> disenar(int samples_per_sym, double samp_rate, double fc, double h = 0.5) {
+        if (samples_per_sym < 1) {
+            throw std::invalid_argument("msk_if_modulator: samples_per_sym debe ser >= 1");
+        }
+        auto t = std::make_shared<tablas>();
+        t->sps = samples_per_sym;
+        // Mismo incremento cuantizado que el NCO de sig_source_c
+        t->inc_portadora = gr::fxpt::float_to_fixed(2.0 * M_PI * fc / samp_rate);
+
+        // Rampa de fase dentro del símbolo: (k+1) * pi h / sps, para k = 0..sps-1.
+        // Se redondea cada punto (no se acumula) para que el cambio por símbolo
+        // sea exactamente +/-pi h y no haya deriva entre símbolos.
+        const double escala = 4294967296.0 * h / 2.0; // pi h en punto fijo
+        for (int b = 0; b < 2; b++) {
+            t->fase[b].resize(samples_per_sym);
+            for (int k = 0; k < samples_per_sym; k++) {
+                const int64_t rampa = std::llround(escala * (k + 1) / samples_per_sym);
+                const uint32_t msk = static_cast<uint32_t>(b ? rampa : -rampa);
+                t->fase[b][k] = msk + uint32_t(k) * t->inc_portadora;
+            }
+            t->avance[b] = t->fase[b][samples_per_sym - 1] + t->inc_portadora;
+        }
+        return t;
+    }
+
+    // samples_per_sym: muestras por bit; samp_rate, fc: tasa de salida y portadora (Hz)
+    // empaquetado: 8 bits por byte de entrada; h: índice de modulación (0.5 = MSK)
+    static sptr make(int samples_per_sym,
+                     double samp_rate,
+                     double fc,
+                     bool empaquetado = false,
+                     double h = 0.5) {
+        return make(disenar(samples_per_sym, samp_rate, fc, h), empaquetado);
+    }
+
+    // Con tablas ya calculadas (compartidas con otros moduladores)
+    static sptr make(std::shared_ptr<const tablas> t, bool empaquetado = false) {
+        return gnuradio::get_initial_sptr(new msk_if_modulator(t, empaquetado));
+    }
+
+    msk_if_modulator(std::shared_ptr<const tablas> t, bool empaquetado)
+        : gr::sync_interpolator("msk_if_modulator",
+                                gr::io_signature::make(1, 1, sizeof(uint8_t)),
+                                gr::io_signature::make(1, 1, sizeof(float)),
+                                t->sps * (empaquetado ? 8 : 1)),
+          d_sps(t->sps),
+          d_empaquetado(empaquetado),
+          d_tablas(t) {
+        set_output_multiple(d_sps * (empaquetado ? 8 : 1));
+    }
+
+    int samples_per_sym() const { return d_sps; }
+    bool empaquetado() const { return d_empaquetado; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        const uint8_t* in = (const uint8_t*)input_items[0];
+        float* out = (float*)output_items[0];
+
+        if (d_fase.size() < static_cast<size_t>(noutput_items)) {
+            d_fase.resize(noutput_items);
+        }
+
+        // Fase de cada muestra a partir de las tablas, convertida a [-pi, pi)
+        const float a_radianes = M_PI / 2147483648.0;
+        float* fase = d_fase.data();
+        const int nbits = noutput_items / d_sps;
+        for (int i = 0; i < nbits; i++) {
+            const int bit = d_empaquetado ? (in[i >> 3] >> (7 - (i & 7))) & 1 : in[i] & 1;
+            const uint32_t* tabla = d_tablas->fase[bit].data();
+            for (int k = 0; k < d_sps; k++) {
+                fase[k] = static_cast<int32_t>(d_acumulador + tabla[k]) * a_radianes;
+            }
+            d_acumulador += d_tablas->avance[bit];
+            fase += d_sps;
+        }
+
+        volk_32f_cos_32f(out, d_fase.data(), noutput_items);
+        return noutput_items;
+    }
+
+private:
+    const int d_sps;
+    const bool d_empaquetado;
+    const std::shared_ptr<const tablas> d_tablas;
+    uint32_t d_acumulador = 0;        // fase al inicio del símbolo actual
+    volk::vector<float> d_fase;
+};
+
+#endif // BLOQUES_MSK_IF_MODULATOR_H
@@ -0,0 +1,227 @@
+// multitone_source.h
+// Fuente de suma de senoidales (más ruido gaussiano opcional) en un solo
+// bloque:
+//
+//     y[n] = sum_k a_k sin(2 pi f_k n / fs + phi_k) + ruido * g[n]
+//
+// Reemplaza los árboles de sig_source_f + add_ff de Filtros/: con N tonos
+// son 2N-1 bloques, 2N-2 buffers intermedios y otros tantos hilos del
+// scheduler, contra un bloque y un buffer aquí.
+//
+// Cada tono usa un oscilador por recurrencia vectorizado en el tiempo: 8
+// muestras consecutivas por registro, que avanzan juntas multiplicando por
+// e^{j 8 w}. Los osciladores se resiembran cada TRAMO muestras a partir de la
+// fase exacta (punto fijo de 64 bits sobre el índice absoluto de la muestra),
+// así que no se degradan y la salida no depende de cómo el scheduler parta
+// los buffers. El bloque de TRAMO muestras se queda en caché mientras se le
+// suman todos los tonos. Con AVX2/FMA se usan registros de 8 floats y se
+// avanzan 4 tonos por pasada; sin AVX2 se usa el mismo algoritmo en C++
+// escalar.
+//
+// Salida: float a la tasa fs.
+
+#ifndef BLOQUES_MULTITONE_SOURCE_H
+#define BLOQUES_MULTITONE_SOURCE_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/random.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define MULTITONE_X86 1
+#endif
+
+class multitone_source : public gr::sync_block {
+public:
+    typedef std::shared_ptr<multitone_source> sptr;
+
+    // Un término a sin(2 pi f t + fase), como sig_source_f(GR_SIN_WAVE)
+    struct tono {
+        double frecuencia; // Hz
+        double amplitud;
+        double fase;       // rad
+    };
+
+    // ruido: desviación estándar del ruido gaussiano sumado (0: sin ruido)
+    // semilla: semilla del generador de ruido (como noise_source_f)
+    static sptr make(double samp_rate,
+                     const std::vector<tono>& tonos,
+                     double ruido = 0.0,
+                     long semilla = 0) {
+        return gnuradio::get_initial_sptr(new multitone_source(samp_rate, tonos, ruido, semilla));
+    }
+
+    multitone_source(double samp_rate, const std::vector<tono>& tonos, double ruido, long semilla)
+        : gr::sync_block("multitone_source",
+                         gr::io_signature::make(0, 0, 0),
+                         gr::io_signature::make(1, 1, sizeof(float))),
+          d_ruido(static_cast<float>(ruido)),
+          d_rng(semilla) {
+        if (samp_rate <= 0 || ruido < 0) {
+            throw std::invalid_argument("multitone_source: samp_rate debe ser positiva y ruido >= 0");
+        }
+        for (const tono& t : tonos) {
+            osc o;
+            // f/fs y fase/(2 pi) en fracciones de ciclo * 2^64
+            const double ciclos = t.frecuencia / samp_rate;
+            const double fase = t.fase / (2.0 * M_PI);
+            o.incr = static_cast<uint64_t>(
+                static_cast<int64_t>(std::ldexp(ciclos - std::round(ciclos), 63))) << 1;
+            o.fase0 = static_cast<uint64_t>(
+                static_cast<int64_t>(std::ldexp(fase - std::round(fase), 63))) << 1;
+            o.amplitud = static_cast<float>(t.amplitud);
+            const double w = 2.0 * M_PI * t.frecuencia / samp_rate;
+            o.paso_re = static_cast<float>(std::cos(CARRILES * w));
+            o.paso_im = static_cast<float>(std::sin(CARRILES * w));
+            for (int i = 0; i < CARRILES; i++) {
+                o.carril[i] = std::polar(1.0, i * w);
+            }
+            d_osc.push_back(o);
+        }
+        d_re.resize(d_osc.size() * CARRILES);
+        d_im.resize(d_osc.size() * CARRILES);
+
+#ifdef MULTITONE_X86
+        d_usar_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    size_t num_tonos() const { return d_osc.size(); }
+    bool usa_avx2() const { return d_usar_avx2; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star&,
+             gr_vector_void_star& output_items) override {
+        float* out = (float*)output_items[0];
+
+        for (int inicio = 0; inicio < noutput_items; inicio += TRAMO) {
+            const int n = std::min(TRAMO, noutput_items - inicio);
+            float* y = out + inicio;
+
+            if (d_ruido > 0.0f) {
+                for (int i = 0; i < n; i++) {
+                    y[i] = d_ruido * d_rng.gasdev();
+                }
+            } else {
+                std::fill(y, y + n, 0.0f);
+            }
+
+            // e^{j theta} exacto en la primera muestra del tramo, y de ahí
+            // las 8 muestras consecutivas de los carriles de cada tono
+            for (size_t k = 0; k < d_osc.size(); k++) {
+                const osc& o = d_osc[k];
+                const uint64_t fase = o.fase0 + d_muestra * o.incr;
+                const double radianes = static_cast<int64_t>(fase) * (M_PI / 9223372036854775808.0);
+                const std::complex<double> base = std::polar(1.0, radianes);
+                for (int i = 0; i < CARRILES; i++) {
+                    const std::complex<double> c = base * o.carril[i];
+                    d_re[k * CARRILES + i] = static_cast<float>(c.real());
+                    d_im[k * CARRILES + i] = static_cast<float>(c.imag());
+                }
+            }
+#ifdef MULTITONE_X86
+            if (d_usar_avx2) {
+                tramo_avx2(y, n);
+            } else
+#endif
+            {
+                tramo_generico(y, n);
+            }
+            d_muestra += n;
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr int CARRILES = 8;  // muestras consecutivas por registro
+    static constexpr int TRAMO = 1024;  // muestras entre resiembras del oscilador
+    static constexpr int GRUPO = 4;     // tonos por pasada en AVX2
+
+    struct osc {
+        uint64_t incr;  // avance de fase por muestra (2^64 = un ciclo)
+        uint64_t fase0; // fase en la muestra 0
+        float amplitud;
+        float paso_re, paso_im;                 // e^{j 8 w}
+        std::complex<double> carril[CARRILES]; // e^{j w i}, i = 0..7
+    };
+
+    // y[m] += a * Im(osc[m]);  osc[m+8] = osc[m] * e^{j 8 w}
+    void tramo_generico(float* y, int n) {
+        for (size_t k = 0; k < d_osc.size(); k++) {
+            const osc& o = d_osc[k];
+            float* re = &d_re[k * CARRILES];
+            float* im = &d_im[k * CARRILES];
+            for (int m = 0; m < n; m += CARRILES) {
+                const int c = std::min(CARRILES, n - m);
+                for (int i = 0; i < c; i++) {
+                    y[m + i] += o.amplitud * im[i];
+                }
+                for (int i = 0; i < CARRILES; i++) {
+                    const float t = re[i] * o.paso_re - im[i] * o.paso_im;
+                    im[i] = re[i] * o.paso_im + im[i] * o.paso_re;
+                    re[i] = t;
+                }
+            }
+        }
+    }
+
+#ifdef MULTITONE_X86
+    // Tonos de GRUPO en GRUPO en cada pasada sobre y, para que las cadenas de
+    // la recurrencia (independientes entre tonos) se traslapen en el CPU
+    __attribute__((target("avx2,fma"))) void tramo_avx2(float* y, int n) {
+        const size_t ntonos = d_osc.size();
+        for (size_t k0 = 0; k0 < ntonos; k0 += GRUPO) {
+            const int g = static_cast<int>(std::min<size_t>(GRUPO, ntonos - k0));
+            __m256 a[GRUPO], pre[GRUPO], pim[GRUPO], re[GRUPO], im[GRUPO];
+            for (int j = 0; j < GRUPO; j++) {
+                // Los tonos que faltan para completar el grupo tienen amplitud 0
+                const osc& o = d_osc[k0 + std::min(j, g - 1)];
+                a[j] = _mm256_set1_ps(j < g ? o.amplitud : 0.0f);
+                pre[j] = _mm256_set1_ps(o.paso_re);
+                pim[j] = _mm256_set1_ps(o.paso_im);
+                re[j] = _mm256_loadu_ps(&d_re[(k0 + std::min(j, g - 1)) * CARRILES]);
+                im[j] = _mm256_loadu_ps(&d_im[(k0 + std::min(j, g - 1)) * CARRILES]);
+            }
+            int m = 0;
+            for (; m + CARRILES <= n; m += CARRILES) {
+                __m256 acc = _mm256_loadu_ps(y + m);
+                for (int j = 0; j < GRUPO; j++) {
+                    acc = _mm256_fmadd_ps(a[j], im[j], acc);
+                    const __m256 t = _mm256_fmsub_ps(re[j], pre[j], _mm256_mul_ps(im[j], pim[j]));
+                    im[j] = _mm256_fmadd_ps(re[j], pim[j], _mm256_mul_ps(im[j], pre[j]));
+                    re[j] = t;
+                }
+                _mm256_storeu_ps(y + m, acc);
+            }
+            if (m < n) {
+                __m256 acc = _mm256_setzero_ps();
+                for (int j = 0; j < GRUPO; j++) {
+                    acc = _mm256_fmadd_ps(a[j], im[j], acc);
+                }
+                alignas(32) float resto[CARRILES];
+                _mm256_store_ps(resto, acc);
+                for (int i = 0; m + i < n; i++) {
+                    y[m + i] += resto[i];
+                }
+            }
+        }
+    }
+#endif
+
+    const float d_ruido;
+    gr::random d_rng;
+    std::vector<osc> d_osc;
+    std::vector<float> d_re, d_im; // estado de los carriles [tono][carril]
+    uint64_t d_muestra = 0; // índice absoluto de la siguiente muestra
+    bool d_usar_avx2 = false;
+};
+
+#endif // BLOQUES_MULTITONE_SOURCE_H
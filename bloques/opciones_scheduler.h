@@ -0,0 +1,228 @@
+// opciones_scheduler.h
+// Opciones de línea de comandos comunes para afinar el scheduler de GNU
+// Radio: tamaño de buffers por bloque, afinidad de CPU, prioridad de tiempo
+// real y número de núcleos de trabajo. Todas empiezan con --gr- para no
+// chocar con las opciones propias de cada programa:
+//
+//   --gr-buffer-max N         máximo de items en cada buffer de salida
+//   --gr-buffer-min N         mínimo de items en cada buffer de salida
+//   --gr-buffer BLOQUE=N      máximo para un bloque (se puede repetir)
+//   --gr-cpus LISTA           CPUs para los hilos de los bloques (ej. 2,3 o 2-5)
+//   --gr-afinidad BLOQUE=LISTA  CPUs para un bloque (se puede repetir)
+//   --gr-hilos K              repartir los bloques entre K CPUs (las primeras
+//                             K de --gr-cpus, o 0..K-1), uno fijo por bloque
+//   --gr-tiempo-real          pedir planificación de tiempo real (SCHED_FIFO)
+//   --gr-prioridad P          prioridad de los hilos de los bloques
+//   --gr-max-items N          máximo de items por llamada a work()
+//
+// BLOQUE es el nombre del bloque (name(), p. ej. sliding_goertzel) o su
+// alias (sliding_goertzel3); ambos aparecen en la configuración impresa.
+//
+// GNU Radio 3.10 solo tiene el scheduler de un hilo por bloque (TPB), así
+// que --gr-hilos no crea un pool: fija cada hilo a una de K CPUs por turnos,
+// que es lo que limita la interferencia con otras cargas del equipo.
+//
+// Uso en un programa, después de las conexiones y antes de start()/run():
+//
+//   auto sched = opciones_scheduler::tomar(argc, argv);
+//   ...
+//   sched.aplicar(tb, { src, filtro, sink });
+
+#ifndef BLOQUES_OPCIONES_SCHEDULER_H
+#define BLOQUES_OPCIONES_SCHEDULER_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/realtime.h>
+#include <gnuradio/top_block.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct opciones_scheduler {
+    long buffer_max = 0; // 0: tamaño por omisión de GNU Radio
+    long buffer_min = 0;
+    std::map<std::string, long> buffer_por_bloque;
+    std::vector<int> cpus;
+    std::map<std::string, std::vector<int>> afinidad_por_bloque;
+    int hilos = 0; // 0: sin repartir
+    bool tiempo_real = false;
+    int prioridad = 0; // 0: no se cambia
+    int max_items = 0; // 0: por omisión
+
+    static constexpr const char* AYUDA =
+        "[--gr-buffer-max N] [--gr-buffer-min N] [--gr-buffer BLOQUE=N] [--gr-cpus LISTA]"
+        " [--gr-afinidad BLOQUE=LISTA] [--gr-hilos K] [--gr-tiempo-real] [--gr-prioridad P]"
+        " [--gr-max-items N]";
+
+    // Toma las opciones --gr-* de argv y las quita (como tomar_opcion)
+    static opciones_scheduler tomar(int& argc, char** argv) {
+        opciones_scheduler o;
+        for (int i = 1; i < argc;) {
+            const std::string op = argv[i];
+            if (op.compare(0, 5, "--gr-") != 0) {
+                i++;
+                continue;
+            }
+            int usados = 1;
+            if (op == "--gr-tiempo-real") {
+                o.tiempo_real = true;
+            } else {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("opciones_scheduler: falta el valor de " + op);
+                }
+                const std::string v = argv[i + 1];
+                usados = 2;
+                if (op == "--gr-buffer-max") {
+                    o.buffer_max = std::stol(v);
+                } else if (op == "--gr-buffer-min") {
+                    o.buffer_min = std::stol(v);
+                } else if (op == "--gr-buffer") {
+                    const auto par = separar(v);
+                    o.buffer_por_bloque[par.first] = std::stol(par.second);
+                } else if (op == "--gr-cpus") {
+                    o.cpus = lista_cpus(v);
+                } else if (op == "--gr-afinidad") {
+                    const auto par = separar(v);
+                    o.afinidad_por_bloque[par.first] = lista_cpus(par.second);
+                } else if (op == "--gr-hilos") {
+                    o.hilos = std::stoi(v);
+                } else if (op == "--gr-prioridad") {
+                    o.prioridad = std::stoi(v);
+                } else if (op == "--gr-max-items") {
+                    o.max_items = std::stoi(v);
+                } else {
+                    throw std::invalid_argument("opciones_scheduler: opción desconocida " + op);
+                }
+            }
+            for (int j = i; j < argc - usados; j++) {
+                argv[j] = argv[j + usados];
+            }
+            argc -= usados;
+        }
+        return o;
+    }
+
+    // Aplica la configuración a los bloques del flujo e imprime el resultado.
+    // Llamar después de las conexiones y antes de tb->start() o tb->run():
+    // la prioridad de tiempo real la heredan los hilos que crea start().
+    void aplicar(gr::top_block_sptr tb, const std::vector<gr::basic_block_sptr>& bloques) const {
+        std::string estado_rt = "no";
+        if (tiempo_real) {
+            switch (gr::enable_realtime_scheduling()) {
+            case gr::RT_OK: estado_rt = "sí"; break;
+            case gr::RT_NO_PRIVS: estado_rt = "sin permisos (ver /etc/security/limits.conf)"; break;
+            case gr::RT_NOT_IMPLEMENTED: estado_rt = "no disponible"; break;
+            default: estado_rt = "error"; break;
+            }
+        }
+        if (max_items > 0) {
+            tb->set_max_noutput_items(max_items);
+        }
+
+        // CPUs para repartir con --gr-hilos
+        std::vector<int> nucleos = cpus;
+        if (hilos > 0) {
+            if (nucleos.empty()) {
+                for (int c = 0; c < hilos; c++) {
+                    nucleos.push_back(c);
+                }
+            } else if (static_cast<int>(nucleos.size()) > hilos) {
+                nucleos.resize(hilos);
+            }
+        }
+
+        std::printf("Scheduler: un hilo por bloque%s, tiempo real: %s, max items por work: %s\n",
+                    hilos > 0 ? (", repartidos en " + texto_cpus(nucleos)).c_str()
+                    : cpus.empty() ? ""
+                                   : (" en CPUs " + texto_cpus(cpus)).c_str(),
+                    estado_rt.c_str(),
+                    max_items > 0 ? std::to_string(max_items).c_str() : "auto");
+        std::printf("  %-32s %10s %10s %10s %9s\n", "bloque", "buffer max", "buffer min", "CPUs",
+                    "prioridad");
+
+        size_t turno = 0;
+        for (const auto& b : bloques) {
+            auto blk = std::dynamic_pointer_cast<gr::block>(b);
+            if (!blk) {
+                continue;
+            }
+            const long bmax = buscar(buffer_por_bloque, *blk, buffer_max);
+            if (bmax > 0) {
+                blk->set_max_output_buffer(bmax);
+            }
+            if (buffer_min > 0) {
+                blk->set_min_output_buffer(buffer_min);
+            }
+
+            std::vector<int> afin = buscar(afinidad_por_bloque, *blk, std::vector<int>());
+            if (afin.empty() && !nucleos.empty()) {
+                afin = hilos > 0 ? std::vector<int>{ nucleos[turno++ % nucleos.size()] } : nucleos;
+            }
+            if (!afin.empty()) {
+                blk->set_processor_affinity(afin);
+            }
+            if (prioridad != 0) {
+                blk->set_thread_priority(prioridad);
+            }
+
+            std::printf("  %-32s %10s %10s %10s %9s\n", blk->alias().c_str(),
+                        bmax > 0 ? std::to_string(bmax).c_str() : "auto",
+                        buffer_min > 0 ? std::to_string(buffer_min).c_str() : "auto",
+                        afin.empty() ? "todas" : texto_cpus(afin).c_str(),
+                        prioridad != 0 ? std::to_string(prioridad).c_str() : "-");
+        }
+    }
+
+private:
+    // "nombre=valor"
+    static std::pair<std::string, std::string> separar(const std::string& s) {
+        const size_t igual = s.find('=');
+        if (igual == std::string::npos || igual == 0) {
+            throw std::invalid_argument("opciones_scheduler: se esperaba BLOQUE=valor: " + s);
+        }
+        return { s.substr(0, igual), s.substr(igual + 1) };
+    }
+
+    // "0,2-4" -> {0, 2, 3, 4}
+    static std::vector<int> lista_cpus(const std::string& s) {
+        std::vector<int> r;
+        std::stringstream ss(s);
+        std::string parte;
+        while (std::getline(ss, parte, ',')) {
+            const size_t guion = parte.find('-');
+            const int a = std::stoi(parte.substr(0, guion));
+            const int b = guion == std::string::npos ? a : std::stoi(parte.substr(guion + 1));
+            for (int c = a; c <= b; c++) {
+                r.push_back(c);
+            }
+        }
+        return r;
+    }
+
+    static std::string texto_cpus(const std::vector<int>& v) {
+        std::string s;
+        for (size_t i = 0; i < v.size(); i++) {
+            s += (i ? "," : "") + std::to_string(v[i]);
+        }
+        return s;
+    }
+
+    // Valor por alias o por nombre del bloque, o el general
+    template <typename T>
+    static T buscar(const std::map<std::string, T>& m, const gr::block& b, const T& general) {
+        auto it = m.find(b.alias());
+        if (it == m.end()) {
+            it = m.find(b.name());
+        }
+        return it != m.end() ? it->second : general;
+    }
+};
+
+#endif // BLOQUES_OPCIONES_SCHEDULER_H
@@ -0,0 +1,267 @@
+// pfb_frontend.h
+// Canalizador de banco de filtros polifásico (PFB) para señales reales:
+// convierte a banda base varias portadoras (estaciones) a la vez, con una
+// sola FFT por muestra de salida para todas ellas.
+//
+// El espectro de 0 a fs/2 se parte en M canales de ancho fs/M centrados en
+// k*fs/M. Con un pasa-bajas prototipo h de L = M*P coeficientes, la salida
+// del canal k en la muestra t es
+//
+//     X_k[t] = sum_m h[m] x[t-m] e^{-j2 pi k (t-m)/M}
+//            = e^{-j2 pi k t/M} * sum_{r<M} u_r[t] e^{j2 pi k r/M},
+//     u_r[t] = sum_{p<P} h[r+pM] x[t-r-pM],
+//
+// es decir, L multiplicaciones para las M sumas polifásicas u_r y una FFT
+// real de M puntos para todos los canales. Se calcula una salida cada D = M/2
+// muestras (sobremuestreo 2x: tasa 2*fs/M), para que una estación entre dos
+// canales no caiga en la banda de transición del prototipo.
+//
+// Cada estación toma el canal más cercano a su portadora, corrige el
+// residuo fc - k*fs/M con un rotador (fase en punto fijo de 64 bits a partir
+// del índice absoluto de la muestra, como ddc_frontend) y pasa por su propio
+// pasa-bajas de ±ancho/2 a la tasa del canal. La convención de signo es la
+// de freq_xlating_fir_filter_fcc: una portadora en fc queda en 0 Hz.
+//
+// El costo por muestra de entrada es L/D + O(log M) para el banco, más
+// O(taps por estación) a la tasa del canal; agregar una estación no agrega
+// trabajo a la tasa de entrada. Para fs = 48 kHz y estaciones de 800 Hz de
+// ancho, M = 16 y los canales salen a 6 kHz.
+//
+// Entrada: float a la tasa fs. Salida: un puerto gr_complex por estación, a
+// la tasa tasa_salida().
+
+#ifndef BLOQUES_PFB_FRONTEND_H
+#define BLOQUES_PFB_FRONTEND_H
+
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/filter/fir_filter.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_decimator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Una estación a monitorear
+struct pfb_estacion {
+    std::string nombre;
+    double fc;           // portadora (Hz)
+    double ancho;        // ancho de banda total alrededor de fc (Hz)
+    double bps = 200.0;  // tasa de bits MSK (tonos en ±bps/2 de la señal al cuadrado)
+};
+
+// Lee estaciones de un archivo de texto, una por línea:
+//   nombre fc_hz ancho_hz [bps]
+// Las líneas vacías y las que empiezan con '#' se ignoran.
+inline std::vector<pfb_estacion> leer_estaciones(const std::string& archivo) {
+    std::ifstream f(archivo);
+    if (!f) {
+        throw std::runtime_error("leer_estaciones: no se pudo abrir " + archivo);
+    }
+    std::vector<pfb_estacion> r;
+    std::string linea;
+    for (int n = 1; std::getline(f, linea); n++) {
+        const size_t inicio = linea.find_first_not_of(" \t\r");
+        if (inicio == std::string::npos || linea[inicio] == '#') {
+            continue;
+        }
+        std::istringstream ss(linea);
+        pfb_estacion e;
+        if (!(ss >> e.nombre >> e.fc >> e.ancho)) {
+            throw std::runtime_error("leer_estaciones: " + archivo + ":" + std::to_string(n) +
+                                     ": se esperaba 'nombre fc_hz ancho_hz [bps]'");
+        }
+        ss >> e.bps;
+        r.push_back(e);
+    }
+    if (r.empty()) {
+        throw std::runtime_error("leer_estaciones: " + archivo + " no tiene estaciones");
+    }
+    return r;
+}
+
+class pfb_frontend : public gr::sync_decimator {
+public:
+    typedef std::shared_ptr<pfb_frontend> sptr;
+
+    static constexpr int MAX_CANALES = 1024;
+
+    // samp_rate: tasa de la señal real de entrada
+    // estaciones: portadora y ancho de cada salida
+    // canales: número M de canales del banco (potencia de 2); 0 = automático
+    static sptr make(double samp_rate, const std::vector<pfb_estacion>& estaciones, int canales = 0) {
+        return gnuradio::get_initial_sptr(new pfb_frontend(samp_rate, estaciones, canales));
+    }
+
+    // Mayor M (potencia de 2) con fs/M >= 4*(corte + transición) de la
+    // estación más ancha: entre la banda de paso del prototipo y el alias
+    // quedan al menos fs/(2M) de transición
+    static int elegir_canales(double samp_rate, const std::vector<pfb_estacion>& estaciones) {
+        const double borde = borde_maximo(estaciones);
+        int m = 2;
+        while (m < MAX_CANALES && samp_rate / (2 * m) >= 4.0 * borde) {
+            m *= 2;
+        }
+        return m;
+    }
+
+    pfb_frontend(double samp_rate, const std::vector<pfb_estacion>& estaciones, int canales)
+        : gr::sync_decimator("pfb_frontend",
+                             gr::io_signature::make(1, 1, sizeof(float)),
+                             gr::io_signature::make(estaciones.size(),
+                                                    estaciones.size(),
+                                                    sizeof(gr_complex)),
+                             validar_canales(samp_rate, estaciones, canales) / 2),
+          d_samp_rate(samp_rate),
+          d_m(2 * decimation()),
+          d_fft(d_m) {
+        const double ancho_canal = samp_rate / d_m;
+        const double borde = borde_maximo(estaciones);
+        if (ancho_canal <= 2.0 * borde) {
+            throw std::invalid_argument("pfb_frontend: las estaciones no caben en canales de " +
+                                        std::to_string(ancho_canal) + " Hz");
+        }
+
+        // Prototipo: plano hasta la mitad del canal más el borde de la
+        // estación más ancha (una portadora puede quedar a fs/(2M) del centro
+        // de su canal) y rechazo desde donde empezaría el alias de ese borde a
+        // la tasa 2*fs/M. firdes::low_pass pone el corte a la mitad de la
+        // transición, y con Hamming la transición real es ~1/0.7 de la pedida:
+        // se pide el 70% del espacio entre ambos bordes (plano a ±0.05 dB,
+        // rechazo de 52 dB o más).
+        const double paso = ancho_canal / 2 + borde;
+        const double rechazo = 2 * ancho_canal - paso;
+        std::vector<float> h = gr::filter::firdes::low_pass(
+            1.0, samp_rate, (paso + rechazo) / 2, 0.7 * (rechazo - paso), gr::fft::window::win_type::WIN_HAMMING);
+        h.resize((h.size() + d_m - 1) / d_m * d_m, 0.0f);
+        // Invertidos: la suma polifásica recorre la entrada en orden creciente
+        d_prototipo.assign(h.rbegin(), h.rend());
+        set_history(d_prototipo.size());
+
+        for (const pfb_estacion& e : estaciones) {
+            if (e.fc < 0 || e.fc >= samp_rate / 2 || e.ancho <= 0) {
+                throw std::invalid_argument("pfb_frontend: estación " + e.nombre + " fuera de rango");
+            }
+            d_estaciones.emplace_back(new estacion(e, samp_rate, d_m, tasa_salida()));
+        }
+    }
+
+    int canales() const { return d_m; }
+    unsigned ntaps() const { return d_prototipo.size(); }
+    double tasa_salida() const { return d_samp_rate / decimation(); }
+
+    // Canal del banco y taps del pasa-bajas de una estación
+    int canal(size_t s) const { return d_estaciones.at(s)->k; }
+    unsigned ntaps_estacion(size_t s) const { return d_estaciones.at(s)->fir.ntaps(); }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        const float* in = (const float*)input_items[0];
+        const int m = d_m;
+        const int d = decimation();
+        const size_t l = d_prototipo.size();
+        float* v = d_fft.get_inbuf();
+        const gr_complex* espectro = d_fft.get_outbuf();
+
+        for (auto& e : d_estaciones) {
+            e->linea.resize(e->fir.ntaps() - 1 + noutput_items);
+        }
+
+        for (int i = 0; i < noutput_items; i++) {
+            // Última muestra usada: t = (n+1)*D - 1, con n la salida absoluta
+            const uint64_t n = d_salida + i;
+            const uint64_t t = (n + 1) * d - 1;
+            const float* x = in + i * d + d - 1; // x[0] = x[t - L + 1]
+
+            // v[q] = sum_p g[pM+q] x[pM+q], con g el prototipo invertido;
+            // u_r = v[M-1-r]
+            std::memset(v, 0, m * sizeof(float));
+            for (size_t p = 0; p < l; p += m) {
+                const float* g = d_prototipo.data() + p;
+                const float* xp = x + p;
+                for (int q = 0; q < m; q++) {
+                    v[q] += g[q] * xp[q];
+                }
+            }
+            d_fft.execute();
+
+            // Con u invertida en v: sum_r u_r e^{j2 pi k r/M} = e^{-j2 pi k/M} V[k],
+            // así que X_k[t] = e^{-j2 pi k (t+1)/M} V[k]. El rotador de cada
+            // estación aplica ese factor junto con el residuo: en total
+            // e^{-j2 pi (fc t/fs + k/M)}.
+            for (auto& e : d_estaciones) {
+                const uint64_t fase = t * e->incr + e->fase_k;
+                const double radianes = -static_cast<int64_t>(fase) * (M_PI / 9223372036854775808.0);
+                e->linea[e->fir.ntaps() - 1 + i] =
+                    espectro[e->k] * gr_complex(std::cos(radianes), std::sin(radianes));
+            }
+        }
+
+        for (size_t s = 0; s < d_estaciones.size(); s++) {
+            estacion& e = *d_estaciones[s];
+            e.fir.filterN((gr_complex*)output_items[s], e.linea.data(), noutput_items);
+            // Conservar las últimas ntaps-1 muestras para la siguiente llamada
+            std::copy(e.linea.end() - (e.fir.ntaps() - 1), e.linea.end(), e.linea.begin());
+        }
+        d_salida += noutput_items;
+        return noutput_items;
+    }
+
+private:
+    struct estacion {
+        estacion(const pfb_estacion& e, double samp_rate, int m, double tasa_canal)
+            : k(static_cast<int>(std::lround(e.fc * m / samp_rate))),
+              // fc/fs y k/M en fracciones de ciclo * 2^64
+              incr(static_cast<uint64_t>(std::ldexp(e.fc / samp_rate, 64))),
+              fase_k(static_cast<uint64_t>(k) * ((UINT64_C(1) << 63) / (m / 2))),
+              fir(gr::filter::firdes::low_pass(
+                  1.0, tasa_canal, e.ancho / 2, e.ancho / 4, gr::fft::window::win_type::WIN_HAMMING)),
+              linea(fir.ntaps() - 1, gr_complex(0, 0)) {}
+
+        const int k;
+        const uint64_t incr;
+        const uint64_t fase_k;
+        gr::filter::kernel::fir_filter_ccf fir;
+        std::vector<gr_complex> linea; // ntaps-1 muestras previas + las de este work()
+    };
+
+    // M elegido o automático; se valida antes de construir sync_decimator
+    static int validar_canales(double samp_rate, const std::vector<pfb_estacion>& estaciones, int canales) {
+        if (estaciones.empty()) {
+            throw std::invalid_argument("pfb_frontend: se requiere al menos una estación");
+        }
+        const int m = canales > 0 ? canales : elegir_canales(samp_rate, estaciones);
+        if (m < 2 || (m & (m - 1)) != 0 || m > MAX_CANALES) {
+            throw std::invalid_argument("pfb_frontend: canales debe ser potencia de 2 entre 2 y 1024");
+        }
+        return m;
+    }
+
+    // Corte + transición del pasa-bajas de la estación más ancha
+    static double borde_maximo(const std::vector<pfb_estacion>& estaciones) {
+        double borde = 0;
+        for (const pfb_estacion& e : estaciones) {
+            borde = std::max(borde, 0.75 * e.ancho);
+        }
+        return borde;
+    }
+
+    const double d_samp_rate;
+    const int d_m;
+    gr::fft::fft<float, true> d_fft;
+    std::vector<float> d_prototipo; // invertido, L = M*P
+    std::vector<std::unique_ptr<estacion>> d_estaciones;
+    uint64_t d_salida = 0; // índice absoluto de la siguiente muestra de salida
+};
+
+#endif // BLOQUES_PFB_FRONTEND_H
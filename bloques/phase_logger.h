@@ -0,0 +1,195 @@
+// phase_logger.h
+// Sumidero para registrar amplitud y fase sin hacer E/S en el hilo del
+// scheduler. work() solo copia las muestras (decimadas) a un buffer circular
+// SPSC; un hilo escritor lo vacía por lotes hacia stdout, CSV o binario.
+//
+// Formato binario: registros consecutivos de
+//     uint64_t muestra; float amplitud; float fase_grados;
+// en el orden de bytes de la máquina que lo escribe.
+
+#ifndef BLOQUES_PHASE_LOGGER_H
+#define BLOQUES_PHASE_LOGGER_H
+
+#include "spsc_ring.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class phase_logger : public gr::sync_block {
+public:
+    typedef std::shared_ptr<phase_logger> sptr;
+
+    enum class formato { CONSOLA, CSV, BINARIO };
+
+    // archivo: se ignora en modo CONSOLA (siempre stdout)
+    // decimacion: se registra 1 de cada 'decimacion' muestras
+    // capacidad: tamaño del buffer circular en registros
+    static sptr make(formato fmt = formato::CONSOLA,
+                     const std::string& archivo = "",
+                     int decimacion = 1,
+                     size_t capacidad = 1 << 16) {
+        return gnuradio::get_initial_sptr(
+            new phase_logger(fmt, archivo, decimacion, capacidad));
+    }
+
+    phase_logger(formato fmt, const std::string& archivo, int decimacion, size_t capacidad)
+        : gr::sync_block("phase_logger",
+                         gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_formato(fmt),
+          d_archivo(archivo),
+          d_decimacion(decimacion > 0 ? decimacion : 1),
+          d_ring(capacidad) {
+        if (d_formato != formato::CONSOLA && d_archivo.empty()) {
+            throw std::invalid_argument("phase_logger: se requiere nombre de archivo");
+        }
+    }
+
+    ~phase_logger() override { detener_escritor(); }
+
+    // Registros que no cupieron en el buffer (el escritor no alcanzó)
+    uint64_t descartados() const { return d_descartados.load(std::memory_order_relaxed); }
+
+    // Registros efectivamente escritos por el hilo escritor
+    uint64_t escritos() const { return d_escritos.load(std::memory_order_relaxed); }
+
+    bool start() override {
+        if (d_formato == formato::CONSOLA) {
+            d_salida = stdout;
+        } else {
+            d_salida = std::fopen(d_archivo.c_str(), d_formato == formato::CSV ? "w" : "wb");
+            if (!d_salida) {
+                throw std::runtime_error("phase_logger: no se pudo abrir " + d_archivo);
+            }
+            if (d_formato == formato::CSV) {
+                std::fputs("muestra,amplitud,fase_grados\n", d_salida);
+            }
+        }
+        d_corriendo = true;
+        d_escritor = std::thread(&phase_logger::escritor, this);
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        detener_escritor();
+        return gr::sync_block::stop();
+    }
+
+    // Solo decimación y copia al buffer: sin E/S ni reservas de memoria
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        const gr_complex* in = (const gr_complex*)input_items[0];
+        const uint64_t n0 = nitems_read(0);
+
+        for (int i = d_fase; i < noutput_items; i += d_decimacion) {
+            if (!d_ring.push(registro{ n0 + i, in[i] })) {
+                d_descartados.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        d_fase = (d_fase + d_decimacion - noutput_items % d_decimacion) % d_decimacion;
+        return noutput_items;
+    }
+
+private:
+    struct registro {
+        uint64_t muestra;
+        gr_complex valor;
+    };
+
+    struct registro_binario {
+        uint64_t muestra;
+        float amplitud;
+        float fase_grados;
+    };
+
+    static constexpr size_t LOTE = 4096;
+
+    void escritor() {
+        std::vector<registro> lote(LOTE);
+        std::vector<char> texto(LOTE * 64);
+        std::vector<registro_binario> binario(LOTE);
+
+        bool ultimo_pase = false;
+        while (!ultimo_pase) {
+            // Se lee la bandera antes de vaciar para no perder el último lote
+            ultimo_pase = !d_corriendo.load(std::memory_order_acquire);
+            size_t n;
+            while ((n = d_ring.pop(lote.data(), LOTE)) > 0) {
+                escribir_lote(lote.data(), n, texto, binario);
+            }
+            std::fflush(d_salida);
+            if (!ultimo_pase) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+    }
+
+    void escribir_lote(const registro* r,
+                       size_t n,
+                       std::vector<char>& texto,
+                       std::vector<registro_binario>& binario) {
+        if (d_formato == formato::BINARIO) {
+            for (size_t i = 0; i < n; i++) {
+                binario[i] = { r[i].muestra, 2 * std::abs(r[i].valor), fase_grados(r[i].valor) };
+            }
+            std::fwrite(binario.data(), sizeof(registro_binario), n, d_salida);
+        } else {
+            size_t pos = 0;
+            for (size_t i = 0; i < n; i++) {
+                const float amplitud = 2 * std::abs(r[i].valor);
+                const float fase = fase_grados(r[i].valor);
+                if (d_formato == formato::CSV) {
+                    pos += std::snprintf(&texto[pos], 64, "%llu,%g,%g\n",
+                                         (unsigned long long)r[i].muestra, amplitud, fase);
+                } else {
+                    pos += std::snprintf(&texto[pos], 64, "Amplitud: %g, Fase: %g grados\n",
+                                         amplitud, fase);
+                }
+            }
+            std::fwrite(texto.data(), 1, pos, d_salida);
+        }
+        d_escritos.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static float fase_grados(const gr_complex& x) {
+        return std::arg(x) * 180.0f / M_PI; // Conversión a grados
+    }
+
+    void detener_escritor() {
+        d_corriendo = false;
+        if (d_escritor.joinable()) {
+            d_escritor.join();
+        }
+        if (d_salida && d_salida != stdout) {
+            std::fclose(d_salida);
+        }
+        d_salida = nullptr;
+    }
+
+    const formato d_formato;
+    const std::string d_archivo;
+    const int d_decimacion;
+    int d_fase = 0; // índice de la próxima muestra a registrar en el siguiente work()
+
+    spsc_ring<registro> d_ring;
+    std::thread d_escritor;
+    std::atomic<bool> d_corriendo{ false };
+    std::FILE* d_salida = nullptr;
+
+    std::atomic<uint64_t> d_descartados{ 0 };
+    std::atomic<uint64_t> d_escritos{ 0 };
+};
+
+#endif // BLOQUES_PHASE_LOGGER_H
@@ -0,0 +1,231 @@
+// polyphase_resampler.h
+// Remuestreador racional interp/decim para float, en forma polifásica.
+//
+// Equivale a intercalar interp-1 ceros entre muestras, filtrar con un
+// pasa-bajas h a la tasa interp*fs y quedarse con una de cada decim muestras:
+//
+//     y[n] = sum_t h[p + t*interp] x[j - t],   j = (n*decim) / interp,
+//                                              p = (n*decim) % interp
+//
+// así que cada salida es el producto punto de K muestras de entrada con una
+// de las interp fases del filtro (K = taps por fase). Los productos con los
+// ceros intercalados nunca se calculan.
+//
+// El banco (fases invertidas y alineadas, rellenas con ceros hasta un múltiplo
+// de 8, y para cada fase cuántas muestras avanzar y cuál es la fase siguiente)
+// se calcula una vez en polyphase_resampler::disenar y se puede compartir
+// entre varios bloques. El producto punto es un kernel AVX2/FMA que recorre
+// todas las salidas de work() sin salir de la función; sin AVX2 se usa
+// volk_32f_x2_dot_prod_32f por salida.
+//
+// La relación interp/decim es exacta (sin deriva en archivos largos). El
+// filtro por omisión (disenar_taps) es un Kaiser de la atenuación pedida con
+// ganancia interp, de banda de paso y de rechazo dadas en fracciones de la
+// tasa de entrada.
+
+#ifndef BLOQUES_POLYPHASE_RESAMPLER_H
+#define BLOQUES_POLYPHASE_RESAMPLER_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <volk/volk_alloc.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define POLYPHASE_RESAMPLER_X86 1
+#endif
+
+class polyphase_resampler : public gr::block {
+public:
+    typedef std::shared_ptr<polyphase_resampler> sptr;
+
+    // Fases del filtro y tablas de avance, de solo lectura una vez calculadas
+    struct banco {
+        int interp;
+        int decim;
+        int ntaps;                  // taps por fase (K), múltiplo de 8
+        volk::vector<float> taps;   // interp filas de K, la más antigua primero
+        std::vector<int> avance;    // por fase: muestras de entrada hasta la siguiente salida
+        std::vector<int> siguiente; // por fase: fase de la siguiente salida
+    };
+
+    // Pasa-bajas Kaiser para la tasa interp*fs. paso y rechazo: bordes de la
+    // banda de paso y de rechazo en fracciones de la tasa de entrada fs.
+    static std::vector<float> disenar_taps(int interp, double paso, double rechazo, double atenuacion_db = 80.0) {
+        if (interp < 1 || paso <= 0 || rechazo <= paso) {
+            throw std::invalid_argument("polyphase_resampler: se requiere 0 < paso < rechazo");
+        }
+        const double beta = atenuacion_db > 50 ? 0.1102 * (atenuacion_db - 8.7)
+                            : atenuacion_db > 21
+                                ? 0.5842 * std::pow(atenuacion_db - 21, 0.4) + 0.07886 * (atenuacion_db - 21)
+                                : 0.0;
+        return gr::filter::firdes::low_pass_2(interp, interp, (paso + rechazo) / 2, rechazo - paso,
+                                              atenuacion_db, gr::fft::window::WIN_KAISER, beta);
+    }
+
+    // taps: filtro a la tasa interp*fs (con ganancia interp para conservar la
+    // amplitud); interp y decim deben ser primos entre sí
+    static std::shared_ptr<const banco> disenar(int interp, int decim, const std::vector<float>& taps) {
+        if (interp < 1 || decim < 1 || std::gcd(interp, decim) != 1) {
+            throw std::invalid_argument("polyphase_resampler: interp y decim deben ser positivos y primos entre sí");
+        }
+        if (taps.empty()) {
+            throw std::invalid_argument("polyphase_resampler: se requiere al menos un tap");
+        }
+        auto b = std::make_shared<banco>();
+        b->interp = interp;
+        b->decim = decim;
+        const int por_fase = (static_cast<int>(taps.size()) + interp - 1) / interp;
+        b->ntaps = (por_fase + 7) / 8 * 8;
+
+        // Fila p, posición K-1-t: h[p + t*interp]. El relleno queda en las
+        // posiciones más antiguas.
+        const int K = b->ntaps;
+        b->taps.assign(size_t(interp) * K, 0.0f);
+        for (int p = 0; p < interp; p++) {
+            for (int t = 0; t < por_fase; t++) {
+                const size_t k = size_t(p) + size_t(t) * interp;
+                if (k < taps.size()) {
+                    b->taps[size_t(p) * K + (K - 1 - t)] = taps[k];
+                }
+            }
+        }
+        b->avance.resize(interp);
+        b->siguiente.resize(interp);
+        for (int p = 0; p < interp; p++) {
+            b->avance[p] = (p + decim) / interp;
+            b->siguiente[p] = (p + decim) % interp;
+        }
+        return b;
+    }
+
+    // Con el filtro por omisión: banda de paso hasta 0.4 y rechazo desde 0.5
+    // de la menor de las dos tasas
+    static sptr make(int interp, int decim, double atenuacion_db = 80.0) {
+        const int g = std::gcd(interp, decim);
+        if (interp < 1 || decim < 1) {
+            throw std::invalid_argument("polyphase_resampler: interp y decim deben ser positivos");
+        }
+        interp /= g;
+        decim /= g;
+        const double r = std::min(1.0, double(interp) / decim);
+        return make(disenar(interp, decim, disenar_taps(interp, 0.4 * r, 0.5 * r, atenuacion_db)));
+    }
+
+    // Con un banco ya calculado (compartido con otros remuestreadores)
+    static sptr make(std::shared_ptr<const banco> b) {
+        return gnuradio::get_initial_sptr(new polyphase_resampler(b));
+    }
+
+    explicit polyphase_resampler(std::shared_ptr<const banco> b)
+        : gr::block("polyphase_resampler",
+                    gr::io_signature::make(1, 1, sizeof(float)),
+                    gr::io_signature::make(1, 1, sizeof(float))),
+          d_banco(b) {
+        set_history(b->ntaps);
+        set_relative_rate(uint64_t(b->interp), uint64_t(b->decim));
+
+#ifdef POLYPHASE_RESAMPLER_X86
+        d_usar_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    int interpolation() const { return d_banco->interp; }
+    int decimation() const { return d_banco->decim; }
+    int taps_por_fase() const { return d_banco->ntaps; }
+    bool usa_avx2() const { return d_usar_avx2; }
+
+    void forecast(int noutput_items, gr_vector_int& ninput_items_required) override {
+        // Entrada que consumen noutput_items salidas desde la peor fase, más
+        // la historia
+        const int64_t avance = (int64_t(noutput_items) * d_banco->decim + d_banco->interp - 1) / d_banco->interp;
+        ninput_items_required[0] = static_cast<int>(avance) + d_banco->ntaps - 1;
+    }
+
+    int general_work(int noutput_items,
+                     gr_vector_int& ninput_items,
+                     gr_vector_const_void_star& input_items,
+                     gr_vector_void_star& output_items) override {
+        const float* in = (const float*)input_items[0];
+        float* out = (float*)output_items[0];
+        // Última posición donde cabe una ventana completa de K muestras
+        const int ultima = ninput_items[0] - d_banco->ntaps;
+
+        int producidos, consumidos;
+#ifdef POLYPHASE_RESAMPLER_X86
+        if (d_usar_avx2) {
+            filtrar_avx2(in, out, noutput_items, ultima, producidos, consumidos);
+        } else
+#endif
+        {
+            filtrar(in, out, noutput_items, ultima, producidos, consumidos);
+        }
+        consume_each(consumidos);
+        return producidos;
+    }
+
+private:
+    void filtrar(const float* in, float* out, int noutput, int ultima, int& producidos, int& consumidos) {
+        const banco& b = *d_banco;
+        int i = 0, n = 0, p = d_fase;
+        for (; n < noutput && i <= ultima; n++) {
+            volk_32f_x2_dot_prod_32f(out + n, in + i, b.taps.data() + size_t(p) * b.ntaps, b.ntaps);
+            i += b.avance[p];
+            p = b.siguiente[p];
+        }
+        d_fase = p;
+        producidos = n;
+        consumidos = i;
+    }
+
+#ifdef POLYPHASE_RESAMPLER_X86
+    // Dos acumuladores de 8 para ocultar la latencia de la FMA
+    __attribute__((target("avx2,fma"))) void
+    filtrar_avx2(const float* in, float* out, int noutput, int ultima, int& producidos, int& consumidos) {
+        const banco& b = *d_banco;
+        const int K = b.ntaps;
+        int i = 0, n = 0, p = d_fase;
+        for (; n < noutput && i <= ultima; n++) {
+            const float* x = in + i;
+            const float* h = b.taps.data() + size_t(p) * K;
+            __m256 a0 = _mm256_setzero_ps();
+            __m256 a1 = _mm256_setzero_ps();
+            int k = 0;
+            for (; k + 16 <= K; k += 16) {
+                a0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + k), _mm256_load_ps(h + k), a0);
+                a1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + k + 8), _mm256_load_ps(h + k + 8), a1);
+            }
+            if (k < K) {
+                a0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + k), _mm256_load_ps(h + k), a0);
+            }
+            // Suma horizontal
+            const __m256 s = _mm256_add_ps(a0, a1);
+            __m128 v = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+            v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+            v = _mm_add_ss(v, _mm_movehdup_ps(v));
+            out[n] = _mm_cvtss_f32(v);
+            i += b.avance[p];
+            p = b.siguiente[p];
+        }
+        d_fase = p;
+        producidos = n;
+        consumidos = i;
+    }
+#endif
+
+    const std::shared_ptr<const banco> d_banco;
+    bool d_usar_avx2 = false;
+    int d_fase = 0; // fase del filtro de la siguiente salida
+};
+
+#endif // BLOQUES_POLYPHASE_RESAMPLER_H
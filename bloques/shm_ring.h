@@ -0,0 +1,529 @@
+// shm_ring.h
+// Anillo en memoria compartida (POSIX shm) para repartir un flujo de un
+// proceso de captura a varios procesos de análisis en la misma máquina.
+//
+// Un solo proceso abre la tarjeta de sonido y publica sus muestras con
+// shm_ring_sink; cualquier número de procesos (audio_recorder,
+// msk_phase_soundcard, un espectrograma) se conectan con shm_ring_source o
+// con shm_ring directamente, sin dsnoop de ALSA ni copias entre procesos.
+//
+// El segmento /dev/shm/<nombre> tiene una página de cabecera y un anillo de
+// 'capacidad' cuadros (un float por canal, intercalados). El anillo se
+// proyecta dos veces seguidas en memoria virtual, así que cualquier tramo de
+// hasta 'capacidad' cuadros es contiguo aunque dé la vuelta: un lector
+// obtiene un apuntador directo a las muestras (shm_ring::ver) sin copiarlas.
+//
+// Números de secuencia: cada cuadro tiene un índice absoluto (la muestra
+// número i desde que arrancó el productor). La cabecera lleva dos contadores:
+//   reservados  hasta dónde el productor puede estar escribiendo
+//   escritos    hasta dónde los datos están completos
+// El productor nunca espera a los lectores: si uno se atrasa más de
+// 'capacidad' cuadros, sus datos se sobrescriben. Un lector que usó el tramo
+// desde el índice i comprueba después con vigente(i) que no se le haya
+// sobrescrito (como un seqlock); si no, lo cuenta como perdido y salta
+// adelante.
+//
+// Aviso de datos nuevos: un futex compartido entre procesos en la cabecera.
+// El productor solo llama a FUTEX_WAKE si hay lectores dormidos.
+//
+// La cabecera guarda el pid del productor: si muere sin llamar a terminar()
+// (SIGKILL, una falla), los lectores lo notan al no llegar datos y terminan
+// igual. Un segundo productor con el mismo nombre no reemplaza a uno vivo.
+//
+// Permisos: los lectores también escriben en la cabecera (el futex y el
+// contador de dormidos), así que abren el segmento para lectura y escritura.
+// Por omisión se crea con modo 0600 y solo el usuario del productor puede
+// leerlo; para lectores de otro usuario, crear con modo 0660 y un grupo
+// común (audio_publisher --modo 660).
+
+#ifndef BLOQUES_SHM_RING_H
+#define BLOQUES_SHM_RING_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <pmt/pmt.h>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shm_ring: los atómicos deben funcionar entre procesos");
+
+// Los programas de captura aceptan "shm:<nombre>" como dispositivo de
+// entrada; regresa <nombre>, o "" si es un dispositivo de audio
+inline std::string nombre_shm(const std::string& dispositivo) {
+    return dispositivo.compare(0, 4, "shm:") == 0 ? dispositivo.substr(4) : "";
+}
+
+// Primera página del segmento
+struct shm_ring_cabecera {
+    char magico[8];               // "SHMRING"
+    uint32_t version;
+    uint32_t canales;             // floats por cuadro
+    double samp_rate;
+    uint64_t capacidad;           // cuadros en el anillo (potencia de 2)
+    uint64_t inicio_datos;        // bytes desde el inicio del segmento
+    uint64_t bytes_datos;         // capacidad * canales * 4 (múltiplo de página)
+    int32_t pid;                  // proceso productor
+    alignas(64) std::atomic<uint64_t> reservados;
+    std::atomic<uint64_t> escritos;
+    alignas(64) std::atomic<uint32_t> aviso;      // palabra del futex
+    std::atomic<uint32_t> dormidos;               // lectores esperando en el futex
+    std::atomic<uint32_t> terminado;              // el productor ya no publica
+};
+
+class shm_ring {
+public:
+    static constexpr char MAGICO[8] = "SHMRING";
+    static constexpr uint32_t VERSION = 2;
+
+    // Productor: crea /dev/shm/<nombre> con al menos 'cuadros' de capacidad.
+    // Si otro productor vivo ya publica con ese nombre, lanza una excepción
+    // (EEXIST). Un segmento anterior cuyo productor terminó o murió se marca
+    // como terminado (para que sus lectores se enteren) y se reemplaza.
+    // 'modo' son los permisos del segmento, sin aplicar la umask.
+    static std::shared_ptr<shm_ring> crear(const std::string& nombre, int canales, double samp_rate, uint64_t cuadros,
+                                           mode_t modo = 0600) {
+        if (canales < 1 || samp_rate <= 0) {
+            throw std::invalid_argument("shm_ring: se requiere al menos un canal y samp_rate positivo");
+        }
+        const std::string ruta = normalizar(nombre);
+        std::shared_ptr<shm_ring> anterior;
+        try {
+            anterior = abrir(nombre);
+        } catch (const std::runtime_error&) {
+            // No existe o no es un anillo válido: se reemplaza
+        }
+        if (anterior) {
+            if (anterior->productor_vivo()) {
+                throw std::runtime_error("shm_ring: /dev/shm" + ruta + " ya lo publica el proceso " +
+                                         std::to_string(anterior->d_cabecera->pid) + ": " + std::strerror(EEXIST));
+            }
+            anterior->terminar();
+        }
+        ::shm_unlink(ruta.c_str());
+
+        // Para la doble proyección el anillo debe medir páginas completas
+        const uint64_t pagina = ::sysconf(_SC_PAGESIZE);
+        uint64_t capacidad = 1024;
+        while (capacidad < cuadros || capacidad * canales * sizeof(float) % pagina != 0) {
+            capacidad <<= 1;
+        }
+        const uint64_t bytes = capacidad * canales * sizeof(float);
+
+        std::shared_ptr<shm_ring> r(new shm_ring(nombre, true));
+        r->d_fd = ::shm_open(ruta.c_str(), O_RDWR | O_CREAT | O_EXCL, modo);
+        if (r->d_fd < 0 || ::fchmod(r->d_fd, modo) != 0 || ::ftruncate(r->d_fd, pagina + bytes) != 0) {
+            throw std::runtime_error("shm_ring: no se pudo crear /dev/shm" + ruta + ": " + std::strerror(errno));
+        }
+        r->proyectar(pagina, true);
+        shm_ring_cabecera* c = r->d_cabecera;
+        std::memcpy(c->magico, MAGICO, sizeof(MAGICO));
+        c->version = VERSION;
+        c->canales = canales;
+        c->samp_rate = samp_rate;
+        c->capacidad = capacidad;
+        c->inicio_datos = pagina;
+        c->bytes_datos = bytes;
+        c->pid = ::getpid();
+        r->proyectar_datos(true);
+        return r;
+    }
+
+    // Lector: se conecta a un segmento existente
+    static std::shared_ptr<shm_ring> abrir(const std::string& nombre) {
+        std::shared_ptr<shm_ring> r(new shm_ring(nombre, false));
+        r->d_fd = ::shm_open(r->d_nombre.c_str(), O_RDWR, 0);
+        if (r->d_fd < 0) {
+            const int e = errno;
+            std::string pista;
+            if (e == ENOENT) {
+                pista = " (¿corre el productor?)";
+            } else if (e == EACCES) {
+                pista = " (el lector necesita lectura y escritura: mismo usuario que el productor, o crearlo con "
+                        "--modo 660 y un grupo común)";
+            }
+            throw std::runtime_error("shm_ring: no se pudo abrir /dev/shm" + r->d_nombre + ": " + std::strerror(e) +
+                                     pista);
+        }
+        struct stat st;
+        const uint64_t pagina = ::sysconf(_SC_PAGESIZE);
+        if (::fstat(r->d_fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < pagina) {
+            throw std::runtime_error("shm_ring: segmento demasiado corto: " + nombre);
+        }
+        r->proyectar(pagina, false);
+        const shm_ring_cabecera* c = r->d_cabecera;
+        if (std::memcmp(c->magico, MAGICO, sizeof(MAGICO)) != 0 || c->version != VERSION ||
+            c->capacidad == 0 || (c->capacidad & (c->capacidad - 1)) != 0 ||
+            c->inicio_datos + c->bytes_datos != static_cast<uint64_t>(st.st_size) ||
+            c->bytes_datos != c->capacidad * c->canales * sizeof(float)) {
+            throw std::runtime_error("shm_ring: cabecera inválida en " + nombre);
+        }
+        r->proyectar_datos(false);
+        return r;
+    }
+
+    ~shm_ring() {
+        if (d_productor && d_cabecera) {
+            terminar();
+        }
+        // Solo si el nombre sigue siendo de este segmento: otro productor
+        // pudo haberlo reemplazado después de que este terminó
+        if (d_productor && d_fd >= 0 && es_el_mismo_segmento()) {
+            ::shm_unlink(d_nombre.c_str());
+        }
+        if (d_datos) {
+            ::munmap(d_datos, 2 * d_cabecera->bytes_datos);
+        }
+        if (d_cabecera) {
+            ::munmap(d_cabecera, d_tam_cabecera);
+        }
+        if (d_fd >= 0) {
+            ::close(d_fd);
+        }
+    }
+
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    const std::string& nombre() const { return d_nombre; }
+    int canales() const { return d_cabecera->canales; }
+    double samp_rate() const { return d_cabecera->samp_rate; }
+    uint64_t capacidad() const { return d_cabecera->capacidad; }
+    uint64_t escritos() const { return d_cabecera->escritos.load(std::memory_order_acquire); }
+    bool terminado() const { return d_cabecera->terminado.load(std::memory_order_acquire) != 0; }
+
+    // false si el productor terminó o su proceso ya no existe
+    bool productor_vivo() const {
+        if (terminado()) {
+            return false;
+        }
+        // EPERM: existe pero es de otro usuario
+        return ::kill(d_cabecera->pid, 0) == 0 || errno == EPERM;
+    }
+
+    // Productor: espacio contiguo para n <= capacidad cuadros a partir de
+    // escritos(). Los lectores que aún lean ahí verán vigente() == false.
+    float* reservar(uint64_t n) {
+        const uint64_t inicio = d_cabecera->escritos.load(std::memory_order_relaxed);
+        d_cabecera->reservados.store(inicio + n, std::memory_order_relaxed);
+        // Ninguna escritura de datos puede adelantarse a 'reservados'
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return d_datos + (inicio & (capacidad() - 1)) * canales();
+    }
+
+    // Productor: los n cuadros reservados quedan disponibles
+    void publicar(uint64_t n) {
+        d_cabecera->escritos.fetch_add(n, std::memory_order_seq_cst);
+        despertar();
+    }
+
+    // Productor: no habrá más datos
+    void terminar() {
+        d_cabecera->terminado.store(1, std::memory_order_seq_cst);
+        despertar();
+    }
+
+    // Lector: apuntador a los cuadros desde el índice 'desde' (válido para
+    // hasta capacidad() cuadros contiguos)
+    const float* ver(uint64_t desde) const { return d_datos + (desde & (capacidad() - 1)) * canales(); }
+
+    // Lector: true si los cuadros desde 'desde' que se leyeron con ver() no
+    // fueron sobrescritos mientras tanto
+    bool vigente(uint64_t desde) const {
+        // Las lecturas de datos anteriores no pueden pasar después de esta carga
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return d_cabecera->reservados.load(std::memory_order_relaxed) - desde <= capacidad();
+    }
+
+    // Lector: duerme hasta que haya cuadros después de 'desde', el productor
+    // termine o pasen 'ms' milisegundos. Regresa escritos().
+    uint64_t esperar(uint64_t desde, int ms) {
+        shm_ring_cabecera* c = d_cabecera;
+        c->dormidos.fetch_add(1, std::memory_order_seq_cst);
+        const uint32_t aviso = c->aviso.load(std::memory_order_seq_cst);
+        if (c->escritos.load(std::memory_order_seq_cst) == desde && !terminado()) {
+            struct timespec limite = { ms / 1000, (ms % 1000) * 1000000L };
+            ::syscall(SYS_futex, &c->aviso, FUTEX_WAIT, aviso, &limite, nullptr, 0);
+        }
+        c->dormidos.fetch_sub(1, std::memory_order_seq_cst);
+        return escritos();
+    }
+
+private:
+    shm_ring(const std::string& nombre, bool productor) : d_nombre(normalizar(nombre)), d_productor(productor) {}
+
+    // shm_open espera "/nombre"
+    static std::string normalizar(const std::string& nombre) {
+        return !nombre.empty() && nombre[0] == '/' ? nombre : "/" + nombre;
+    }
+
+    // true si d_nombre todavía apunta al segmento abierto en d_fd
+    bool es_el_mismo_segmento() const {
+        const int fd = ::shm_open(d_nombre.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat nuestro, actual;
+        const bool mismo = ::fstat(d_fd, &nuestro) == 0 && ::fstat(fd, &actual) == 0 &&
+                           nuestro.st_dev == actual.st_dev && nuestro.st_ino == actual.st_ino;
+        ::close(fd);
+        return mismo;
+    }
+
+    void proyectar(uint64_t tam, bool productor) {
+        void* p = ::mmap(nullptr, tam, PROT_READ | PROT_WRITE, MAP_SHARED, d_fd, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("shm_ring: mmap falló para " + d_nombre);
+        }
+        d_cabecera = static_cast<shm_ring_cabecera*>(p);
+        d_tam_cabecera = tam;
+        if (productor) {
+            new (d_cabecera) shm_ring_cabecera();
+        }
+    }
+
+    // Reserva el doble del anillo y proyecta el segmento en ambas mitades
+    void proyectar_datos(bool escritura) {
+        const uint64_t bytes = d_cabecera->bytes_datos;
+        void* base = ::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("shm_ring: no se pudo reservar memoria virtual para " + d_nombre);
+        }
+        const int prot = escritura ? PROT_READ | PROT_WRITE : PROT_READ;
+        for (int mitad = 0; mitad < 2; mitad++) {
+            void* p = ::mmap(static_cast<uint8_t*>(base) + mitad * bytes, bytes, prot, MAP_SHARED | MAP_FIXED,
+                             d_fd, d_cabecera->inicio_datos);
+            if (p == MAP_FAILED) {
+                ::munmap(base, 2 * bytes);
+                throw std::runtime_error("shm_ring: mmap del anillo falló para " + d_nombre);
+            }
+        }
+        d_datos = static_cast<float*>(base);
+    }
+
+    void despertar() {
+        d_cabecera->aviso.fetch_add(1, std::memory_order_seq_cst);
+        if (d_cabecera->dormidos.load(std::memory_order_seq_cst) > 0) {
+            ::syscall(SYS_futex, &d_cabecera->aviso, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+    const std::string d_nombre;
+    const bool d_productor;
+    int d_fd = -1;
+    shm_ring_cabecera* d_cabecera = nullptr;
+    uint64_t d_tam_cabecera = 0;
+    float* d_datos = nullptr;
+};
+
+// Publica 'canales' entradas float en el anillo. Nunca espera a los lectores.
+class shm_ring_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<shm_ring_sink> sptr;
+
+    // segundos: señal que cabe en el anillo (cuánto puede atrasarse un lector)
+    // modo: permisos del segmento (ver shm_ring::crear)
+    static sptr make(const std::string& nombre, int canales, double samp_rate, double segundos = 10.0,
+                     mode_t modo = 0600) {
+        return gnuradio::get_initial_sptr(new shm_ring_sink(nombre, canales, samp_rate, segundos, modo));
+    }
+
+    shm_ring_sink(const std::string& nombre, int canales, double samp_rate, double segundos, mode_t modo)
+        : gr::sync_block("shm_ring_sink",
+                         gr::io_signature::make(canales, canales, sizeof(float)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_anillo(shm_ring::crear(nombre, canales, samp_rate, static_cast<uint64_t>(segundos * samp_rate), modo)),
+          d_canales(canales) {}
+
+    const shm_ring& anillo() const { return *d_anillo; }
+
+    bool stop() override {
+        d_anillo->terminar();
+        return true;
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        // En tramos de media capacidad, para que un lector al día siempre
+        // tenga algo vigente que leer
+        const int maximo = static_cast<int>(std::min<uint64_t>(d_anillo->capacidad() / 2, INT_MAX));
+        for (int i = 0; i < noutput_items;) {
+            const int n = std::min(noutput_items - i, maximo);
+            float* destino = d_anillo->reservar(n);
+            if (d_canales == 1) {
+                std::memcpy(destino, (const float*)input_items[0] + i, n * sizeof(float));
+            } else {
+                for (int c = 0; c < d_canales; c++) {
+                    const float* in = (const float*)input_items[c] + i;
+                    for (int k = 0; k < n; k++) {
+                        destino[k * d_canales + c] = in[k];
+                    }
+                }
+            }
+            d_anillo->publicar(n);
+            i += n;
+        }
+        return noutput_items;
+    }
+
+private:
+    std::shared_ptr<shm_ring> d_anillo;
+    const int d_canales;
+};
+
+// Lee de un anillo publicado por otro proceso. Entrega los canales desde
+// 'primero' en tantas salidas como se conecten (1 o más). La primera muestra
+// lleva la etiqueta "shm_indice" con su índice en el anillo; si el lector se
+// atrasa y pierde datos, salta a la mitad más reciente del anillo y la
+// primera muestra después del hueco lleva "shm_perdidas" (cuadros perdidos)
+// y un nuevo "shm_indice". Con el productor terminado, o muerto sin avisar,
+// el flujo termina al leer lo que quede.
+class shm_ring_source : public gr::sync_block {
+public:
+    typedef std::shared_ptr<shm_ring_source> sptr;
+
+    // desde_el_inicio: empezar por lo más antiguo del anillo en vez de lo más nuevo
+    static sptr make(const std::string& nombre, int primero = 0, bool desde_el_inicio = false) {
+        return make(shm_ring::abrir(nombre), primero, desde_el_inicio);
+    }
+
+    // Permite consultar canales y samp_rate antes de crear el bloque
+    static sptr make(std::shared_ptr<shm_ring> anillo, int primero = 0, bool desde_el_inicio = false) {
+        return gnuradio::get_initial_sptr(new shm_ring_source(anillo, primero, desde_el_inicio));
+    }
+
+    shm_ring_source(std::shared_ptr<shm_ring> anillo, int primero, bool desde_el_inicio)
+        : gr::sync_block("shm_ring_source",
+                         gr::io_signature::make(0, 0, 0),
+                         gr::io_signature::make(1, std::max(1, anillo->canales() - primero), sizeof(float))),
+          d_anillo(anillo),
+          d_primero(primero),
+          d_desde_el_inicio(desde_el_inicio) {
+        if (primero < 0 || primero >= anillo->canales()) {
+            throw std::invalid_argument("shm_ring_source: canal fuera del anillo");
+        }
+    }
+
+    const shm_ring& anillo() const { return *d_anillo; }
+    uint64_t perdidas() const { return d_perdidas.load(std::memory_order_relaxed); }
+    uint64_t huecos() const { return d_huecos.load(std::memory_order_relaxed); }
+
+    bool start() override {
+        // Lo más antiguo que el productor no puede estar sobrescribiendo es
+        // media capacidad atrás (escribe en tramos de media capacidad)
+        const uint64_t escritos = d_anillo->escritos();
+        const uint64_t media = d_anillo->capacidad() / 2;
+        d_leido = !d_desde_el_inicio ? escritos : escritos > media ? escritos - media : 0;
+        d_marcar = true;
+        return true;
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star&,
+             gr_vector_void_star& output_items) override {
+        const uint64_t capacidad = d_anillo->capacidad();
+        uint64_t escritos = d_anillo->escritos();
+        if (escritos == d_leido) {
+            if (d_anillo->terminado()) {
+                return WORK_DONE;
+            }
+            // Pausa acotada para no ocupar el CPU ni retrasar tb->stop()
+            escritos = d_anillo->esperar(d_leido, 100);
+            if (escritos == d_leido) {
+                if (!d_anillo->productor_vivo()) {
+                    if (!d_anillo->terminado()) {
+                        std::fprintf(stderr, "shm_ring_source: el productor de %s terminó sin avisar\n",
+                                     d_anillo->nombre().c_str());
+                    }
+                    return WORK_DONE;
+                }
+                return 0;
+            }
+        }
+
+        for (;;) {
+            if (escritos - d_leido > capacidad / 2) {
+                saltar(escritos - capacidad / 2);
+            }
+            const int n = static_cast<int>(std::min<uint64_t>(noutput_items, escritos - d_leido));
+            copiar(d_anillo->ver(d_leido), n, output_items);
+            if (d_anillo->vigente(d_leido)) {
+                marcar(output_items.size());
+                d_leido += n;
+                return n;
+            }
+            // El productor dio la vuelta mientras se copiaba
+            escritos = d_anillo->escritos();
+        }
+    }
+
+private:
+    void saltar(uint64_t nuevo) {
+        d_perdidas.fetch_add(nuevo - d_leido, std::memory_order_relaxed);
+        d_huecos.fetch_add(1, std::memory_order_relaxed);
+        d_hueco += nuevo - d_leido;
+        d_leido = nuevo;
+        d_marcar = true;
+    }
+
+    void copiar(const float* cuadros, int n, gr_vector_void_star& output_items) {
+        const int canales = d_anillo->canales();
+        if (canales == 1) {
+            std::memcpy(output_items[0], cuadros, n * sizeof(float));
+            return;
+        }
+        for (size_t s = 0; s < output_items.size(); s++) {
+            float* out = (float*)output_items[s];
+            const float* in = cuadros + d_primero + s;
+            for (int k = 0; k < n; k++) {
+                out[k] = in[k * canales];
+            }
+        }
+    }
+
+    void marcar(size_t salidas) {
+        if (!d_marcar) {
+            return;
+        }
+        for (size_t s = 0; s < salidas; s++) {
+            const uint64_t offset = nitems_written(s);
+            add_item_tag(s, offset, pmt::intern("shm_indice"), pmt::from_uint64(d_leido));
+            if (d_hueco > 0) {
+                add_item_tag(s, offset, pmt::intern("shm_perdidas"), pmt::from_uint64(d_hueco));
+            }
+        }
+        d_hueco = 0;
+        d_marcar = false;
+    }
+
+    std::shared_ptr<shm_ring> d_anillo;
+    const int d_primero;
+    const bool d_desde_el_inicio;
+    uint64_t d_leido = 0;      // índice del siguiente cuadro a leer
+    uint64_t d_hueco = 0;      // cuadros perdidos desde la última etiqueta
+    bool d_marcar = true;
+    std::atomic<uint64_t> d_perdidas{ 0 };
+    std::atomic<uint64_t> d_huecos{ 0 };
+};
+
+#endif // BLOQUES_SHM_RING_H
@@ -0,0 +1,230 @@
+// sliding_goertzel.h
+// DFT deslizante de entrada compleja para varias frecuencias a la vez.
+//
+// A diferencia de goertzel_fc, que entrega un valor por lote de 'len'
+// muestras (con ese mismo retardo), este bloque entrega cada 'salto' muestras
+// la DFT de las últimas 'ventana' muestras, para cada frecuencia f_b:
+//
+//     X_b[n] = (1/N) * sum_{m = n-N+1}^{n} x[m] e^{-j w_b m},   w_b = 2 pi f_b / fs
+//
+// La fase está referida al inicio del flujo (muestra 0) y no a cada ventana,
+// así que un tono estable en f_b da una fase constante; |X_b| es su amplitud.
+//
+// Costo O(1) por muestra y por frecuencia: cada salto se acumula en una suma
+// parcial (oscilador por recurrencia + multiplicación-acumulación) y la
+// ventana es la suma de las últimas N/salto sumas parciales. Los osciladores
+// se resiembran cada TRAMO muestras a partir del índice absoluto de la
+// muestra (fase en punto fijo de 64 bits), así que no se degradan y la
+// salida no depende de cómo el scheduler parta los buffers. Con
+// muestra_inicial el bloque puede empezar a la mitad de un flujo y dar las
+// mismas salidas (una vez llena la ventana) que el flujo completo. Con
+// AVX2/FMA cada instrucción avanza 8 frecuencias; sin AVX2 se usa el mismo
+// algoritmo en C++ escalar.
+//
+// Entrada: gr_complex a la tasa fs. Salida: un puerto gr_complex por
+// frecuencia, a la tasa fs/salto.
+
+#ifndef BLOQUES_SLIDING_GOERTZEL_H
+#define BLOQUES_SLIDING_GOERTZEL_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_decimator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SLIDING_GOERTZEL_X86 1
+#endif
+
+class sliding_goertzel : public gr::sync_decimator {
+public:
+    typedef std::shared_ptr<sliding_goertzel> sptr;
+
+    // frecuencias: en Hz, pueden ser negativas (ej. {100, -100})
+    // ventana: longitud N de la DFT en muestras (se redondea a múltiplo de salto)
+    // salto: muestras de entrada entre actualizaciones
+    // muestra_inicial: índice absoluto de la primera muestra de entrada
+    static sptr make(double samp_rate,
+                     const std::vector<double>& frecuencias,
+                     int ventana,
+                     int salto,
+                     uint64_t muestra_inicial = 0) {
+        return gnuradio::get_initial_sptr(
+            new sliding_goertzel(samp_rate, frecuencias, ventana, salto, muestra_inicial));
+    }
+
+    sliding_goertzel(double samp_rate,
+                     const std::vector<double>& frecuencias,
+                     int ventana,
+                     int salto,
+                     uint64_t muestra_inicial)
+        : gr::sync_decimator("sliding_goertzel",
+                             gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                             gr::io_signature::make(frecuencias.size(),
+                                                    frecuencias.size(),
+                                                    sizeof(gr_complex)),
+                             salto > 0 ? salto : 1),
+          d_nbins(frecuencias.size()),
+          d_carriles((frecuencias.size() + 7) / 8 * 8), // frecuencias redondeadas a múltiplo de 8
+          d_salto(salto),
+          d_bloques(std::max(1, static_cast<int>(std::lround(double(ventana) / salto)))),
+          d_muestra(muestra_inicial) {
+        if (frecuencias.empty() || salto < 1 || ventana < salto) {
+            throw std::invalid_argument(
+                "sliding_goertzel: se requiere al menos una frecuencia y 1 <= salto <= ventana");
+        }
+        // Los carriles de relleno tienen w = 0 y entrada ignorada
+        d_w.assign(d_carriles, 0.0);
+        d_incr.assign(d_carriles, 0);
+        for (int b = 0; b < d_nbins; b++) {
+            d_w[b] = 2.0 * M_PI * frecuencias[b] / samp_rate;
+            // -f/fs en fracciones de ciclo * 2^64
+            const double ciclos = -frecuencias[b] / samp_rate;
+            d_incr[b] = static_cast<uint64_t>(
+                static_cast<int64_t>(std::ldexp(ciclos - std::round(ciclos), 63))) << 1;
+        }
+        d_rot_re.resize(d_carriles);
+        d_rot_im.resize(d_carriles);
+        for (int b = 0; b < d_carriles; b++) {
+            d_rot_re[b] = std::cos(-d_w[b]);
+            d_rot_im[b] = std::sin(-d_w[b]);
+        }
+        d_osc_re.assign(d_carriles, 0.0f);
+        d_osc_im.assign(d_carriles, 0.0f);
+        d_acc_re.assign(d_carriles, 0.0f);
+        d_acc_im.assign(d_carriles, 0.0f);
+        d_parcial.assign(d_carriles, 0.0);
+        d_anillo.assign(d_bloques * d_carriles, 0.0);
+
+#ifdef SLIDING_GOERTZEL_X86
+        d_usar_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+
+    int ventana() const { return d_bloques * d_salto; }
+    int salto() const { return d_salto; }
+    bool usa_avx2() const { return d_usar_avx2; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override {
+        const gr_complex* in = (const gr_complex*)input_items[0];
+
+        for (int i = 0; i < noutput_items; i++) {
+            const gr_complex* x = in + i * d_salto;
+
+            for (int inicio = 0; inicio < d_salto; inicio += TRAMO) {
+                const int n = std::min(TRAMO, d_salto - inicio);
+
+                // Osciladores e^{-j w m} exactos al inicio del tramo
+                for (int b = 0; b < d_carriles; b++) {
+                    const uint64_t fase = d_muestra * d_incr[b];
+                    const double radianes = static_cast<int64_t>(fase) * (M_PI / 9223372036854775808.0);
+                    d_osc_re[b] = static_cast<float>(std::cos(radianes));
+                    d_osc_im[b] = static_cast<float>(std::sin(radianes));
+                }
+#ifdef SLIDING_GOERTZEL_X86
+                if (d_usar_avx2) {
+                    tramo_avx2(x + inicio, n);
+                } else
+#endif
+                {
+                    tramo_generico(x + inicio, n);
+                }
+                for (int b = 0; b < d_carriles; b++) {
+                    d_parcial[b] += std::complex<double>(d_acc_re[b], d_acc_im[b]);
+                }
+                d_muestra += n;
+            }
+
+            // Cerrar el salto: guardar la suma parcial y sumar la ventana
+            std::copy(d_parcial.begin(), d_parcial.end(), d_anillo.begin() + d_pos * d_carriles);
+            std::fill(d_parcial.begin(), d_parcial.end(), 0.0);
+            d_pos = (d_pos + 1) % d_bloques;
+            d_llenos = std::min(d_llenos + 1, d_bloques);
+
+            // Mientras la ventana se llena se normaliza por las muestras que hay.
+            // Se suma de la más antigua a la más reciente (d_pos apunta a la
+            // más antigua) para que el redondeo no dependa de la posición
+            const double escala = 1.0 / (double(d_llenos) * d_salto);
+            for (int b = 0; b < d_nbins; b++) {
+                std::complex<double> suma = 0.0;
+                for (int j = 0; j < d_bloques; j++) {
+                    suma += d_anillo[((d_pos + j) % d_bloques) * d_carriles + b];
+                }
+                ((gr_complex*)output_items[b])[i] = gr_complex(suma * escala);
+            }
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr int TRAMO = 256; // muestras entre resiembras del oscilador
+
+    // acc_b = sum x[m] * osc_b[m];  osc_b[m+1] = osc_b[m] * e^{-j w_b}
+    void tramo_generico(const gr_complex* x, int n) {
+        for (int b = 0; b < d_carriles; b++) {
+            float ore = d_osc_re[b], oim = d_osc_im[b];
+            float are = 0.0f, aim = 0.0f;
+            for (int m = 0; m < n; m++) {
+                const float xr = x[m].real(), xi = x[m].imag();
+                are += xr * ore - xi * oim;
+                aim += xr * oim + xi * ore;
+                const float t = ore * d_rot_re[b] - oim * d_rot_im[b];
+                oim = ore * d_rot_im[b] + oim * d_rot_re[b];
+                ore = t;
+            }
+            d_acc_re[b] = are;
+            d_acc_im[b] = aim;
+        }
+    }
+
+#ifdef SLIDING_GOERTZEL_X86
+    // 8 frecuencias por registro, con osciladores y acumuladores en registros
+    __attribute__((target("avx2,fma"))) void tramo_avx2(const gr_complex* x, int n) {
+        for (int c = 0; c < d_carriles; c += 8) {
+            const __m256 rre = _mm256_loadu_ps(&d_rot_re[c]);
+            const __m256 rim = _mm256_loadu_ps(&d_rot_im[c]);
+            __m256 ore = _mm256_loadu_ps(&d_osc_re[c]);
+            __m256 oim = _mm256_loadu_ps(&d_osc_im[c]);
+            __m256 are = _mm256_setzero_ps();
+            __m256 aim = _mm256_setzero_ps();
+            for (int m = 0; m < n; m++) {
+                const __m256 xr = _mm256_set1_ps(x[m].real());
+                const __m256 xi = _mm256_set1_ps(x[m].imag());
+                are = _mm256_fnmadd_ps(xi, oim, _mm256_fmadd_ps(xr, ore, are));
+                aim = _mm256_fmadd_ps(xi, ore, _mm256_fmadd_ps(xr, oim, aim));
+                const __m256 t = _mm256_fmsub_ps(ore, rre, _mm256_mul_ps(oim, rim));
+                oim = _mm256_fmadd_ps(ore, rim, _mm256_mul_ps(oim, rre));
+                ore = t;
+            }
+            _mm256_storeu_ps(&d_acc_re[c], are);
+            _mm256_storeu_ps(&d_acc_im[c], aim);
+        }
+    }
+#endif
+
+    const int d_nbins;
+    const int d_carriles;
+    const int d_salto;
+    const int d_bloques; // sumas parciales por ventana
+    std::vector<double> d_w;                     // rad/muestra por carril
+    std::vector<uint64_t> d_incr;                // -w/(2 pi) por muestra (2^64 = un ciclo)
+    uint64_t d_muestra;                          // índice absoluto de la siguiente muestra
+    std::vector<float> d_rot_re, d_rot_im;       // e^{-j w}
+    std::vector<float> d_osc_re, d_osc_im;       // oscilador al inicio del tramo
+    std::vector<float> d_acc_re, d_acc_im;       // suma del tramo actual
+    std::vector<std::complex<double>> d_parcial; // suma del salto actual
+    std::vector<std::complex<double>> d_anillo;  // sumas de los últimos saltos [bloque][carril]
+    int d_pos = 0;
+    int d_llenos = 0;
+    bool d_usar_avx2 = false;
+};
+
+#endif // BLOQUES_SLIDING_GOERTZEL_H
@@ -0,0 +1,184 @@
+// spsc_ring.h
+// Buffer circular sin bloqueos (lock-free) para un solo productor y un solo
+// consumidor (SPSC). Lo usan los bloques que deben sacar datos del hilo del
+// scheduler de GNU Radio sin hacer E/S ni reservar memoria dentro de work().
+//
+// spsc_frames lo usa para frames float de varios canales con huecos: lo que
+// no cabe se cuenta y se entrega después como un largo, no como ceros.
+
+#ifndef BLOQUES_SPSC_RING_H
+#define BLOQUES_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <typename T>
+class spsc_ring {
+public:
+    // La capacidad se redondea a la siguiente potencia de 2 para poder usar
+    // una máscara en lugar del operador módulo.
+    explicit spsc_ring(size_t capacidad) {
+        size_t n = 2;
+        while (n < capacidad) {
+            n <<= 1;
+        }
+        d_buffer.resize(n);
+        d_mascara = n - 1;
+    }
+
+    size_t capacidad() const { return d_buffer.size(); }
+
+    // Lado productor: copia hasta n elementos y regresa cuántos cupieron
+    size_t push(const T* datos, size_t n) {
+        const size_t cabeza = d_cabeza.load(std::memory_order_relaxed);
+        if (d_buffer.size() - (cabeza - d_cola_cache) < n) {
+            d_cola_cache = d_cola.load(std::memory_order_acquire);
+        }
+        const size_t libres = d_buffer.size() - (cabeza - d_cola_cache);
+        const size_t cuantos = n < libres ? n : libres;
+        for (size_t i = 0; i < cuantos; i++) {
+            d_buffer[(cabeza + i) & d_mascara] = datos[i];
+        }
+        d_cabeza.store(cabeza + cuantos, std::memory_order_release);
+        return cuantos;
+    }
+
+    bool push(const T& dato) { return push(&dato, 1) == 1; }
+
+    // Lado consumidor: saca hasta n elementos y regresa cuántos se leyeron
+    size_t pop(T* destino, size_t n) {
+        const size_t cola = d_cola.load(std::memory_order_relaxed);
+        if (d_cabeza_cache - cola < n) {
+            d_cabeza_cache = d_cabeza.load(std::memory_order_acquire);
+        }
+        const size_t disponibles = d_cabeza_cache - cola;
+        const size_t cuantos = n < disponibles ? n : disponibles;
+        for (size_t i = 0; i < cuantos; i++) {
+            destino[i] = d_buffer[(cola + i) & d_mascara];
+        }
+        d_cola.store(cola + cuantos, std::memory_order_release);
+        return cuantos;
+    }
+
+    // Número aproximado de elementos en espera (válido desde cualquier hilo)
+    size_t ocupados() const {
+        return d_cabeza.load(std::memory_order_acquire) -
+               d_cola.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> d_buffer;
+    size_t d_mascara;
+
+    // Índices en líneas de caché separadas para evitar false sharing
+    alignas(64) std::atomic<size_t> d_cabeza{ 0 }; // escrito por el productor
+    size_t d_cola_cache = 0;                      // copia local del productor
+    alignas(64) std::atomic<size_t> d_cola{ 0 };   // escrito por el consumidor
+    size_t d_cabeza_cache = 0;                    // copia local del consumidor
+};
+
+// Frames float intercalados de 'canales' valores, para sumideros cuyo work()
+// nunca debe esperar al hilo que escribe a disco. Se aceptan frames completos
+// o nada; lo que no cabe se acumula como hueco y, en cuanto vuelve a caber
+// un bloque, el hueco pasa al consumidor como una marca (posición y largo) en
+// un segundo buffer. Así el hueco no ocupa lugar en el buffer de datos por
+// largo que sea, y el consumidor lo escribe como ceros para que los índices
+// de muestra sigan siendo exactos.
+class spsc_frames {
+public:
+    static constexpr size_t LOTE = 4096; // frames por copia al buffer
+
+    spsc_frames(int canales, size_t capacidad)
+        : d_canales(canales), d_ring(capacidad * canales), d_marcas(64), d_intercalado(LOTE * canales) {}
+
+    int canales() const { return d_canales; }
+
+    // Frames en espera (válido desde cualquier hilo)
+    size_t ocupados() const { return d_ring.ocupados() / d_canales; }
+
+    // Lado productor: intercala n frames de los canales entrada[0..canales-1].
+    // Regresa false si no cupieron; en ese caso pasan a ser parte del hueco.
+    bool escribir(const void* const* entrada, uint64_t n) {
+        const size_t libres = (d_ring.capacidad() - d_ring.ocupados()) / d_canales;
+        if (n > libres || (d_hueco > 0 && !marcar())) {
+            d_hueco += n;
+            return false;
+        }
+        for (uint64_t inicio = 0; inicio < n; inicio += LOTE) {
+            const size_t k = std::min<uint64_t>(LOTE, n - inicio);
+            for (int c = 0; c < d_canales; c++) {
+                const float* in = static_cast<const float*>(entrada[c]) + inicio;
+                for (size_t i = 0; i < k; i++) {
+                    d_intercalado[i * d_canales + c] = in[i];
+                }
+            }
+            d_ring.push(d_intercalado.data(), k * d_canales);
+        }
+        d_escritos += n;
+        return true;
+    }
+
+    // Lado productor, al terminar el flujo: entrega el hueco pendiente para
+    // que el archivo tenga todas las muestras recibidas
+    void terminar() {
+        if (d_hueco > 0) {
+            marcar();
+        }
+    }
+
+    // Lado consumidor: copia hasta max frames intercalados y regresa cuántos.
+    // Si en la posición actual hay un hueco regresa 0 y su largo en 'hueco'.
+    size_t leer(float* destino, size_t max, uint64_t& hueco) {
+        hueco = 0;
+        // Los datos se miden antes de ver las marcas: una marca que llegue
+        // después queda en o después de todo lo medido
+        size_t disponibles = d_ring.ocupados() / d_canales;
+        if (!d_hay_marca) {
+            d_hay_marca = d_marcas.pop(&d_marca, 1) == 1;
+        }
+        if (d_hay_marca) {
+            if (d_marca.posicion == d_leidos) {
+                hueco = d_marca.frames;
+                d_hay_marca = false;
+                return 0;
+            }
+            disponibles = std::min<uint64_t>(disponibles, d_marca.posicion - d_leidos);
+        }
+        const size_t n = d_ring.pop(destino, std::min(max, disponibles) * d_canales) / d_canales;
+        d_leidos += n;
+        return n;
+    }
+
+private:
+    struct marca {
+        uint64_t posicion; // frames de datos antes del hueco
+        uint64_t frames;   // largo del hueco
+    };
+
+    bool marcar() {
+        if (!d_marcas.push(marca{ d_escritos, d_hueco })) {
+            return false;
+        }
+        d_hueco = 0;
+        return true;
+    }
+
+    const int d_canales;
+    spsc_ring<float> d_ring;
+    spsc_ring<marca> d_marcas;
+
+    // Lado productor
+    std::vector<float> d_intercalado;
+    uint64_t d_escritos = 0; // frames de datos en el buffer desde el inicio
+    uint64_t d_hueco = 0;    // frames perdidos aún sin marca
+
+    // Lado consumidor
+    uint64_t d_leidos = 0;
+    marca d_marca = {};
+    bool d_hay_marca = false;
+};
+
+#endif // BLOQUES_SPSC_RING_H
@@ -0,0 +1,188 @@
+// wav_file.h
+// Lector de archivos WAV proyectado en memoria, con acceso aleatorio.
+//
+// wavfile_source solo lee en orden; para procesar un archivo por bloques en
+// paralelo cada hilo necesita leer su propio tramo. La conversión a float es
+// la misma que hace libsndfile (y por lo tanto wavfile_source):
+//   PCM 8 bits: (x - 128) / 128      PCM 16: x / 2^15
+//   PCM 24:     x / 2^23             PCM 32: x / 2^31
+//   float/double: sin cambio
+// Soporta WAVE_FORMAT_PCM, WAVE_FORMAT_IEEE_FLOAT y WAVE_FORMAT_EXTENSIBLE,
+// con cabecera RIFF o RF64.
+
+#ifndef BLOQUES_WAV_FILE_H
+#define BLOQUES_WAV_FILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class wav_file {
+public:
+    explicit wav_file(const std::string& archivo) {
+        d_fd = ::open(archivo.c_str(), O_RDONLY);
+        if (d_fd < 0) {
+            throw std::runtime_error("wav_file: no se pudo abrir " + archivo);
+        }
+        struct stat st;
+        if (::fstat(d_fd, &st) != 0 || st.st_size < 12) {
+            cerrar();
+            throw std::runtime_error("wav_file: archivo demasiado corto: " + archivo);
+        }
+        d_tam = st.st_size;
+        void* p = ::mmap(nullptr, d_tam, PROT_READ, MAP_SHARED, d_fd, 0);
+        if (p == MAP_FAILED) {
+            cerrar();
+            throw std::runtime_error("wav_file: mmap falló para " + archivo);
+        }
+        d_mapa = static_cast<const uint8_t*>(p);
+
+        try {
+            leer_cabecera();
+        } catch (...) {
+            cerrar();
+            throw;
+        }
+    }
+
+    ~wav_file() { cerrar(); }
+
+    wav_file(const wav_file&) = delete;
+    wav_file& operator=(const wav_file&) = delete;
+
+    int sample_rate() const { return d_fs; }
+    int canales() const { return d_canales; }
+    int bits() const { return d_bits; }
+    bool es_float() const { return d_float; }
+
+    // Muestras por canal
+    uint64_t num_frames() const { return d_frames; }
+
+    // Convierte n muestras del canal a partir de la muestra 'inicio'
+    void leer(int canal, uint64_t inicio, uint64_t n, float* destino) const {
+        if (canal < 0 || canal >= d_canales || inicio + n > d_frames) {
+            throw std::out_of_range("wav_file: lectura fuera del archivo");
+        }
+        const size_t paso = size_t(d_canales) * d_bytes;
+        const uint8_t* p = d_datos + inicio * paso + size_t(canal) * d_bytes;
+
+        for (uint64_t i = 0; i < n; i++, p += paso) {
+            if (d_float) {
+                if (d_bytes == 4) {
+                    std::memcpy(&destino[i], p, 4);
+                } else {
+                    double x;
+                    std::memcpy(&x, p, 8);
+                    destino[i] = static_cast<float>(x);
+                }
+                continue;
+            }
+            switch (d_bytes) {
+            case 1:
+                destino[i] = (int(p[0]) - 128) * (1.0f / 128);
+                break;
+            case 2: {
+                int16_t x;
+                std::memcpy(&x, p, 2);
+                destino[i] = x * (1.0f / 32768);
+                break;
+            }
+            case 3: {
+                const int32_t x = int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 |
+                                          uint32_t(p[2]) << 24) >> 8;
+                destino[i] = x * (1.0f / 8388608);
+                break;
+            }
+            default: {
+                int32_t x;
+                std::memcpy(&x, p, 4);
+                destino[i] = static_cast<float>(x) * (1.0f / 2147483648.0f);
+                break;
+            }
+            }
+        }
+    }
+
+private:
+    static uint16_t u16(const uint8_t* p) { return uint16_t(p[0] | p[1] << 8); }
+    static uint32_t u32(const uint8_t* p) { return u16(p) | uint32_t(u16(p + 2)) << 16; }
+    static uint64_t u64(const uint8_t* p) { return u32(p) | uint64_t(u32(p + 4)) << 32; }
+
+    void leer_cabecera() {
+        const bool rf64 = std::memcmp(d_mapa, "RF64", 4) == 0;
+        if ((!rf64 && std::memcmp(d_mapa, "RIFF", 4) != 0) || std::memcmp(d_mapa + 8, "WAVE", 4) != 0) {
+            throw std::runtime_error("wav_file: no es un archivo WAV");
+        }
+
+        uint64_t tam_datos_rf64 = 0;
+        bool con_formato = false;
+        size_t pos = 12;
+        while (pos + 8 <= d_tam) {
+            const uint8_t* id = d_mapa + pos;
+            const uint64_t tam = u32(id + 4);
+            const uint8_t* cuerpo = id + 8;
+
+            if (std::memcmp(id, "ds64", 4) == 0 && tam >= 16) {
+                tam_datos_rf64 = u64(cuerpo + 8);
+            } else if (std::memcmp(id, "fmt ", 4) == 0 && tam >= 16) {
+                uint16_t formato = u16(cuerpo);
+                d_canales = u16(cuerpo + 2);
+                d_fs = u32(cuerpo + 4);
+                d_bits = u16(cuerpo + 14);
+                if (formato == 0xFFFE && tam >= 26) {
+                    formato = u16(cuerpo + 24); // subformato de WAVE_FORMAT_EXTENSIBLE
+                }
+                if (formato != 1 && formato != 3) {
+                    throw std::runtime_error("wav_file: solo se soporta PCM o float");
+                }
+                d_float = formato == 3;
+                d_bytes = (d_bits + 7) / 8;
+                con_formato = true;
+            } else if (std::memcmp(id, "data", 4) == 0) {
+                if (!con_formato || d_canales == 0 || d_bytes == 0) {
+                    throw std::runtime_error("wav_file: falta el bloque fmt antes de data");
+                }
+                uint64_t tam_datos = (rf64 && tam == 0xFFFFFFFF) ? tam_datos_rf64 : tam;
+                // Archivos truncados (grabación interrumpida): usar lo que haya
+                if (pos + 8 + tam_datos > d_tam) {
+                    tam_datos = d_tam - pos - 8;
+                }
+                d_datos = cuerpo;
+                d_frames = tam_datos / (uint64_t(d_canales) * d_bytes);
+                return;
+            }
+            pos += 8 + tam + (tam & 1); // los bloques se alinean a 2 bytes
+        }
+        throw std::runtime_error("wav_file: no se encontró el bloque data");
+    }
+
+    void cerrar() {
+        if (d_mapa) {
+            ::munmap(const_cast<uint8_t*>(d_mapa), d_tam);
+            d_mapa = nullptr;
+        }
+        if (d_fd >= 0) {
+            ::close(d_fd);
+            d_fd = -1;
+        }
+    }
+
+    int d_fd = -1;
+    size_t d_tam = 0;
+    const uint8_t* d_mapa = nullptr;
+    const uint8_t* d_datos = nullptr;
+    int d_fs = 0;
+    int d_canales = 0;
+    int d_bits = 0;
+    int d_bytes = 0;
+    bool d_float = false;
+    uint64_t d_frames = 0;
+};
+
+#endif // BLOQUES_WAV_FILE_H
@@ -0,0 +1,460 @@
+// wav_segment_sink.h
+// Sumidero para grabaciones largas (24/7): escribe la señal en archivos WAV
+// consecutivos de un número fijo de muestras, sin hacer E/S en el hilo del
+// scheduler.
+//
+// work() solo intercala los canales y los copia a un buffer circular SPSC de
+// varios segundos; un hilo escritor convierte a PCM o float y escribe con
+// pwrite en bloques grandes. Así una pausa del disco se absorbe en el buffer
+// y no frena a la tarjeta de sonido (que perdería muestras por overrun). Si
+// aun así el buffer se llena, las muestras que no caben se escriben como
+// ceros al reanudar (spsc_frames pasa el hueco como un largo, así que no
+// importa cuánto dure la pausa), para que los índices de muestra sigan
+// siendo exactos; descartados() las cuenta.
+//
+// Un error de disco (lleno, EIO) detiene al escritor: work() lo reporta en
+// stderr y termina el flujo, y error() regresa el mensaje.
+//
+// Cada segmento <prefijo>_NNNNNN.wav:
+//   * se preasigna completo con posix_fallocate al abrirlo,
+//   * empieza exactamente en la muestra muestras_por_segmento * NNNNNN,
+//   * lleva un bloque bext (Broadcast WAV) con la muestra inicial en la
+//     descripción y la hora UTC de inicio (fecha, hora y TimeReference),
+//   * tiene los datos alineados a 4096 bytes y espacio reservado para el
+//     bloque ds64: si pasa de 4 GB se cierra como RF64.
+// La cabecera se actualiza después de cada escritura, así que tras un corte
+// de energía el archivo es legible hasta la última escritura. Además se
+// lleva un índice <prefijo>_segmentos.csv con archivo, muestra inicial,
+// número de muestras y hora de inicio de cada segmento.
+//
+// Entrada: un puerto float por canal (como la salida de audio::source).
+
+#ifndef BLOQUES_WAV_SEGMENT_SINK_H
+#define BLOQUES_WAV_SEGMENT_SINK_H
+
+#include "spsc_ring.h"
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+class wav_segment_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<wav_segment_sink> sptr;
+
+    enum class formato { PCM16, PCM24, FLOAT };
+
+    // prefijo: nombre de los archivos sin "_NNNNNN.wav"
+    // muestras_por_segmento: muestras por canal de cada archivo (0: un solo archivo)
+    // muestras_totales: el flujo termina al recibirlas (0: sin límite)
+    // capacidad: tamaño del buffer circular en muestras por canal
+    static sptr make(const std::string& prefijo,
+                     int canales,
+                     double samp_rate,
+                     uint64_t muestras_por_segmento,
+                     formato fmt = formato::PCM16,
+                     uint64_t muestras_totales = 0,
+                     size_t capacidad = 1 << 21) {
+        return gnuradio::get_initial_sptr(new wav_segment_sink(
+            prefijo, canales, samp_rate, muestras_por_segmento, fmt, muestras_totales, capacidad));
+    }
+
+    wav_segment_sink(const std::string& prefijo,
+                     int canales,
+                     double samp_rate,
+                     uint64_t muestras_por_segmento,
+                     formato fmt,
+                     uint64_t muestras_totales,
+                     size_t capacidad)
+        : gr::sync_block("wav_segment_sink",
+                         gr::io_signature::make(canales, canales, sizeof(float)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_prefijo(prefijo),
+          d_canales(canales),
+          d_samp_rate(samp_rate),
+          d_por_segmento(muestras_por_segmento),
+          d_formato(fmt),
+          d_bytes_muestra(fmt == formato::PCM16 ? 2 : fmt == formato::PCM24 ? 3 : 4),
+          d_bytes_frame(size_t(canales) * d_bytes_muestra),
+          d_totales(muestras_totales),
+          d_frames(canales, capacidad) {
+        if (canales < 1 || samp_rate <= 0) {
+            throw std::invalid_argument("wav_segment_sink: canales y samp_rate deben ser positivos");
+        }
+        d_buffer.resize(TAM_BUFFER / d_bytes_frame * d_bytes_frame);
+    }
+
+    ~wav_segment_sink() override { detener_escritor(); }
+
+    // Muestras por canal reemplazadas por ceros porque el buffer estaba lleno
+    uint64_t descartados() const { return d_descartados.load(std::memory_order_relaxed); }
+
+    // Ocupación máxima que alcanzó el buffer, en muestras por canal
+    size_t ocupacion_maxima() const { return d_ocupacion_maxima.load(std::memory_order_relaxed); }
+
+    // Segmentos abiertos hasta ahora
+    unsigned segmentos() const { return d_segmento.load(std::memory_order_relaxed); }
+
+    // Error que detuvo al escritor, o vacío
+    std::string error() const { return d_fallo.load(std::memory_order_acquire) ? d_error : std::string(); }
+
+    bool start() override {
+        // La hora de la muestra 0 se toma al arrancar el flujo
+        d_inicio_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+        const std::string indice = d_prefijo + "_segmentos.csv";
+        d_indice = std::fopen(indice.c_str(), "w");
+        if (!d_indice) {
+            throw std::runtime_error("wav_segment_sink: no se pudo abrir " + indice);
+        }
+        std::fputs("archivo,muestra_inicial,muestras,inicio_utc_ns\n", d_indice);
+
+        d_corriendo = true;
+        d_escritor = std::thread(&wav_segment_sink::escritor, this);
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        d_frames.terminar();
+        detener_escritor();
+        return gr::sync_block::stop();
+    }
+
+    // Solo intercala y copia al buffer: sin E/S ni reservas de memoria
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        if (d_fallo.load(std::memory_order_acquire)) {
+            std::fprintf(stderr, "%s\n", d_error.c_str());
+            return WORK_DONE;
+        }
+        uint64_t n = noutput_items;
+        if (d_totales > 0) {
+            n = std::min(n, d_totales - d_recibidas);
+        }
+
+        // Frames completos o nada; lo que no cabe se escribe como ceros después
+        if (!d_frames.escribir(input_items.data(), n)) {
+            d_descartados.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        const size_t ocupados = d_frames.ocupados();
+        if (ocupados > d_ocupacion_maxima.load(std::memory_order_relaxed)) {
+            d_ocupacion_maxima.store(ocupados, std::memory_order_relaxed);
+        }
+
+        d_recibidas += n;
+        if (d_totales > 0 && d_recibidas >= d_totales) {
+            return WORK_DONE;
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr size_t LOTE = spsc_frames::LOTE; // frames por lectura del buffer
+    static constexpr size_t TAM_BUFFER = 4 << 20;   // 4 MiB por escritura
+    static constexpr uint64_t TRAMO = 64ull << 20;  // preasignación sin tamaño de segmento
+    static constexpr size_t TAM_CABECERA = 4096;    // los datos empiezan aquí
+    static constexpr uint64_t LIMITE_RIFF = 0xFFFFFFFFull;
+
+    void escritor() {
+        std::vector<float> lote(LOTE * d_canales);
+        const std::vector<float> ceros(LOTE * d_canales, 0.0f);
+
+        try {
+            bool ultimo_pase = false;
+            while (!ultimo_pase) {
+                // Se lee la bandera antes de vaciar para no perder el último lote
+                ultimo_pase = !d_corriendo.load(std::memory_order_acquire);
+                size_t n;
+                uint64_t hueco;
+                while ((n = d_frames.leer(lote.data(), LOTE, hueco)) > 0 || hueco > 0) {
+                    agregar(lote.data(), n);
+                    for (; hueco > 0; hueco -= std::min<uint64_t>(hueco, LOTE)) {
+                        agregar(ceros.data(), std::min<uint64_t>(hueco, LOTE));
+                    }
+                }
+                if (!ultimo_pase) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            }
+            cerrar_segmento();
+        } catch (const std::exception& e) {
+            // Sin excepciones fuera del hilo (std::terminate): work() reporta
+            if (d_fd >= 0) {
+                ::close(d_fd);
+                d_fd = -1;
+            }
+            d_error = e.what();
+            d_fallo.store(true, std::memory_order_release);
+        }
+    }
+
+    // Convierte frames intercalados al formato del archivo, rotando segmentos
+    void agregar(const float* x, size_t frames) {
+        while (frames > 0) {
+            if (d_fd < 0) {
+                abrir_segmento();
+            }
+            size_t k = std::min(frames, (d_buffer.size() - d_llenado) / d_bytes_frame);
+            if (d_por_segmento > 0) {
+                k = std::min<uint64_t>(k, d_por_segmento - d_frames_segmento);
+            }
+            convertir(x, k * d_canales, d_buffer.data() + d_llenado);
+            d_llenado += k * d_bytes_frame;
+            d_frames_segmento += k;
+            x += k * d_canales;
+            frames -= k;
+
+            if (d_llenado == d_buffer.size()) {
+                vaciar();
+            }
+            if (d_por_segmento > 0 && d_frames_segmento == d_por_segmento) {
+                cerrar_segmento();
+            }
+        }
+    }
+
+    // Misma escala que libsndfile (y por lo tanto wavfile_sink)
+    void convertir(const float* x, size_t n, uint8_t* destino) const {
+        switch (d_formato) {
+        case formato::PCM16:
+            for (size_t i = 0; i < n; i++) {
+                const int16_t v = static_cast<int16_t>(
+                    std::lrint(std::min(1.0f, std::max(-1.0f, x[i])) * 32767.0f));
+                std::memcpy(destino + 2 * i, &v, 2);
+            }
+            break;
+        case formato::PCM24:
+            for (size_t i = 0; i < n; i++) {
+                const int32_t v = static_cast<int32_t>(
+                    std::lrint(std::min(1.0f, std::max(-1.0f, x[i])) * 8388607.0f));
+                destino[3 * i] = uint8_t(v);
+                destino[3 * i + 1] = uint8_t(v >> 8);
+                destino[3 * i + 2] = uint8_t(v >> 16);
+            }
+            break;
+        case formato::FLOAT:
+            std::memcpy(destino, x, n * sizeof(float));
+            break;
+        }
+    }
+
+    void abrir_segmento() {
+        char nombre[32];
+        std::snprintf(nombre, sizeof(nombre), "_%06u.wav", d_segmento.load());
+        d_archivo = d_prefijo + nombre;
+        d_fd = ::open(d_archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (d_fd < 0) {
+            throw std::runtime_error("wav_segment_sink: no se pudo abrir " + d_archivo + ": " +
+                                     std::strerror(errno));
+        }
+        d_muestra_segmento = d_muestras_escritas;
+        d_frames_segmento = 0;
+        d_bytes_datos = 0;
+
+        // Preasignar el segmento completo si se conoce su tamaño
+        d_reservado = TAM_CABECERA + d_por_segmento * d_bytes_frame;
+        if (d_por_segmento > 0) {
+            preasignar();
+        }
+        escribir_cabecera();
+    }
+
+    // Un disco lleno se detecta aquí y no a la mitad del segmento; si el
+    // sistema de archivos no preasigna, se sigue sin preasignar
+    void preasignar() {
+        const int r = ::posix_fallocate(d_fd, 0, d_reservado);
+        if (r != 0 && r != EOPNOTSUPP && r != ENOSYS && r != EINVAL) {
+            throw std::runtime_error("wav_segment_sink: no se pudo preasignar " + d_archivo + ": " +
+                                     std::strerror(r));
+        }
+    }
+
+    void vaciar() {
+        if (d_llenado == 0) {
+            return;
+        }
+        const uint64_t offset = TAM_CABECERA + d_bytes_datos;
+        if (offset + d_llenado > d_reservado) {
+            d_reservado = offset + d_llenado + TRAMO;
+            preasignar();
+        }
+        size_t hecho = 0;
+        while (hecho < d_llenado) {
+            const ssize_t r = ::pwrite(d_fd, d_buffer.data() + hecho, d_llenado - hecho, offset + hecho);
+            if (r <= 0) {
+                throw std::runtime_error("wav_segment_sink: error al escribir " + d_archivo + ": " +
+                                         std::strerror(r < 0 ? errno : ENOSPC));
+            }
+            hecho += r;
+        }
+        d_bytes_datos += d_llenado;
+        d_muestras_escritas += d_llenado / d_bytes_frame;
+        d_llenado = 0;
+        escribir_cabecera();
+    }
+
+    void cerrar_segmento() {
+        if (d_fd < 0) {
+            return;
+        }
+        vaciar();
+        // Quitar la preasignación sobrante (más el byte de relleno de RIFF)
+        if (::ftruncate(d_fd, TAM_CABECERA + d_bytes_datos + (d_bytes_datos & 1)) != 0) {
+            std::perror("wav_segment_sink: ftruncate");
+        }
+        escribir_cabecera();
+        ::close(d_fd);
+        d_fd = -1;
+
+        std::fprintf(d_indice, "%s,%llu,%llu,%lld\n", d_archivo.c_str(),
+                     (unsigned long long)d_muestra_segmento,
+                     (unsigned long long)d_frames_segmento,
+                     (long long)inicio_segmento_ns());
+        std::fflush(d_indice);
+        d_segmento++;
+    }
+
+    int64_t inicio_segmento_ns() const {
+        return d_inicio_ns + static_cast<int64_t>(std::llround(d_muestra_segmento * 1e9 / d_samp_rate));
+    }
+
+    // RIFF/RF64 + ds64 (o JUNK) + fmt + bext + JUNK de relleno + data en 4096
+    void escribir_cabecera() {
+        uint8_t c[TAM_CABECERA] = { 0 };
+        const uint64_t tam_riff = TAM_CABECERA - 8 + d_bytes_datos + (d_bytes_datos & 1);
+        const bool rf64 = tam_riff > LIMITE_RIFF;
+
+        std::memcpy(c, rf64 ? "RF64" : "RIFF", 4);
+        u32(c + 4, rf64 ? LIMITE_RIFF : tam_riff);
+        std::memcpy(c + 8, "WAVE", 4);
+
+        // ds64: tamaño RIFF, tamaño de datos, número de muestras, tabla vacía
+        std::memcpy(c + 12, rf64 ? "ds64" : "JUNK", 4);
+        u32(c + 16, 28);
+        if (rf64) {
+            u64(c + 20, tam_riff);
+            u64(c + 28, d_bytes_datos);
+            u64(c + 36, d_bytes_datos / d_bytes_frame);
+        }
+
+        std::memcpy(c + 48, "fmt ", 4);
+        u32(c + 52, 16);
+        u16(c + 56, d_formato == formato::FLOAT ? 3 : 1);
+        u16(c + 58, d_canales);
+        u32(c + 60, static_cast<uint32_t>(std::lround(d_samp_rate)));
+        u32(c + 64, static_cast<uint32_t>(std::lround(d_samp_rate)) * d_bytes_frame);
+        u16(c + 68, d_bytes_frame);
+        u16(c + 70, d_bytes_muestra * 8);
+
+        // bext (versión 1): descripción, originador, fecha y hora UTC del
+        // inicio del segmento y TimeReference en muestras desde medianoche
+        std::memcpy(c + 72, "bext", 4);
+        u32(c + 76, 602);
+        uint8_t* b = c + 80;
+        const int64_t ns = inicio_segmento_ns();
+        const std::time_t segundos = ns / 1000000000;
+        std::tm utc;
+        gmtime_r(&segundos, &utc);
+        std::snprintf(reinterpret_cast<char*>(b), 256, "muestra_inicial=%llu fs=%g segmento=%u",
+                      (unsigned long long)d_muestra_segmento, d_samp_rate, d_segmento.load());
+        std::strncpy(reinterpret_cast<char*>(b + 256), "wav_segment_sink", 32);
+        char fecha[16], hora[16];
+        std::strftime(fecha, sizeof(fecha), "%Y-%m-%d", &utc);
+        std::strftime(hora, sizeof(hora), "%H:%M:%S", &utc);
+        std::memcpy(b + 320, fecha, 10);
+        std::memcpy(b + 330, hora, 8);
+        const int64_t ns_dia = ns % 86400000000000ll;
+        u64(b + 338, static_cast<uint64_t>(std::llround(ns_dia * 1e-9 * d_samp_rate)));
+        u16(b + 346, 1);
+
+        // Relleno para que los datos empiecen en TAM_CABECERA
+        std::memcpy(c + 682, "JUNK", 4);
+        u32(c + 686, TAM_CABECERA - 8 - 690);
+
+        std::memcpy(c + TAM_CABECERA - 8, "data", 4);
+        u32(c + TAM_CABECERA - 4, rf64 ? LIMITE_RIFF : d_bytes_datos);
+
+        if (::pwrite(d_fd, c, sizeof(c), 0) != static_cast<ssize_t>(sizeof(c))) {
+            throw std::runtime_error("wav_segment_sink: error al escribir la cabecera de " + d_archivo);
+        }
+    }
+
+    static void u16(uint8_t* p, uint32_t v) {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+    }
+    static void u32(uint8_t* p, uint64_t v) {
+        u16(p, v & 0xFFFF);
+        u16(p + 2, (v >> 16) & 0xFFFF);
+    }
+    static void u64(uint8_t* p, uint64_t v) {
+        u32(p, v & 0xFFFFFFFF);
+        u32(p + 4, v >> 32);
+    }
+
+    void detener_escritor() {
+        d_corriendo = false;
+        if (d_escritor.joinable()) {
+            d_escritor.join();
+        }
+        if (d_indice) {
+            std::fclose(d_indice);
+            d_indice = nullptr;
+        }
+    }
+
+    const std::string d_prefijo;
+    const int d_canales;
+    const double d_samp_rate;
+    const uint64_t d_por_segmento;
+    const formato d_formato;
+    const unsigned d_bytes_muestra;
+    const size_t d_bytes_frame;
+    const uint64_t d_totales;
+
+    // Lado del scheduler
+    spsc_frames d_frames;
+    uint64_t d_recibidas = 0; // muestras por canal aceptadas por work()
+    std::atomic<uint64_t> d_descartados{ 0 };
+    std::atomic<size_t> d_ocupacion_maxima{ 0 };
+
+    // Lado del escritor
+    std::atomic<bool> d_corriendo{ false };
+    std::atomic<bool> d_fallo{ false };
+    std::string d_error; // se escribe antes de d_fallo
+    std::thread d_escritor;
+    std::FILE* d_indice = nullptr;
+    int64_t d_inicio_ns = 0;
+    std::atomic<unsigned> d_segmento{ 0 };
+    std::string d_archivo;
+    int d_fd = -1;
+    std::vector<uint8_t> d_buffer;
+    size_t d_llenado = 0;               // bytes en el buffer
+    uint64_t d_bytes_datos = 0;         // bytes de datos del segmento ya en disco
+    uint64_t d_reservado = 0;           // bytes preasignados del segmento
+    uint64_t d_frames_segmento = 0;     // muestras por canal en el segmento (incluye el buffer)
+    uint64_t d_muestra_segmento = 0;    // índice de la primera muestra del segmento
+    uint64_t d_muestras_escritas = 0;   // muestras por canal ya en disco, en total
+};
+
+#endif // BLOQUES_WAV_SEGMENT_SINK_H
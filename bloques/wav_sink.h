@@ -0,0 +1,615 @@
+// wav_sink.h
+// Sumidero WAV/RF64 de un solo archivo para escribir horas de señal a la
+// velocidad del disco (msk_wav_generator, audio_recorder).
+//
+// wavfile_sink convierte a PCM por libsndfile en lotes pequeños dentro de
+// work(). Aquí work() convierte directamente al buffer de escritura (con
+// AVX2: escala, dither, recorte y redondeo de 8 muestras por instrucción) y
+// un hilo escritor hace pwrite de buffers completos de unos 4 MiB, alineados
+// a 4096 bytes igual que su posición en el archivo. Con 'buffers' = 2 es un
+// doble buffer: mientras uno se escribe, el otro se llena. Si el disco no
+// alcanza, work() espera a que se libere un buffer (el flujo va a la
+// velocidad del disco y no se pierden muestras); esperas() cuenta esas veces.
+//
+// Formatos: PCM de 16, 24 o 32 bits con la escala de libsndfile (±1.0 ->
+// ±32767, ...) o float de 32 bits. Con dither se suma ruido triangular
+// (TPDF) de ±1 LSB antes de redondear, de un generador xorshift32 por carril
+// que da la misma secuencia con o sin AVX2.
+//
+// El archivo tiene la misma cabecera de 4096 bytes que wav_segment_sink
+// (espacio para ds64: pasa a RF64 si supera 4 GB) y la cabecera se
+// reescribe al cerrar y cada 'checkpoint' segundos: si para entonces el
+// buffer actual no se ha llenado, work() entrega al escritor lo que lleva
+// (hasta un múltiplo de 4096 bytes y de un frame, para que las escrituras
+// sigan alineadas; el resto pasa al buffer siguiente). Si el programa se
+// cae, el archivo es válido hasta el último checkpoint.
+//
+// Un error de escritura no detiene al proceso: el escritor lo guarda y
+// sigue liberando buffers, work() lo reporta en stderr y termina el flujo,
+// y error() regresa el mensaje.
+//
+// Entrada: un puerto float por canal.
+
+#ifndef BLOQUES_WAV_SINK_H
+#define BLOQUES_WAV_SINK_H
+
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define WAV_SINK_X86 1
+#endif
+
+class wav_sink : public gr::sync_block {
+public:
+    typedef std::shared_ptr<wav_sink> sptr;
+
+    enum class formato { PCM16, PCM24, PCM32, FLOAT };
+
+    // archivo: nombre del WAV
+    // dither: TPDF de ±1 LSB (se ignora en FLOAT)
+    // muestras_totales: el flujo termina al recibirlas (0: sin límite)
+    // buffers: número de buffers de ~4 MiB entre work() y el escritor (>= 2)
+    // checkpoint: segundos entre actualizaciones de la cabecera
+    static sptr make(const std::string& archivo,
+                     int canales,
+                     double samp_rate,
+                     formato fmt = formato::PCM16,
+                     bool dither = false,
+                     uint64_t muestras_totales = 0,
+                     int buffers = 2,
+                     double checkpoint = 1.0) {
+        return gnuradio::get_initial_sptr(new wav_sink(
+            archivo, canales, samp_rate, fmt, dither, muestras_totales, buffers, checkpoint));
+    }
+
+    wav_sink(const std::string& archivo,
+             int canales,
+             double samp_rate,
+             formato fmt,
+             bool dither,
+             uint64_t muestras_totales,
+             int buffers,
+             double checkpoint)
+        : gr::sync_block("wav_sink",
+                         gr::io_signature::make(canales, canales, sizeof(float)),
+                         gr::io_signature::make(0, 0, 0)),
+          d_archivo(archivo),
+          d_canales(canales),
+          d_samp_rate(samp_rate),
+          d_formato(fmt),
+          d_dither(dither && fmt != formato::FLOAT),
+          d_bytes_muestra(fmt == formato::PCM16 ? 2 : fmt == formato::PCM24 ? 3 : 4),
+          d_bytes_frame(size_t(canales) * d_bytes_muestra),
+          d_totales(muestras_totales),
+          d_checkpoint(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(checkpoint))) {
+        if (canales < 1 || samp_rate <= 0) {
+            throw std::invalid_argument("wav_sink: canales y samp_rate deben ser positivos");
+        }
+        if (buffers < 2) {
+            throw std::invalid_argument("wav_sink: se requieren al menos 2 buffers");
+        }
+        // Múltiplo de 4096 y del tamaño de un frame, para que cada escritura
+        // empiece alineada y con frames completos
+        d_unidad = TAM_PAGINA / std::gcd(TAM_PAGINA, d_bytes_frame) * d_bytes_frame;
+        d_tam_buffer = std::max<size_t>(1, TAM_BUFFER / d_unidad) * d_unidad;
+        for (int i = 0; i < buffers; i++) {
+            d_memoria.emplace_back(static_cast<uint8_t*>(std::aligned_alloc(TAM_PAGINA, d_tam_buffer)));
+            if (!d_memoria.back()) {
+                throw std::bad_alloc();
+            }
+            d_libres.push_back(d_memoria.back().get());
+        }
+        if (canales > 1) {
+            d_intercalado.resize(LOTE * canales);
+        }
+        for (int j = 0; j < 8; j++) {
+            d_azar[j] = 0x9e3779b9u * (j + 1);
+        }
+#ifdef WAV_SINK_X86
+        d_usar_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    ~wav_sink() override { detener_escritor(); }
+
+    // Frames por canal ya escritos en disco
+    uint64_t muestras_escritas() const { return d_escritas.load(std::memory_order_relaxed); }
+
+    // Veces que work() esperó a que el escritor liberara un buffer
+    uint64_t esperas() const { return d_esperas.load(std::memory_order_relaxed); }
+
+    // Error de escritura, o vacío
+    std::string error() const { return d_fallo.load(std::memory_order_acquire) ? d_error : std::string(); }
+
+    bool start() override {
+        d_fd = ::open(d_archivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (d_fd < 0) {
+            throw std::runtime_error("wav_sink: no se pudo abrir " + d_archivo + ": " + std::strerror(errno));
+        }
+        d_bytes_datos = 0;
+        escribir_cabecera();
+        d_ultimo_checkpoint = d_ultima_entrega = std::chrono::steady_clock::now();
+        d_terminar = false;
+        d_escritor = std::thread(&wav_sink::escritor, this);
+        return gr::sync_block::start();
+    }
+
+    bool stop() override {
+        detener_escritor();
+        return gr::sync_block::stop();
+    }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star&) override {
+        if (d_fallo.load(std::memory_order_acquire)) {
+            reportar_error();
+            return WORK_DONE;
+        }
+        uint64_t n = noutput_items;
+        if (d_totales > 0) {
+            n = std::min(n, d_totales - d_recibidas);
+        }
+
+        for (uint64_t hecho = 0; hecho < n;) {
+            if (!d_actual) {
+                d_actual = tomar_libre();
+                d_llenado = 0;
+            }
+            size_t k = std::min<uint64_t>(n - hecho, (d_tam_buffer - d_llenado) / d_bytes_frame);
+            uint8_t* destino = d_actual + d_llenado;
+            if (d_canales == 1) {
+                convertir((const float*)input_items[0] + hecho, k, destino);
+            } else {
+                k = std::min(k, LOTE);
+                for (int c = 0; c < d_canales; c++) {
+                    const float* in = (const float*)input_items[c] + hecho;
+                    for (size_t i = 0; i < k; i++) {
+                        d_intercalado[i * d_canales + c] = in[i];
+                    }
+                }
+                convertir(d_intercalado.data(), k * d_canales, destino);
+            }
+            d_llenado += k * d_bytes_frame;
+            hecho += k;
+            if (d_llenado == d_tam_buffer) {
+                entregar();
+            }
+        }
+        // Con señal lenta un buffer tarda mucho en llenarse (~44 s a 48 kHz
+        // mono en PCM16): lo que va se escribe en cada checkpoint
+        if (d_actual && std::chrono::steady_clock::now() - d_ultima_entrega >= d_checkpoint) {
+            entregar_parcial();
+        }
+
+        d_recibidas += n;
+        if (d_totales > 0 && d_recibidas >= d_totales) {
+            return WORK_DONE;
+        }
+        return noutput_items;
+    }
+
+private:
+    static constexpr size_t LOTE = 4096;            // frames por intercalado
+    static constexpr size_t TAM_BUFFER = 4 << 20;   // ~4 MiB por escritura
+    static constexpr size_t TAM_PAGINA = 4096;
+    static constexpr size_t TAM_CABECERA = 4096;    // los datos empiezan aquí
+    static constexpr uint64_t LIMITE_RIFF = 0xFFFFFFFFull;
+
+    struct liberar_alineado {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+
+    // Lado de work(): un buffer libre, esperando al escritor si hace falta
+    uint8_t* tomar_libre() {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        if (d_libres.empty()) {
+            d_esperas.fetch_add(1, std::memory_order_relaxed);
+            d_cambio.wait(lock, [this] { return !d_libres.empty(); });
+        }
+        uint8_t* b = d_libres.front();
+        d_libres.pop_front();
+        return b;
+    }
+
+    // Lado de work(): pasa el buffer actual (d_llenado bytes) al escritor
+    void entregar() {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_llenos.push_back({ d_actual, d_llenado });
+        }
+        d_cambio.notify_all();
+        d_actual = nullptr;
+        d_llenado = 0;
+        d_ultima_entrega = std::chrono::steady_clock::now();
+    }
+
+    // Lado de work(): entrega lo que lleva el buffer actual hasta un múltiplo
+    // de d_unidad y copia el resto al inicio del buffer siguiente. El
+    // escritor solo lee la parte entregada, así que la copia no compite con él.
+    void entregar_parcial() {
+        const size_t parte = d_llenado / d_unidad * d_unidad;
+        if (parte == 0) {
+            return;
+        }
+        uint8_t* anterior = d_actual;
+        const size_t resto = d_llenado - parte;
+        d_llenado = parte;
+        entregar();
+        d_actual = tomar_libre();
+        std::memcpy(d_actual, anterior + parte, resto);
+        d_llenado = resto;
+    }
+
+    void escritor() {
+        for (;;) {
+            std::pair<uint8_t*, size_t> lleno;
+            {
+                std::unique_lock<std::mutex> lock(d_mutex);
+                d_cambio.wait(lock, [this] { return !d_llenos.empty() || d_terminar; });
+                if (d_llenos.empty()) {
+                    break;
+                }
+                lleno = d_llenos.front();
+                d_llenos.pop_front();
+            }
+            // Tras un error los buffers se siguen liberando para que work()
+            // no se quede esperando
+            if (!d_fallo.load(std::memory_order_relaxed)) {
+                try {
+                    escribir(lleno.first, lleno.second);
+                    // Un buffer incompleto es un checkpoint (o el último)
+                    const auto ahora = std::chrono::steady_clock::now();
+                    if (lleno.second < d_tam_buffer || ahora - d_ultimo_checkpoint >= d_checkpoint) {
+                        escribir_cabecera();
+                        d_ultimo_checkpoint = ahora;
+                    }
+                } catch (const std::exception& e) {
+                    registrar_error(e);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                d_libres.push_back(lleno.first);
+            }
+            d_cambio.notify_all();
+        }
+    }
+
+    // Sin excepciones en el hilo escritor (std::terminate) ni en stop()
+    void registrar_error(const std::exception& e) {
+        if (!d_fallo.load(std::memory_order_relaxed)) {
+            d_error = e.what();
+            d_fallo.store(true, std::memory_order_release);
+        }
+    }
+
+    void reportar_error() {
+        if (!d_reportado) {
+            std::fprintf(stderr, "%s\n", d_error.c_str());
+            d_reportado = true;
+        }
+    }
+
+    void escribir(const uint8_t* datos, size_t bytes) {
+        const uint64_t offset = TAM_CABECERA + d_bytes_datos;
+        for (size_t hecho = 0; hecho < bytes;) {
+            const ssize_t r = ::pwrite(d_fd, datos + hecho, bytes - hecho, offset + hecho);
+            if (r <= 0) {
+                throw std::runtime_error("wav_sink: error al escribir " + d_archivo + ": " +
+                                         std::strerror(r < 0 ? errno : ENOSPC));
+            }
+            hecho += r;
+        }
+        d_bytes_datos += bytes;
+        d_escritas.store(d_bytes_datos / d_bytes_frame, std::memory_order_relaxed);
+    }
+
+    void detener_escritor() {
+        if (!d_escritor.joinable()) {
+            return;
+        }
+        // El buffer a medias también se escribe
+        if (d_actual && d_llenado > 0) {
+            entregar();
+        } else if (d_actual) {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_libres.push_back(d_actual);
+            d_actual = nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_terminar = true;
+        }
+        d_cambio.notify_all();
+        d_escritor.join();
+
+        // Byte de relleno de RIFF si los datos son de tamaño impar
+        if (d_bytes_datos & 1) {
+            const uint8_t cero = 0;
+            if (::pwrite(d_fd, &cero, 1, TAM_CABECERA + d_bytes_datos) != 1) {
+                std::perror("wav_sink: relleno");
+            }
+        }
+        try {
+            escribir_cabecera();
+        } catch (const std::exception& e) {
+            registrar_error(e);
+        }
+        ::close(d_fd);
+        d_fd = -1;
+        // Un error en las últimas escrituras, después del último work()
+        if (d_fallo.load(std::memory_order_acquire)) {
+            reportar_error();
+        }
+    }
+
+    /*************************************************/
+    /*        Conversión de float al formato         */
+    /*************************************************/
+
+    // Valor máximo y escala de cada formato PCM. En 32 bits el máximo es el
+    // mayor float menor que 2^31, para que el redondeo no desborde.
+    float maximo() const {
+        return d_formato == formato::PCM16 ? 32767.0f
+               : d_formato == formato::PCM24 ? 8388607.0f
+                                             : 2147483520.0f;
+    }
+    float escala() const {
+        return d_formato == formato::PCM16 ? 32767.0f
+               : d_formato == formato::PCM24 ? 8388607.0f
+                                             : 2147483647.0f;
+    }
+
+    // xorshift32 de un carril -> [0, 1)
+    static float uniforme(uint32_t& s) {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return static_cast<float>(s >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Muestra escalada, con dither, recortada y redondeada (como lrintf)
+    int32_t muestra_pcm(float x) {
+        float v = x * escala();
+        if (d_dither) {
+            const float u1 = uniforme(d_azar[d_carril]);
+            const float u2 = uniforme(d_azar[d_carril]);
+            v += u1 - u2;
+            d_carril = (d_carril + 1) & 7;
+        }
+        v = std::min(maximo(), std::max(-maximo(), v));
+        return static_cast<int32_t>(std::lrint(v));
+    }
+
+    void convertir_generico(const float* x, size_t n, uint8_t* destino) {
+        switch (d_formato) {
+        case formato::PCM16:
+            for (size_t i = 0; i < n; i++) {
+                const int16_t v = static_cast<int16_t>(muestra_pcm(x[i]));
+                std::memcpy(destino + 2 * i, &v, 2);
+            }
+            break;
+        case formato::PCM24:
+            for (size_t i = 0; i < n; i++) {
+                const int32_t v = muestra_pcm(x[i]);
+                destino[3 * i] = uint8_t(v);
+                destino[3 * i + 1] = uint8_t(v >> 8);
+                destino[3 * i + 2] = uint8_t(v >> 16);
+            }
+            break;
+        case formato::PCM32:
+            for (size_t i = 0; i < n; i++) {
+                const int32_t v = muestra_pcm(x[i]);
+                std::memcpy(destino + 4 * i, &v, 4);
+            }
+            break;
+        case formato::FLOAT:
+            std::memcpy(destino, x, n * sizeof(float));
+            break;
+        }
+    }
+
+    void convertir(const float* x, size_t n, uint8_t* destino) {
+#ifdef WAV_SINK_X86
+        if (d_usar_avx2 && d_formato != formato::FLOAT) {
+            // Las muestras sueltas hasta el carril 0 del dither van por la
+            // versión genérica, para que la secuencia sea la misma
+            size_t i = 0;
+            if (d_dither) {
+                i = std::min(n, size_t((8 - d_carril) & 7));
+                convertir_generico(x, i, destino);
+            }
+            i += convertir_avx2(x + i, n - i, destino + i * d_bytes_muestra);
+            convertir_generico(x + i, n - i, destino + i * d_bytes_muestra);
+            return;
+        }
+#endif
+        convertir_generico(x, n, destino);
+    }
+
+#ifdef WAV_SINK_X86
+    // 8 muestras a int32: escala, dither, recorte y redondeo
+    __attribute__((target("avx2"))) static __m256i
+    a_pcm_avx2(const float* x, __m256 escala, __m256 maximo, bool dither, __m256i& azar) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x), escala);
+        if (dither) {
+            const __m256 u1 = uniforme_avx2(azar);
+            const __m256 u2 = uniforme_avx2(azar);
+            v = _mm256_add_ps(v, _mm256_sub_ps(u1, u2));
+        }
+        v = _mm256_min_ps(maximo, _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), maximo), v));
+        return _mm256_cvtps_epi32(v);
+    }
+
+    __attribute__((target("avx2"))) static __m256 uniforme_avx2(__m256i& s) {
+        s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 13));
+        s = _mm256_xor_si256(s, _mm256_srli_epi32(s, 17));
+        s = _mm256_xor_si256(s, _mm256_slli_epi32(s, 5));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(s, 8)),
+                             _mm256_set1_ps(1.0f / 16777216.0f));
+    }
+
+    // Convierte grupos completos de 8 (16 en PCM16) y regresa cuántas muestras hizo
+    __attribute__((target("avx2"))) size_t convertir_avx2(const float* x, size_t n, uint8_t* destino) {
+        const __m256 esc = _mm256_set1_ps(escala());
+        const __m256 max = _mm256_set1_ps(maximo());
+        __m256i azar = _mm256_loadu_si256((const __m256i*)d_azar);
+        size_t i = 0;
+        switch (d_formato) {
+        case formato::PCM16:
+            for (; i + 16 <= n; i += 16) {
+                const __m256i a = a_pcm_avx2(x + i, esc, max, d_dither, azar);
+                const __m256i b = a_pcm_avx2(x + i + 8, esc, max, d_dither, azar);
+                // packs intercala por carriles de 128 bits; permute los ordena
+                const __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+                _mm256_storeu_si256((__m256i*)(destino + 2 * i), p);
+            }
+            break;
+        case formato::PCM24: {
+            // 4 int32 -> 12 bytes por carril; cada store de 16 bytes pisa 4
+            // del siguiente grupo, así que se deja al menos un grupo de margen
+            const __m256i empacar = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                     0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            for (; i + 10 <= n; i += 8) {
+                const __m256i p = _mm256_shuffle_epi8(a_pcm_avx2(x + i, esc, max, d_dither, azar), empacar);
+                _mm_storeu_si128((__m128i*)(destino + 3 * i), _mm256_castsi256_si128(p));
+                _mm_storeu_si128((__m128i*)(destino + 3 * i + 12), _mm256_extracti128_si256(p, 1));
+            }
+            break;
+        }
+        case formato::PCM32:
+            for (; i + 8 <= n; i += 8) {
+                _mm256_storeu_si256((__m256i*)(destino + 4 * i), a_pcm_avx2(x + i, esc, max, d_dither, azar));
+            }
+            break;
+        case formato::FLOAT:
+            break;
+        }
+        _mm256_storeu_si256((__m256i*)d_azar, azar);
+        return i;
+    }
+#endif
+
+    // RIFF/RF64 + ds64 (o JUNK) + fmt + JUNK de relleno + data en 4096
+    void escribir_cabecera() {
+        uint8_t c[TAM_CABECERA] = { 0 };
+        const uint64_t tam_riff = TAM_CABECERA - 8 + d_bytes_datos + (d_bytes_datos & 1);
+        const bool rf64 = tam_riff > LIMITE_RIFF;
+
+        std::memcpy(c, rf64 ? "RF64" : "RIFF", 4);
+        u32(c + 4, rf64 ? LIMITE_RIFF : tam_riff);
+        std::memcpy(c + 8, "WAVE", 4);
+
+        // ds64: tamaño RIFF, tamaño de datos, número de muestras, tabla vacía
+        std::memcpy(c + 12, rf64 ? "ds64" : "JUNK", 4);
+        u32(c + 16, 28);
+        if (rf64) {
+            u64(c + 20, tam_riff);
+            u64(c + 28, d_bytes_datos);
+            u64(c + 36, d_bytes_datos / d_bytes_frame);
+        }
+
+        std::memcpy(c + 48, "fmt ", 4);
+        u32(c + 52, 16);
+        u16(c + 56, d_formato == formato::FLOAT ? 3 : 1);
+        u16(c + 58, d_canales);
+        u32(c + 60, static_cast<uint32_t>(std::lround(d_samp_rate)));
+        u32(c + 64, static_cast<uint32_t>(std::lround(d_samp_rate)) * d_bytes_frame);
+        u16(c + 68, d_bytes_frame);
+        u16(c + 70, d_bytes_muestra * 8);
+
+        // Relleno para que los datos empiecen en TAM_CABECERA
+        std::memcpy(c + 72, "JUNK", 4);
+        u32(c + 76, TAM_CABECERA - 8 - 80);
+
+        std::memcpy(c + TAM_CABECERA - 8, "data", 4);
+        u32(c + TAM_CABECERA - 4, rf64 ? LIMITE_RIFF : d_bytes_datos);
+
+        if (::pwrite(d_fd, c, sizeof(c), 0) != static_cast<ssize_t>(sizeof(c))) {
+            throw std::runtime_error("wav_sink: error al escribir la cabecera de " + d_archivo);
+        }
+    }
+
+    static void u16(uint8_t* p, uint32_t v) {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+    }
+    static void u32(uint8_t* p, uint64_t v) {
+        u16(p, v & 0xFFFF);
+        u16(p + 2, (v >> 16) & 0xFFFF);
+    }
+    static void u64(uint8_t* p, uint64_t v) {
+        u32(p, v & 0xFFFFFFFF);
+        u32(p + 4, v >> 32);
+    }
+
+    const std::string d_archivo;
+    const int d_canales;
+    const double d_samp_rate;
+    const formato d_formato;
+    const bool d_dither;
+    const unsigned d_bytes_muestra;
+    const size_t d_bytes_frame;
+    const uint64_t d_totales;
+    const std::chrono::steady_clock::duration d_checkpoint;
+    size_t d_unidad;             // múltiplo de 4096 bytes y de un frame
+    size_t d_tam_buffer;
+    bool d_usar_avx2 = false;
+
+    // Buffers: libres (para work) y llenos (para el escritor)
+    std::vector<std::unique_ptr<uint8_t, liberar_alineado>> d_memoria;
+    std::deque<uint8_t*> d_libres;
+    std::deque<std::pair<uint8_t*, size_t>> d_llenos;
+    std::mutex d_mutex;
+    std::condition_variable d_cambio;
+    bool d_terminar = false;
+
+    // Lado de work()
+    uint8_t* d_actual = nullptr; // buffer que se está llenando
+    size_t d_llenado = 0;        // bytes en d_actual
+    std::vector<float> d_intercalado;
+    uint32_t d_azar[8];          // estado del dither, un xorshift32 por carril
+    int d_carril = 0;            // carril de la siguiente muestra
+    uint64_t d_recibidas = 0;
+    std::chrono::steady_clock::time_point d_ultima_entrega;
+    std::atomic<uint64_t> d_esperas{ 0 };
+    bool d_reportado = false;    // el error ya se imprimió
+
+    // Lado del escritor
+    std::thread d_escritor;
+    int d_fd = -1;
+    uint64_t d_bytes_datos = 0;  // bytes de datos ya en disco
+    std::chrono::steady_clock::time_point d_ultimo_checkpoint;
+    std::atomic<uint64_t> d_escritas{ 0 };
+    std::atomic<bool> d_fallo{ false };
+    std::string d_error;         // se escribe antes de d_fallo
+};
+
+#endif // BLOQUES_WAV_SINK_H
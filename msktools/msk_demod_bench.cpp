@@ -0,0 +1,195 @@
+// msk_demod_bench.cpp
+// Prueba de lazo cerrado del demodulador de bits: genera la señal MSK en FI
+// como msk_wav_generator (random_uniform_source_b(0, 2, semilla) +
+// msk_if_modulator, fc = 800 Hz, 200 bps), opcionalmente le suma ruido
+// gaussiano, y la demodula con ddc_frontend + msk_demodulator sin GUI ni
+// throttle. Reporta la tasa de error de bits (BER) contra los bits enviados y
+// cuántos bits por segundo demodula (y el factor de tiempo real).
+//
+// Con --wav se demodula un archivo de msk_wav_generator y los bits de
+// referencia se regeneran con la misma semilla. GNU Radio toma la semilla 0
+// del reloj, así que el archivo debe generarse con --semilla N distinta de 0.
+//
+// Uso: ./msk_demod_bench [--ebn0 dB] [--semilla N] [segundos] [sample_rate]
+//      ./msk_demod_bench --wav archivo.wav --semilla N
+// Ejemplo: ./msk_demod_bench --ebn0 8 600 48000
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/analog/noise_source.h>
+#include <gnuradio/analog/random_uniform_source.h>
+#include <gnuradio/blocks/add_blk.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+
+#include "../bloques/ddc_frontend.h"
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/msk_demodulator.h"
+#include "../bloques/msk_if_modulator.h"
+#include "../bloques/wav_file.h"
+
+// Parámetros del modulador (los mismos que msk_wav_generator)
+const double bit_rate = 200.0;
+const float fc = 800.0f;
+// Filtro del front-end (los mismos que msk_phase_wav)
+const float lpf_cutoff = 400.0f;
+const float lpf_trans  = 200.0f;
+
+// Bits de la fuente con la semilla dada (uno por byte)
+std::vector<uint8_t> generar_bits(unsigned semilla, uint64_t nbits) {
+    auto tb = gr::make_top_block("bits");
+    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, semilla);
+    auto head = gr::blocks::head::make(sizeof(uint8_t), nbits);
+    auto sink = gr::blocks::vector_sink_b::make();
+    tb->connect(rand_src, 0, head, 0);
+    tb->connect(head, 0, sink, 0);
+    tb->run();
+    return sink->data();
+}
+
+// Señal en FI de los bits dados, con ruido para el Eb/N0 pedido (dB; NAN sin ruido)
+std::vector<float> modular(const std::vector<uint8_t>& bits, double samp_rate, int sps, double ebn0_db) {
+    auto tb = gr::make_top_block("modulador");
+    auto src = gr::blocks::vector_source_b::make(bits);
+    auto msk_mod = msk_if_modulator::make(sps, samp_rate, fc);
+    auto sink = gr::blocks::vector_sink_f::make();
+    tb->connect(src, 0, msk_mod, 0);
+    if (std::isnan(ebn0_db)) {
+        tb->connect(msk_mod, 0, sink, 0);
+    } else {
+        // Potencia de la señal 1/2 => Eb = sps/2; ruido real con N0/2 = sigma^2
+        const double ebn0 = std::pow(10.0, ebn0_db / 10.0);
+        const double sigma = std::sqrt(sps / 2.0 / ebn0 / 2.0);
+        auto ruido = gr::analog::noise_source_f::make(gr::analog::GR_GAUSSIAN, sigma, 42);
+        auto suma = gr::blocks::add_ff::make();
+        tb->connect(msk_mod, 0, suma, 0);
+        tb->connect(ruido, 0, suma, 1);
+        tb->connect(suma, 0, sink, 0);
+    }
+    tb->run();
+    return sink->data();
+}
+
+// Demodula la señal completa; regresa los bits empaquetados y el tiempo (s)
+double demodular(const std::vector<float>& senal, double samp_rate, double bits_por_segundo,
+                 std::vector<uint8_t>& empaquetados) {
+    auto tb = gr::make_top_block("demodulador");
+    auto src = gr::blocks::vector_source_f::make(senal);
+    auto frontend = ddc_frontend::make(samp_rate, fc, lpf_cutoff, lpf_trans, 2.0);
+    // ddc_frontend entrega la fase conjugada (ver msk_demodulator.h)
+    auto demod = msk_demodulator::make(frontend->tasa_salida(), bits_por_segundo, true, true);
+    auto sink = gr::blocks::vector_sink_b::make();
+    tb->connect(src, 0, frontend, 0);
+    tb->connect(frontend, 0, demod, 0);
+    tb->connect(demod, 0, sink, 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    tb->run();
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::cout << "ddc_frontend: decimación " << frontend->decimation() << " ("
+              << frontend->tasa_salida() << " Hz), " << demod->muestras_por_bit()
+              << " muestras por bit; desvío de portadora estimado "
+              << demod->desvio_hz(frontend->tasa_salida()) << " Hz" << std::endl;
+    empaquetados = sink->data();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char** argv) {
+    const std::string archivo_wav = tomar_texto(argc, argv, "--wav", "");
+    const unsigned semilla = static_cast<unsigned>(tomar_valor(argc, argv, "--semilla", 0));
+    const double ebn0_db = tomar_valor(argc, argv, "--ebn0", NAN);
+    if (argc > 3 || (!archivo_wav.empty() && argc > 1)) {
+        std::cerr << "Uso: " << argv[0] << " [--ebn0 dB] [--semilla N] [segundos] [sample_rate]\n"
+                  << "     " << argv[0] << " --wav archivo.wav --semilla N" << std::endl;
+        return 1;
+    }
+
+    // Señal y bits enviados
+    std::vector<float> senal;
+    std::vector<uint8_t> enviados;
+    double samp_rate;
+    int sps;
+    if (archivo_wav.empty()) {
+        const double segundos = argc > 1 ? std::stod(argv[1]) : 300.0;
+        samp_rate = argc > 2 ? std::stod(argv[2]) : 48000.0;
+        sps = static_cast<int>(std::round(samp_rate / bit_rate));
+        enviados = generar_bits(semilla, static_cast<uint64_t>(segundos * samp_rate / sps));
+        senal = modular(enviados, samp_rate, sps, ebn0_db);
+    } else {
+        const wav_file wav(archivo_wav);
+        samp_rate = wav.sample_rate();
+        sps = 0;
+        senal.resize(wav.num_frames());
+        wav.leer(0, 0, senal.size(), senal.data());
+        if (semilla != 0) {
+            enviados = generar_bits(semilla, static_cast<uint64_t>(senal.size() / samp_rate * bit_rate));
+        } else {
+            std::cout << "Sin --semilla no se conocen los bits del archivo: solo se mide el rendimiento"
+                      << std::endl;
+        }
+    }
+    // El modulador de este programa usa sps entero (tasa de bits efectiva
+    // fs/sps); msk_wav_generator remuestrea cuando fs/bit_rate no es entero,
+    // así que sus archivos tienen exactamente bit_rate
+    const double bits_por_segundo = sps ? samp_rate / sps : bit_rate;
+
+    std::vector<uint8_t> empaquetados;
+    const double t = demodular(senal, samp_rate, bits_por_segundo, empaquetados);
+    std::vector<uint8_t> recibidos(empaquetados.size() * 8);
+    for (size_t i = 0; i < recibidos.size(); i++) {
+        recibidos[i] = (empaquetados[i / 8] >> (7 - i % 8)) & 1;
+    }
+
+    const double duracion = senal.size() / samp_rate;
+    std::cout << "Demodulados " << recibidos.size() << " bits de " << duracion << " s de señal en "
+              << t << " s: " << recibidos.size() / t << " bits/s, " << duracion / t
+              << "x tiempo real (" << senal.size() / t / 1e6 << " Mmuestras/s)" << std::endl;
+
+    if (enviados.empty()) {
+        return 0;
+    }
+
+    // Retardo entre enviados y recibidos: el de más coincidencias en una
+    // ventana después del arranque del lazo de sincronía
+    const long arranque = 64, ventana = 2000, max_retardo = 64;
+    long retardo = 0, mejor = -1;
+    for (long r = -max_retardo; r <= max_retardo; r++) {
+        long iguales = 0;
+        for (long i = arranque; i < arranque + ventana; i++) {
+            const long j = i - r;
+            if (j >= 0 && j < (long)enviados.size() && i < (long)recibidos.size()) {
+                iguales += recibidos[i] == enviados[j];
+            }
+        }
+        if (iguales > mejor) {
+            mejor = iguales;
+            retardo = r;
+        }
+    }
+
+    long errores = 0, comparados = 0;
+    for (long i = arranque; i < (long)recibidos.size(); i++) {
+        const long j = i - retardo;
+        if (j >= 0 && j < (long)enviados.size()) {
+            errores += recibidos[i] != enviados[j];
+            comparados++;
+        }
+    }
+    if (std::isnan(ebn0_db)) {
+        std::printf("Sin ruido: ");
+    } else {
+        std::printf("Eb/N0 = %.1f dB: ", ebn0_db);
+    }
+    std::printf("BER = %.3g (%ld errores en %ld bits, retardo %ld bits)\n",
+                comparados ? double(errores) / comparados : 0.0, errores, comparados, retardo);
+    if (mejor < ventana * 0.6) {
+        std::printf("Aviso: sin sincronía con los bits de referencia (¿otra semilla?)\n");
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// msk_frontend_bench.cpp
+// Compara el rendimiento de la cadena original de msk_phase_wav
+// (float_to_complex + sig_source_c + multiply_cc + fir_filter_ccc sin
+// decimación) contra el bloque ddc_frontend, procesando un WAV completo sin
+// GUI ni throttle.
+// Uso: ./msk_frontend_bench <archivo_wav>
+
+#include <iostream>
+#include <chrono>
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/analog/sig_source.h>
+#include <gnuradio/blocks/wavfile_source.h>
+#include <gnuradio/blocks/complex_to_float.h>
+#include <gnuradio/blocks/float_to_complex.h>
+#include <gnuradio/blocks/multiply.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/filter/fir_filter_blk.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/fft/goertzel_fc.h>
+
+#include "../bloques/ddc_frontend.h"
+
+// Parámetros del demodulador (los mismos que msk_phase_wav)
+const float fc = 800.0f;
+const float lpf_cutoff = 400.0f;
+const float lpf_trans  = 200.0f;
+const float goertzel_freq = 100.0f;
+
+// Cadena original: todo a la tasa del WAV
+double correr_cadena_original(const char* archivo_wav, long& muestras) {
+    auto tb = gr::make_top_block("frontend_original");
+    auto wav_source = gr::blocks::wavfile_source::make(archivo_wav, false);
+    const int samp_rate = wav_source->sample_rate();
+
+    auto ff2c = gr::blocks::float_to_complex::make();
+    auto zero_src = gr::analog::sig_source_f::make(samp_rate, gr::analog::GR_CONST_WAVE, 0, 0.0, 0.0);
+    auto mixer_osc = gr::analog::sig_source_c::make(samp_rate, gr::analog::GR_COS_WAVE, fc, 1.0, 0.0);
+    auto mixer = gr::blocks::multiply_cc::make();
+
+    auto taps = gr::filter::firdes::low_pass(
+        1.0, samp_rate, lpf_cutoff, lpf_trans, gr::fft::window::win_type::WIN_HAMMING);
+    std::vector<gr_complex> complex_taps(taps.begin(), taps.end());
+    auto lpf = gr::filter::fir_filter_ccc::make(1, complex_taps);
+
+    auto mult = gr::blocks::multiply_cc::make();
+    auto c2ff = gr::blocks::complex_to_float::make();
+    auto goertzel = gr::fft::goertzel_fc::make(samp_rate, samp_rate / 2, goertzel_freq);
+    auto sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+
+    tb->connect(wav_source, 0, ff2c, 0);
+    tb->connect(zero_src, 0, ff2c, 1);
+    tb->connect(ff2c, 0, mixer, 0);
+    tb->connect(mixer_osc, 0, mixer, 1);
+    tb->connect(mixer, 0, lpf, 0);
+    tb->connect(lpf, 0, mult, 0);
+    tb->connect(lpf, 0, mult, 1);
+    tb->connect(mult, 0, c2ff, 0);
+    tb->connect(c2ff, 0, goertzel, 0);
+    tb->connect(goertzel, 0, sink, 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    tb->run();
+    auto t1 = std::chrono::steady_clock::now();
+
+    muestras = wav_source->nitems_written(0);
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+// Cadena nueva: front-end con decimación, el resto a la tasa reducida
+double correr_cadena_ddc(const char* archivo_wav, long& muestras) {
+    auto tb = gr::make_top_block("frontend_ddc");
+    auto wav_source = gr::blocks::wavfile_source::make(archivo_wav, false);
+    const int samp_rate = wav_source->sample_rate();
+
+    auto frontend = ddc_frontend::make(samp_rate, fc, lpf_cutoff, lpf_trans, 2.0);
+    const double bb_rate = frontend->tasa_salida();
+
+    auto mult = gr::blocks::multiply_cc::make();
+    auto c2ff = gr::blocks::complex_to_float::make();
+    auto goertzel = gr::fft::goertzel_fc::make(
+        std::lround(bb_rate), static_cast<int>(bb_rate * 0.5), goertzel_freq);
+    auto sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+
+    tb->connect(wav_source, 0, frontend, 0);
+    tb->connect(frontend, 0, mult, 0);
+    tb->connect(frontend, 0, mult, 1);
+    tb->connect(mult, 0, c2ff, 0);
+    tb->connect(c2ff, 0, goertzel, 0);
+    tb->connect(goertzel, 0, sink, 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    tb->run();
+    auto t1 = std::chrono::steady_clock::now();
+
+    muestras = wav_source->nitems_written(0);
+    std::cout << "ddc_frontend: " << frontend->ntaps() << " taps, decimación "
+              << frontend->decimation() << std::endl;
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <archivo_wav>" << std::endl;
+        return 1;
+    }
+
+    long n_original = 0, n_ddc = 0;
+    const double t_original = correr_cadena_original(argv[1], n_original);
+    const double t_ddc = correr_cadena_ddc(argv[1], n_ddc);
+
+    std::cout << "Cadena original: " << n_original << " muestras en " << t_original << " s ("
+              << n_original / t_original / 1e6 << " Mmuestras/s)" << std::endl;
+    std::cout << "ddc_frontend:    " << n_ddc << " muestras en " << t_ddc << " s ("
+              << n_ddc / t_ddc / 1e6 << " Mmuestras/s)" << std::endl;
+    std::cout << "Aceleración: " << t_original / t_ddc << "x" << std::endl;
+    return 0;
+}
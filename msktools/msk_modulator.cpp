@@ -4,45 +4,45 @@
 
 #include <gnuradio/random.h>
 #include <gnuradio/top_block.h>
-#include <gnuradio/analog/sig_source.h>
 #include <gnuradio/analog/random_uniform_source.h>
-#include <gnuradio/blocks/uchar_to_float.h>
-#include <gnuradio/blocks/float_to_char.h>
-#include <gnuradio/blocks/add_const_ff.h>
-#include <gnuradio/blocks/multiply_const.h>
-#include <gnuradio/blocks/complex_to_float.h>
-#include <gnuradio/digital/cpmmod_bc.h>
-#include <gnuradio/blocks/multiply.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/throttle.h>
 #include <gnuradio/qtgui/time_sink_f.h>
 #include <QWidget>
 #include <QApplication>
 
+#include <memory>
+#include <vector>
 
+#include "../bloques/display_tap.h"
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/msk_if_modulator.h"
+#include "../bloques/opciones_scheduler.h"
+
+// Con --headless no se abre ventana y el flujo corre sin throttle hasta
+// Ctrl+C (SIGINT) o SIGTERM. Acepta las opciones --gr-* de
+// bloques/opciones_scheduler.h (buffers, afinidad, tiempo real).
+// Con ventana, la señal pasa por un throttle a la tasa nominal y la gráfica
+// se alimenta desde un display_tap (bloques/display_tap.h) en un flujo
+// aparte, así que una ventana lenta no frena al modulador.
 int main(int argc, char** argv) {
 
     /*************************************************/
     /*     Generación de flujo de bits aleatorios    */
     /*************************************************/
 
-     // Inicializar Qt GUI
-     QApplication app(argc, argv);
+    // Inicializar Qt GUI (solo si hay ventana)
+    const bool headless = tomar_opcion(argc, argv, "--headless");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+    std::unique_ptr<QApplication> app;
+    if (!headless) {
+        app.reset(new QApplication(argc, argv));
+    }
      auto tb = gr::make_top_block("Stream de bits aleatorios");
 
     // Crear fuente de bits aleatorios (uint8_t)
     auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, 0); // (min, max, seed)
 
-    // Convert enteros a flotantes: (+/-1)
-    auto uchar_to_float = gr::blocks::uchar_to_float::make();
-    auto map_to_bipolar = gr::blocks::add_const_ff::make(-0.5);     // 0/1 -> -0.5/0.5
-
-    // Escalamiento adecuado para el modulador de fase
-    auto scale_to_pm = gr::blocks::multiply_const_ff::make(2.0); // -0.5/0.5 -> -1/+1
-    auto bb_pm       = gr::blocks::float_to_char::make();
-
-    // Sumador y convertidores de componentes IQ a FI
-    auto c2ff   = gr::blocks::complex_to_float::make();
-
-
     /*************************************************/
     /*              Modulador MSK                    */
     /*************************************************/
@@ -50,66 +50,82 @@ int main(int argc, char** argv) {
     const int samples_per_sym = 32;
     const double samp_rate = bit_rate * samples_per_sym;
 
-    auto msk_mod = gr::digital::cpmmod_bc::make(
-        gr::analog::cpm::LREC, /* tipo de pulso rectangular -> MSK */
-        0.5,                   // h = 0.5 para MSK
-        samples_per_sym,       // muestras por símbolo
-        1                      // L=1 -> full response
-                               // beta no se usa en LREC
-    );
-
-    // Conversión Banda Base a Frecuencia Intermedia (IF)
+    // Modulación MSK (h = 0.5) y conversión a Frecuencia Intermedia (IF) en un
+    // solo bloque: bits 0/1 -> parte real de la señal MSK mezclada con fc.
+    // Equivale a cpmmod_bc(LREC, 0.5, sps, 1) + sig_source_c + multiply_cc +
+    // complex_to_float (ver msk_modulator_bench.cpp).
     const float fc = 800; // Frecuencia de la portadora (Hz)
-    auto mixer_osc = gr::analog::sig_source_c::make(samp_rate, gr::analog::GR_COS_WAVE, fc, 1.0, 0.0);
-
-    // Multiplicador complejo para mezclar la señal MSK con el oscilador
-    auto mixer = gr::blocks::multiply_cc::make();
+    auto msk_mod = msk_if_modulator::make(samples_per_sym, samp_rate, fc);
 
     /*************************************************/
     /*              Sumidero  GUI                    */
     /*************************************************/
 
     // Crear visualizador en tiempo (QT GUI Time Sink)
-    const int size = 1024; // Muestras para mostrar
-    const std::string name = "Modulación MSK de tren de bits aleatorios";
-    const unsigned int nconnections = 1;
-
-    auto time_sink = gr::qtgui::time_sink_f::make(size, samp_rate, name, nconnections, nullptr);
-    time_sink->set_update_time(0.10);    
-    time_sink->set_y_axis(-1.5, 1.5);   
-    time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
-    time_sink->enable_grid(true);
-    time_sink->set_y_label("Amplitud", "");
-    time_sink->set_line_label(0, "Señal MSK");
-    time_sink->set_line_color(0, "blue");
-    time_sink->enable_control_panel(true);
-    time_sink->enable_tags(0, false);
-
-    // Mostrar GUI
-    time_sink->qwidget()->show();
-
-    // Conectar bloques
-    tb->connect(rand_src, 0, uchar_to_float, 0);
-    tb->connect(uchar_to_float, 0, map_to_bipolar, 0);
-    tb->connect(map_to_bipolar, 0, scale_to_pm, 0);
-    tb->connect(scale_to_pm, 0, bb_pm, 0);
-    tb->connect(bb_pm, 0, msk_mod, 0);
-
-    // Mezclar la señal MSK con el oscilador complejo para subir a banda IF
-    tb->connect(msk_mod, 0, mixer, 0);
-    tb->connect(mixer_osc, 0, mixer, 1);
-    tb->connect(mixer, 0, c2ff, 0); // Tomar parte real: y = I*cos(th) - Q*sin(th)
-    tb->connect(c2ff, 0, time_sink, 0);
-
-    // Iniciar flowgraph
-    tb->start();
-
-    // Correr loop de Qt
-    app.exec();
-
-    // Detener flujo cuando se cierre la ventana de Qt
-    tb->stop();
-    tb->wait();
+    gr::top_block_sptr tb_vista;
+    display_tap_f::sptr tap;
+    tb->connect(rand_src, 0, msk_mod, 0);
+    std::vector<gr::basic_block_sptr> bloques = { rand_src, msk_mod };
+    if (!headless) {
+        const int size = 1024; // Muestras para mostrar
+        const std::string name = "Modulación MSK de tren de bits aleatorios";
+        const unsigned int nconnections = 1;
+
+        // Sin la contrapresión de la GUI el generador correría sin freno
+        auto throttle = gr::blocks::throttle::make(sizeof(float), samp_rate);
+
+        // Un cuadro de 'size' muestras cada 0.1 s; el time_sink lo toma en
+        // su propio flujo
+        tap = display_tap_f::make(samp_rate, size, 0.10);
+        tb_vista = gr::make_top_block("Vista MSK");
+        auto vista = display_source_f::make(tap);
+
+        auto time_sink = gr::qtgui::time_sink_f::make(size, tap->tasa_vista(), name, nconnections, nullptr);
+        time_sink->set_update_time(0.10);
+        time_sink->set_y_axis(-1.5, 1.5);
+        time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
+        time_sink->enable_grid(true);
+        time_sink->set_y_label("Amplitud", "");
+        time_sink->set_line_label(0, "Señal MSK");
+        time_sink->set_line_color(0, "blue");
+        time_sink->enable_control_panel(true);
+        time_sink->enable_tags(0, false);
+
+        // Mostrar GUI
+        time_sink->qwidget()->show();
+        tb_vista->connect(vista, 0, time_sink, 0);
+
+        tb->connect(msk_mod, 0, throttle, 0);
+        tb->connect(throttle, 0, tap, 0);
+        bloques.insert(bloques.end(), { throttle, tap });
+    } else {
+        // Sin ventana la salida se descarta; solo se mide el rendimiento
+        auto sink = gr::blocks::null_sink::make(sizeof(float));
+        tb->connect(msk_mod, 0, sink, 0);
+        bloques.push_back(sink);
+    }
+    sched.aplicar(tb, bloques);
+
+    if (headless) {
+        // Generar hasta recibir una señal de terminación
+        ejecutar_headless(tb, rand_src, bit_rate, false);
+    } else {
+        // Iniciar flowgraph y el de la gráfica
+        tb->start();
+        tb_vista->start();
+
+        // Correr loop de Qt
+        app->exec();
+
+        // Detener flujos cuando se cierre la ventana de Qt
+        tb_vista->stop();
+        tb->stop();
+        tb_vista->wait();
+        tb->wait();
+
+        std::cout << "Cuadros de la gráfica: " << tap->cuadros()
+                  << ", descartados: " << tap->descartados() << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -4,153 +4,235 @@
 
 #include <gnuradio/top_block.h>
 #include <gnuradio/audio/source.h>
-#include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/float_to_complex.h>
-#include <gnuradio/filter/firdes.h>
-#include <gnuradio/filter/freq_xlating_fir_filter.h>
 #include <gnuradio/blocks/multiply.h>
 #include <complex>
-#include <gnuradio/fft/goertzel_fc.h>
-#include <gnuradio/sync_block.h>
+#include <memory>
 #include <gnuradio/qtgui/time_sink_c.h>
 #include <QWidget>
 #include <QApplication>
 
-// Bloque personalizado para imprimir la amplitud y fase de la señal
-// Hereda de gr::sync_block para integrarse en el flujo de GNU Radio
-class print_block : public gr::sync_block {
-public:
-    // Definición de tipo para shared_ptr
-    typedef std::shared_ptr<print_block> sptr;
-    // Método estático para crear instancias del bloque
-    static sptr make() {
-        return gnuradio::get_initial_sptr(new print_block());
-    }
-
-    // Constructor: define nombre y firmas de entrada/salida
-    print_block()
-        : gr::sync_block("print_block",
-                         gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                         gr::io_signature::make(0, 0, 0)) {}
-
-    // Método principal de procesamiento del bloque
-    // Imprime amplitud y fase de cada muestra recibida
-    int work(int noutput_items,
-             gr_vector_const_void_star &input_items,
-             gr_vector_void_star &) override {
-        const gr_complex *in = (const gr_complex*) input_items[0];
-        for (int i = 0; i < noutput_items; i++) {
-            float amplitude = 2*std::abs(in[i]);
-            float phase_rad = std::arg(in[i]);
-            float phase_deg = phase_rad * 180.0f / M_PI; // Conversión a grados
-            std::cout << "Amplitud: " << amplitude << ", Fase: " << phase_deg << " grados" << std::endl;
-        }
-        return noutput_items;
-    }
-};
-
+#include "../bloques/display_tap.h"
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/latency_trace.h"
+#include "../bloques/opciones_scheduler.h"
+#include "../bloques/pfb_frontend.h"
+#include "../bloques/shm_ring.h"
+#include "../bloques/phase_logger.h"
+#include "../bloques/sliding_goertzel.h"
+
+// Uso: ./msk_phase_soundcard [--headless] [--dispositivo D] [--estaciones archivo] [--latencia N] [--gr-...]
+// Con --headless no se abre ventana y el flujo corre hasta Ctrl+C (SIGINT) o SIGTERM.
+// --dispositivo elige la tarjeta (hw:1,0 por omisión); con "shm:<nombre>" se
+// lee el canal 0 del anillo que publica audio_publisher (bloques/shm_ring.h),
+// a su frecuencia de muestreo, mientras otros programas usan la misma captura.
+// Con --estaciones se monitorean varias portadoras a la vez: el archivo tiene
+// una línea "nombre fc_hz ancho_hz [bps]" por estación (ver estaciones.txt).
+// Un solo canalizador (bloques/pfb_frontend.h) las lleva todas a banda base y
+// cada una tiene su cadena de cuadrado + sliding_goertzel, con la fase en
+// fase_<nombre>_mas.csv y fase_<nombre>_menos.csv. Sin --estaciones se
+// monitorea la portadora de prueba en 809 Hz, con +100 Hz a consola y -100 Hz
+// a fase_menos_100Hz.csv.
+// Con --latencia N se etiqueta una muestra de cada N a la salida de la tarjeta
+// de sonido y al terminar se escribe latencia_msk_phase.csv con la latencia
+// (p50/p99/máx e histogramas) de cada etapa y de punta a punta (ver
+// bloques/latency_trace.h).
+// Con ventana, la gráfica se alimenta desde un display_tap
+// (bloques/display_tap.h) en un flujo aparte, así que una ventana lenta o
+// minimizada no llena los buffers ni causa sobreflujos en la tarjeta.
+// Las opciones --gr-* de bloques/opciones_scheduler.h fijan buffers, CPUs y
+// prioridad de tiempo real, por ejemplo para un equipo compartido:
+//   ./msk_phase_soundcard --headless --gr-tiempo-real --gr-cpus 2,3 --gr-buffer-max 4096
 int main(int argc, char** argv) {
 
-     // Inicializar Qt GUI
-     QApplication app(argc, argv);
+    // Inicializar Qt GUI (solo si hay ventana)
+    const bool headless = tomar_opcion(argc, argv, "--headless");
+    const uint64_t latencia_cada = static_cast<uint64_t>(tomar_valor(argc, argv, "--latencia", 0));
+    const std::string archivo_estaciones = tomar_texto(argc, argv, "--estaciones", "");
+    const std::string dispositivo = tomar_texto(argc, argv, "--dispositivo", "hw:1,0");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+    std::unique_ptr<QApplication> app;
+    if (!headless) {
+        app.reset(new QApplication(argc, argv));
+    }
      auto tb = gr::make_top_block("MSK en banda base");
 
     // Fuente de Tarjeta de Sonido (Sound Card)
-    const int samp_rate = 48000; // Tasa de muestreo en Hz
+    double samp_rate = 48000; // Tasa de muestreo en Hz
 
     // Nota: obtener nombres de dispositivos con "arecord -l"
-    auto soundcard = gr::audio::source::make(samp_rate, "hw:1,0", true);
-
-    // Convertidor de componentes FI a IQ
-    auto c2ff   = gr::blocks::complex_to_float::make();
-    const int decimation = 8;
-
-    // Bloque Goertzel para obtención de fase
-    const float goertzel_freq = 100.0f; // Frecuencia de interés
-    const int batch_samples = static_cast<int>(samp_rate/decimation * 1); // n segundo(n)
-    auto goertzel = gr::fft::goertzel_fc::make(samp_rate/decimation, batch_samples, goertzel_freq);
-
-    // Multiplicador para cuadrado de la señal
-    auto mult = gr::blocks::multiply_cc::make();
-
-    // Bloque a la medida para imprimir la fase
-    auto printer = print_block::make(); 
+    gr::block_sptr soundcard;
+    shm_ring_source::sptr shm_src;
+    const std::string shm = nombre_shm(dispositivo);
+    if (!shm.empty()) {
+        // Otro proceso tiene la tarjeta; la fase sigue al canal 0 del anillo
+        auto anillo = shm_ring::abrir(shm);
+        samp_rate = anillo->samp_rate();
+        soundcard = shm_src = shm_ring_source::make(anillo);
+        std::cout << "Leyendo el anillo '" << shm << "' a " << samp_rate << " Hz" << std::endl;
+    } else {
+        soundcard = gr::audio::source::make(samp_rate, dispositivo, true);
+    }
 
     /************************************************/
-    /*          Filtro para demodulador             */
+    /*        Canalizador para demodulador          */
     /************************************************/
 
-    // Filtro pasa bajas de 400 Hz
-    // Diseño de filtro FIR
-    const float lpf_cutoff = 400.0f;  // Frecuencia de corte
-    const float lpf_trans  = 200.0f;  // Ancho de transición
-    auto taps = gr::filter::firdes::low_pass(
-                                     1.0, 
-                                     samp_rate,
-                                     lpf_cutoff, 
-                                     lpf_trans, 
-                                     gr::fft::window::win_type::WIN_HAMMING
-                                   );
-    // Convert to complex taps
-    std::vector<gr_complex> complex_taps;
-    for (auto t : taps) {
-        complex_taps.push_back(gr_complex(t, 0.0f));
+    // Estaciones: portadora, ancho del pasa-bajas (±ancho/2) y tasa de bits
+    const std::vector<pfb_estacion> estaciones = archivo_estaciones.empty()
+        ? std::vector<pfb_estacion>{ { "prueba", 809.0, 800.0, 200.0 } }
+        : leer_estaciones(archivo_estaciones);
+
+    // Banco de filtros polifásico: una FFT para todas las estaciones y un
+    // pasa-bajas corto por estación a la tasa del canal
+    auto canalizador = pfb_frontend::make(samp_rate, estaciones);
+    const double bb_rate = canalizador->tasa_salida();
+
+    std::cout << "Canalizador: " << canalizador->canales() << " canales, " << canalizador->ntaps()
+              << " taps, salida a " << bb_rate << " Hz" << std::endl;
+
+    // Por estación: cuadrado de la señal y DFT deslizante para obtención de
+    // fase, los tonos en +/-bps/2 con ventana de 1 s y una actualización cada 0.1 s
+    const int batch_samples = static_cast<int>(bb_rate * 1); // n segundo(n)
+    const int hop_samples = batch_samples / 10;
+    std::vector<gr::blocks::multiply_cc::sptr> mults;
+    std::vector<sliding_goertzel::sptr> goertzels;
+    std::vector<phase_logger::sptr> printers;
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        const pfb_estacion& e = estaciones[s];
+        const double goertzel_freq = e.bps / 2; // Frecuencia de interés
+        std::cout << "  " << e.nombre << ": " << e.fc << " Hz, canal " << canalizador->canal(s)
+                  << ", orden del filtro FIR " << canalizador->ntaps_estacion(s) - 1 << std::endl;
+
+        // Multiplicador para cuadrado de la señal
+        mults.push_back(gr::blocks::multiply_cc::make());
+        goertzels.push_back(sliding_goertzel::make(
+            bb_rate, { goertzel_freq, -goertzel_freq }, batch_samples, hop_samples));
+
+        // Registro de amplitud y fase (la E/S ocurre en un hilo aparte)
+        if (estaciones.size() == 1) {
+            printers.push_back(phase_logger::make(phase_logger::formato::CONSOLA));
+            printers.push_back(phase_logger::make(
+                phase_logger::formato::CSV,
+                "fase_menos_" + std::to_string(std::lround(goertzel_freq)) + "Hz.csv"));
+        } else {
+            printers.push_back(
+                phase_logger::make(phase_logger::formato::CSV, "fase_" + e.nombre + "_mas.csv"));
+            printers.push_back(
+                phase_logger::make(phase_logger::formato::CSV, "fase_" + e.nombre + "_menos.csv"));
+        }
     }
 
-    std::cout << "Orden del filtro FIR: " << complex_taps.size() - 1 << std::endl;
-
-    // Convertidor de frecuencia y filtrado en un solo bloque
-    const float fc = 809; // Frecuencia de la portadora (Hz)
-    auto freq_xlating = gr::filter::freq_xlating_fir_filter_fcc::make(
-        decimation, complex_taps, fc, samp_rate
-    );
-
     /*************************************************/
     /*              Sumidero  GUI                    */
     /*************************************************/
 
     // Crear visualizador en tiempo (QT GUI Time Sink)
-    const int size = 1024; // Muestras para mostrar
-    const std::string name = "MSK en Banda Base";
-    const unsigned int nconnections = 1;
-
-    auto time_sink = gr::qtgui::time_sink_c::make(size, samp_rate/decimation, name, nconnections, nullptr);
-    time_sink->set_update_time(0.10);    
-    time_sink->set_y_axis(-1.5, 1.5);   
-    time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
-    time_sink->enable_grid(true);
-    time_sink->set_y_label("Amplitud", "");
-    time_sink->set_line_label(0, "I");
-    time_sink->set_line_color(0, "blue");
-    time_sink->set_line_label(1, "Q");
-    time_sink->enable_control_panel(true);
-    time_sink->enable_tags(0, false);
-
-    // Mostrar GUI
-    time_sink->qwidget()->show();
+    gr::top_block_sptr tb_vista;
+    display_tap_c::sptr tap;
+    if (!headless) {
+        const int size = 1024; // Muestras para mostrar
+        const std::string name = "MSK en Banda Base";
+        const unsigned int nconnections = 1;
+
+        // Un cuadro de 'size' muestras cada 0.1 s; el time_sink lo toma en
+        // su propio flujo
+        tap = display_tap_c::make(bb_rate, size, 0.10);
+        tb_vista = gr::make_top_block("Vista MSK en banda base");
+        auto vista = display_source_c::make(tap);
+
+        auto time_sink = gr::qtgui::time_sink_c::make(size, tap->tasa_vista(), name, nconnections, nullptr);
+        time_sink->set_update_time(0.10);
+        time_sink->set_y_axis(-1.5, 1.5);
+        time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
+        time_sink->enable_grid(true);
+        time_sink->set_y_label("Amplitud", "");
+        time_sink->set_line_label(0, "I");
+        time_sink->set_line_color(0, "blue");
+        time_sink->set_line_label(1, "Q");
+        time_sink->enable_control_panel(true);
+        time_sink->enable_tags(0, false);
+
+        // Mostrar GUI (primera estación)
+        time_sink->qwidget()->show();
+        tb_vista->connect(vista, 0, time_sink, 0);
+        tb->connect(mults[0], 0, tap, 0);
+    }
 
     // Conectar bloques
 
-    // Mezclar la señal MSK con el oscilador complejo
-    tb->connect(soundcard, 0, freq_xlating, 0);
-    tb->connect(freq_xlating,0,mult,0);
-    tb->connect(freq_xlating,0,mult,1);
-    tb->connect(mult, 0, c2ff, 0);
-    tb->connect(c2ff, 0, goertzel, 0);
-    tb->connect(goertzel, 0, printer, 0);
-    tb->connect(mult, 0, time_sink, 0);
+    // Llevar las portadoras a banda base
+    std::unique_ptr<registro_latencia> latencia;
+    if (latencia_cada > 0) {
+        // Etiquetas de tiempo tras la captura y una sonda a la salida de cada
+        // etapa de la primera estación
+        latencia.reset(new registro_latencia(samp_rate, latencia_cada));
+        auto tagger = latencia->tagger(sizeof(float));
+        tb->connect(soundcard, 0, tagger, 0);
+        tb->connect(tagger, 0, canalizador, 0);
+        tb->connect(canalizador, 0, latencia->sonda("pfb_frontend", sizeof(gr_complex)), 0);
+        tb->connect(mults[0], 0, latencia->sonda("multiply", sizeof(gr_complex)), 0);
+        tb->connect(goertzels[0], 0, latencia->sonda("sliding_goertzel", sizeof(gr_complex)), 0);
+    } else {
+        tb->connect(soundcard, 0, canalizador, 0);
+    }
+    std::vector<gr::basic_block_sptr> bloques = { soundcard, canalizador };
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        tb->connect(canalizador, s, mults[s], 0);
+        tb->connect(canalizador, s, mults[s], 1);
+        tb->connect(mults[s], 0, goertzels[s], 0);
+        tb->connect(goertzels[s], 0, printers[2 * s], 0);
+        tb->connect(goertzels[s], 1, printers[2 * s + 1], 0);
+        bloques.insert(bloques.end(), { mults[s], goertzels[s], printers[2 * s], printers[2 * s + 1] });
+    }
+
+    if (tap) {
+        bloques.push_back(tap);
+    }
+    if (latencia) {
+        const auto extra = latencia->bloques();
+        bloques.insert(bloques.end(), extra.begin(), extra.end());
+    }
+    sched.aplicar(tb, bloques);
 
 //    tb->connect(soundcard, 0, time_sink, 0);
    
-    // Iniciar flujo
-    tb->start();
+    if (headless) {
+        // Captura en vivo hasta recibir una señal de terminación
+        ejecutar_headless(tb, soundcard, samp_rate, false);
+    } else {
+        // Iniciar flujo y el de la gráfica
+        tb->start();
+        tb_vista->start();
+
+        // Correr loop de Qt
+        app->exec();
+
+        // Detener flujos cuando se cierre la ventana de Qt
+        tb_vista->stop();
+        tb->stop();
+        tb_vista->wait();
+        tb->wait();
+
+        std::cout << "Cuadros de la gráfica: " << tap->cuadros()
+                  << ", descartados: " << tap->descartados() << std::endl;
+    }
 
-    // Correr loop de Qt
-    app.exec();
+    if (latencia) {
+        latencia->escribir("latencia_msk_phase.csv");
+    }
 
-    // Detener flujo cuando se cierre la ventana de Qt
-    tb->stop();
-    tb->wait();
+    uint64_t escritos = 0, descartados = 0;
+    for (const auto& p : printers) {
+        escritos += p->escritos();
+        descartados += p->descartados();
+    }
+    std::cout << "Registros de fase escritos: " << escritos << ", descartados: " << descartados
+              << std::endl;
+    if (shm_src) {
+        std::cout << "Anillo '" << shm << "': " << shm_src->perdidas() << " muestras perdidas en "
+                  << shm_src->huecos() << " huecos." << std::endl;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -3,169 +3,393 @@
 #include <chrono>
 
 #include <gnuradio/top_block.h>
-#include <gnuradio/analog/sig_source.h>
 #include <gnuradio/blocks/wavfile_source.h>
-#include <gnuradio/blocks/complex_to_float.h>
-#include <gnuradio/blocks/float_to_complex.h>
-#include <gnuradio/digital/cpmmod_bc.h>
-#include <gnuradio/filter/fir_filter_blk.h>
-#include <gnuradio/filter/firdes.h>
 #include <gnuradio/blocks/multiply.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <algorithm>
+#include <atomic>
 #include <complex>
-#include <gnuradio/fft/goertzel_fc.h>
-#include <gnuradio/sync_block.h>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <gnuradio/qtgui/time_sink_c.h>
 #include <QWidget>
 #include <QApplication>
 
-// Bloque personalizado para imprimir la amplitud y fase de la señal
-// Hereda de gr::sync_block para integrarse en el flujo de GNU Radio
-class print_block : public gr::sync_block {
-public:
-    // Definición de tipo para shared_ptr
-    typedef std::shared_ptr<print_block> sptr;
-    // Método estático para crear instancias del bloque
-    static sptr make() {
-        return gnuradio::get_initial_sptr(new print_block());
+#include "../bloques/ddc_frontend.h"
+#include "../bloques/display_tap.h"
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/opciones_scheduler.h"
+#include "../bloques/phase_logger.h"
+#include "../bloques/sliding_goertzel.h"
+#include "../bloques/wav_file.h"
+
+// Parámetros del demodulador
+const float fc = 800;               // Frecuencia de la portadora (Hz)
+const float lpf_cutoff = 400.0f;    // Frecuencia de corte
+const float lpf_trans  = 200.0f;    // Ancho de transición
+const float goertzel_freq = 100.0f; // Frecuencia de interés
+const char* archivo_fase_neg = "fase_menos_100Hz.csv";
+
+// Bloques de la cadena de demodulación
+struct demodulador {
+    ddc_frontend::sptr frontend;
+    gr::blocks::multiply_cc::sptr mult;
+    sliding_goertzel::sptr goertzel;
+};
+
+// muestra_inicial: índice en el archivo de la primera muestra que entra
+// (distinto de 0 solo en el modo por bloques)
+demodulador crear_demodulador(int samp_rate, uint64_t muestra_inicial = 0) {
+    demodulador d;
+
+    // Mezcla con el oscilador y filtro pasa bajas de 400 Hz en un solo bloque.
+    // La decimación se elige a partir del corte; el factor de sobremuestreo 2
+    // deja espacio para el cuadrado de la señal, que duplica su ancho de banda.
+    d.frontend = ddc_frontend::make(samp_rate, fc, lpf_cutoff, lpf_trans, 2.0, muestra_inicial);
+
+    // Tasa de los bloques que siguen al front-end
+    const double bb_rate = d.frontend->tasa_salida();
+
+    // Multiplicador para cuadrado de la señal
+    d.mult = gr::blocks::multiply_cc::make();
+
+    // DFT deslizante para obtención de fase: los tonos en +/-100 Hz de la señal
+    // al cuadrado, con ventana de 0.5 s y una actualización cada 0.1 s
+    const int batch_samples = static_cast<int>(bb_rate * 0.5); // 0.5 segundos
+    const int hop_samples = static_cast<int>(bb_rate * 0.1);   // 0.1 segundos
+    d.goertzel = sliding_goertzel::make(bb_rate, { goertzel_freq, -goertzel_freq },
+                                        batch_samples, hop_samples,
+                                        muestra_inicial / d.frontend->decimation());
+    return d;
+}
+
+// Bajar la señal MSK a banda base, elevar al cuadrado y tomar la DFT
+void conectar_demodulador(gr::top_block_sptr tb, gr::basic_block_sptr fuente, const demodulador& d) {
+    tb->connect(fuente, 0, d.frontend, 0);
+    tb->connect(d.frontend, 0, d.mult, 0);
+    tb->connect(d.frontend, 0, d.mult, 1);
+    tb->connect(d.mult, 0, d.goertzel, 0);
+}
+
+// Salidas de la DFT: fase en +100 Hz y en -100 Hz
+struct fases {
+    std::vector<gr_complex> pos, neg;
+};
+
+// Modo por bloques (--hilos): el archivo se parte en tramos de saltos
+// consecutivos de la DFT y cada hilo procesa tramos completos en su propio
+// flujo. Cada tramo empieza unos saltos antes (calentamiento) para llenar la
+// historia del FIR y la ventana de la DFT, y esas salidas se descartan. Como
+// el NCO del front-end y los osciladores de la DFT toman su fase del índice
+// absoluto de la muestra, las salidas que quedan coinciden con las del flujo
+// completo (salvo el redondeo del producto punto de VOLK, que depende de la
+// alineación; ver --verificar) y se concatenan en orden.
+// Un error en un hilo (lectura, flujo) se relanza aquí.
+fases demodular_por_bloques(const wav_file& wav, int hilos, double segundos_bloque) {
+    const int samp_rate = wav.sample_rate();
+
+    // Geometría de la cadena (bloques de prueba, sin conectar)
+    const demodulador prueba = crear_demodulador(samp_rate);
+    const uint64_t D = prueba.frontend->decimation();
+    const uint64_t H = prueba.goertzel->salto();
+    const uint64_t L = D * H; // muestras del archivo por salto
+    const uint64_t historia = (prueba.frontend->ntaps() - 1 + D - 1) / D;
+    const uint64_t calentamiento = (prueba.goertzel->ventana() + historia + H - 1) / H - 1;
+
+    const uint64_t total_saltos = wav.num_frames() / L;
+    const uint64_t saltos_bloque = std::max<uint64_t>(
+        1, std::llround(segundos_bloque * prueba.frontend->tasa_salida() / H));
+    const uint64_t nbloques = (total_saltos + saltos_bloque - 1) / saltos_bloque;
+
+    std::cout << "Orden del filtro FIR: " << prueba.frontend->ntaps() - 1
+              << ", decimación: " << D
+              << " (" << prueba.frontend->tasa_salida() << " Hz en banda base)" << std::endl;
+    std::cout << "Procesando " << nbloques << " bloques de " << saltos_bloque * L
+              << " muestras en " << hilos << " hilos (" << calentamiento
+              << " saltos de calentamiento por bloque)" << std::endl;
+
+    struct resultado {
+        fases f;
+        std::exception_ptr error;
+        bool listo = false;
+    };
+    std::vector<resultado> resultados(nbloques);
+    std::mutex mutex;
+    std::condition_variable terminado;
+    std::atomic<uint64_t> siguiente{ 0 };
+
+    auto trabajador = [&]() {
+        for (uint64_t k; (k = siguiente.fetch_add(1)) < nbloques;) {
+            resultado r;
+            try {
+                const uint64_t h0 = k * saltos_bloque;
+                const uint64_t h1 = std::min(total_saltos, h0 + saltos_bloque);
+                const uint64_t hs = h0 > calentamiento ? h0 - calentamiento : 0;
+
+                std::vector<float> muestras((h1 - hs) * L);
+                wav.leer(0, hs * L, muestras.size(), muestras.data());
+
+                auto tb = gr::make_top_block("bloque");
+                auto fuente = gr::blocks::vector_source_f::make(muestras);
+                const demodulador d = crear_demodulador(samp_rate, hs * L);
+                auto sink_pos = gr::blocks::vector_sink_c::make();
+                auto sink_neg = gr::blocks::vector_sink_c::make();
+                conectar_demodulador(tb, fuente, d);
+                tb->connect(d.goertzel, 0, sink_pos, 0);
+                tb->connect(d.goertzel, 1, sink_neg, 0);
+                tb->run();
+
+                // Quitar las salidas de calentamiento
+                r.f.pos = sink_pos->data();
+                r.f.neg = sink_neg->data();
+                r.f.pos.erase(r.f.pos.begin(), r.f.pos.begin() + (h0 - hs));
+                r.f.neg.erase(r.f.neg.begin(), r.f.neg.begin() + (h0 - hs));
+            } catch (...) {
+                // Una excepción fuera del hilo llamaría a std::terminate
+                r.error = std::current_exception();
+            }
+            r.listo = true;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            resultados[k] = std::move(r);
+            terminado.notify_one();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < hilos; i++) {
+        pool.emplace_back(trabajador);
     }
 
-    // Constructor: define nombre y firmas de entrada/salida
-    print_block()
-        : gr::sync_block("print_block",
-                         gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                         gr::io_signature::make(0, 0, 0)) {}
-
-    // Método principal de procesamiento del bloque
-    // Imprime amplitud y fase de cada muestra recibida
-    int work(int noutput_items,
-             gr_vector_const_void_star &input_items,
-             gr_vector_void_star &) override {
-        const gr_complex *in = (const gr_complex*) input_items[0];
-        for (int i = 0; i < noutput_items; i++) {
-            float amplitude = 2*std::abs(in[i]);
-            float phase_rad = std::arg(in[i]);
-            float phase_deg = phase_rad * 180.0f / M_PI; // Conversión a grados
-            std::cout << "Amplitud: " << amplitude << ", Fase: " << phase_deg << " grados" << std::endl;
+    // Concatenar en orden conforme terminan los bloques
+    fases salida;
+    std::exception_ptr error;
+    for (uint64_t k = 0; k < nbloques && !error; k++) {
+        std::unique_lock<std::mutex> lock(mutex);
+        terminado.wait(lock, [&] { return resultados[k].listo; });
+        if (resultados[k].error) {
+            // Los hilos dejan de tomar bloques; se relanza después de join()
+            error = resultados[k].error;
+            siguiente.store(nbloques);
+            break;
         }
-        return noutput_items;
+        salida.pos.insert(salida.pos.end(), resultados[k].f.pos.begin(), resultados[k].f.pos.end());
+        salida.neg.insert(salida.neg.end(), resultados[k].f.neg.begin(), resultados[k].f.neg.end());
+        resultados[k].f = {};
     }
-};
+    for (auto& t : pool) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return salida;
+}
 
+// El flujo completo de un solo hilo, como en --headless, con las salidas en memoria
+fases demodular_completo(const std::string& archivo) {
+    auto tb = gr::make_top_block("referencia");
+    auto wav_source = gr::blocks::wavfile_source::make(archivo.c_str(), false);
+    const demodulador d = crear_demodulador(wav_source->sample_rate());
+    auto sink_pos = gr::blocks::vector_sink_c::make();
+    auto sink_neg = gr::blocks::vector_sink_c::make();
+    conectar_demodulador(tb, wav_source, d);
+    tb->connect(d.goertzel, 0, sink_pos, 0);
+    tb->connect(d.goertzel, 1, sink_neg, 0);
+    tb->run();
+    return { sink_pos->data(), sink_neg->data() };
+}
 
-int main(int argc, char** argv) {
+// Diferencia máxima entre dos salidas, relativa a la mayor magnitud de la
+// referencia (los bins casi en cero no cuentan como error grande)
+double diferencia_relativa(const std::vector<gr_complex>& a, const std::vector<gr_complex>& ref) {
+    double dif = 0.0, escala = 0.0;
+    for (size_t i = 0; i < std::min(a.size(), ref.size()); i++) {
+        dif = std::max(dif, double(std::abs(a[i] - ref[i])));
+        escala = std::max(escala, double(std::abs(ref[i])));
+    }
+    return escala > 0.0 ? dif / escala : dif;
+}
 
-    /*************************************************/
-    /*     Generación de flujo de bits aleatorios    */
-    /*************************************************/
+// Tolerancia de --verificar: el redondeo del FIR de VOLK con otra alineación
+// queda varios órdenes de magnitud por debajo
+const double TOLERANCIA_BLOQUES = 1e-4;
 
-     // Inicializar Qt GUI
-     QApplication app(argc, argv);
-     auto tb = gr::make_top_block("MSK en banda base");
+int procesar_por_bloques(const std::string& archivo, int hilos, double segundos_bloque, bool verificar) {
+    const wav_file wav(archivo);
+    const int samp_rate = wav.sample_rate();
 
-    // Fuente WAV
-    auto wav_source = gr::blocks::wavfile_source::make("msk_800_Hz_200_bps.wav", false); // true: repetir
+    const auto t0 = std::chrono::steady_clock::now();
+    const fases f = demodular_por_bloques(wav, hilos, segundos_bloque);
+    const double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
-    // Leer tasa de muestreo del archivo
-    // (nota: los objetos de bloque son shared_ptr's)
-    const int samp_rate = wav_source->sample_rate();
+    if (verificar) {
+        // Misma salida que el flujo de un solo hilo, dentro de la tolerancia
+        const auto t1 = std::chrono::steady_clock::now();
+        const fases ref = demodular_completo(archivo);
+        const double segundos_ref =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+        const double dif = std::max(diferencia_relativa(f.pos, ref.pos), diferencia_relativa(f.neg, ref.neg));
+        const bool mismas = f.pos.size() == ref.pos.size() && f.neg.size() == ref.neg.size();
+        const bool ok = mismas && dif <= TOLERANCIA_BLOQUES;
+        std::cout << "Salidas por bloques: " << f.pos.size() << ", flujo completo: " << ref.pos.size()
+                  << ", diferencia relativa máxima: " << dif << " (tolerancia " << TOLERANCIA_BLOQUES << ")"
+                  << std::endl;
+        std::cout << "Tiempo por bloques: " << segundos << " s, flujo completo: " << segundos_ref
+                  << " s (" << segundos_ref / segundos << "x)" << std::endl;
+        std::cout << (ok ? "Coinciden." : "NO coinciden.") << std::endl;
+        return ok ? 0 : 1;
+    }
 
-    // Sumador y convertidores de componentes IQ a FI
-    auto c2ff   = gr::blocks::complex_to_float::make();
+    // Registro con los mismos sumideros que el flujo completo
+    auto tb = gr::make_top_block("registro");
+    auto printer = phase_logger::make(phase_logger::formato::CONSOLA);
+    auto printer_neg = phase_logger::make(phase_logger::formato::CSV, archivo_fase_neg);
+    tb->connect(gr::blocks::vector_source_c::make(f.pos), 0, printer, 0);
+    tb->connect(gr::blocks::vector_source_c::make(f.neg), 0, printer_neg, 0);
+    tb->run();
 
-    // Bloque Goertzel para obtención de fase
-    const float goertzel_freq = 100.0f; // Frecuencia de interés
-    const int batch_samples = static_cast<int>(samp_rate * 0.5); // 0.5 segundos
-    auto goertzel = gr::fft::goertzel_fc::make(samp_rate, batch_samples, goertzel_freq);
+    std::cout << "Registros de fase escritos: " << printer->escritos()
+              << ", descartados: " << printer->descartados() << std::endl;
+    imprimir_resumen(wav.num_frames(), samp_rate, segundos);
+    return 0;
+}
 
-    // Conversión de Frecuencia Intermedia (IF) a Banda Base
-    const float fc = 800; // Frecuencia de la portadora (Hz)
-    auto mixer_osc = gr::analog::sig_source_c::make(samp_rate, gr::analog::GR_COS_WAVE, fc, 1.0, 0.0);
+// Uso: ./msk_phase_wav [--headless] [--hilos N [--bloque segundos] [--verificar]] [archivo.wav]
+// Con --headless no se abre ventana y el archivo se procesa a toda velocidad.
+// Con --hilos el archivo se procesa sin ventana en N hilos, por bloques de
+// 'segundos' de señal (60 por omisión); la salida es la del flujo completo.
+// Con --verificar, en lugar de registrar las fases, también corre el flujo
+// completo de un solo hilo, compara las salidas (diferencia relativa máxima
+// TOLERANCIA_BLOQUES), reporta ambos tiempos y termina con 1 si no coinciden.
+// Las opciones --gr-* de bloques/opciones_scheduler.h aplican al flujo
+// normal (sin --hilos).
+// Con ventana, la gráfica se alimenta desde un display_tap
+// (bloques/display_tap.h) en un flujo aparte: el archivo se procesa a toda
+// velocidad y se muestra el cuadro más reciente.
+int main(int argc, char** argv) {
 
-    // Multiplicador complejo para mezclar la señal MSK con el oscilador
-    auto mixer = gr::blocks::multiply_cc::make();
+    const bool headless = tomar_opcion(argc, argv, "--headless");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+    const int hilos = static_cast<int>(tomar_valor(argc, argv, "--hilos", 0));
+    const double segundos_bloque = tomar_valor(argc, argv, "--bloque", 60.0);
+    const bool verificar = tomar_opcion(argc, argv, "--verificar");
+    const std::string archivo = argc > 1 ? argv[1] : "msk_800_Hz_200_bps.wav";
 
-    // IQ demodulator
-    auto ff2c = gr::blocks::float_to_complex::make();
-    auto zero_src  = gr::analog::sig_source_f::make(samp_rate, gr::analog::GR_CONST_WAVE, 0, 0.0, 0.0);
+    if (hilos > 0) {
+        try {
+            return procesar_por_bloques(archivo, hilos, segundos_bloque, verificar);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-    // Multiplicador para cuadrado de la señal
-    auto mult = gr::blocks::multiply_cc::make();
+    // Inicializar Qt GUI (solo si hay ventana)
+    std::unique_ptr<QApplication> app;
+    if (!headless) {
+        app.reset(new QApplication(argc, argv));
+    }
+    auto tb = gr::make_top_block("MSK en banda base");
 
-    // Bloque a la medida para imprimir la fase
-    auto printer = print_block::make();
+    // Fuente WAV
+    auto wav_source = gr::blocks::wavfile_source::make(archivo.c_str(), false); // true: repetir
+
+    // Leer tasa de muestreo del archivo
+    // (nota: los objetos de bloque son shared_ptr's)
+    const int samp_rate = wav_source->sample_rate();
 
     /************************************************/
-    /*          Filtro para demodulador             */
+    /*     Conversión a banda base y demodulación   */
     /************************************************/
+    const demodulador demod = crear_demodulador(samp_rate);
+    const double bb_rate = demod.frontend->tasa_salida();
 
-    // Filtro pasa bajas de 400 Hz
-    // Diseño de filtro FIR
-    const float lpf_cutoff = 400.0f;  // Frecuencia de corte
-    const float lpf_trans  = 200.0f;  // Ancho de transición
-    auto taps = gr::filter::firdes::low_pass(
-                                     1.0, 
-                                     samp_rate,
-                                     lpf_cutoff, 
-                                     lpf_trans, 
-                                     gr::fft::window::win_type::WIN_HAMMING
-                                   );
-    // Convert to complex taps
-    std::vector<gr_complex> complex_taps;
-    for (auto t : taps) {
-        complex_taps.push_back(gr_complex(t, 0.0f));
-    }
+    std::cout << "Orden del filtro FIR: " << demod.frontend->ntaps() - 1
+              << ", decimación: " << demod.frontend->decimation()
+              << " (" << bb_rate << " Hz en banda base)" << std::endl;
 
-    std::cout << "Orden del filtro FIR: " << complex_taps.size() - 1 << std::endl;
-    auto lpf = gr::filter::fir_filter_ccc::make(1, complex_taps);
+    // Registro de amplitud y fase (la E/S ocurre en un hilo aparte):
+    // +100 Hz a consola, -100 Hz a CSV
+    auto printer = phase_logger::make(phase_logger::formato::CONSOLA);
+    auto printer_neg = phase_logger::make(phase_logger::formato::CSV, archivo_fase_neg);
 
     /*************************************************/
     /*              Sumidero  GUI                    */
     /*************************************************/
 
     // Crear visualizador en tiempo (QT GUI Time Sink)
-    const int size = 1024; // Muestras para mostrar
-    //const double samp_rate = 1000.0; 
-    const std::string name = "MSK en Banda Base";
-    const unsigned int nconnections = 1;
-
-    auto time_sink = gr::qtgui::time_sink_c::make(size, samp_rate, name, nconnections, nullptr);
-    time_sink->set_update_time(0.10);    
-    time_sink->set_y_axis(-1.5, 1.5);   
-    time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
-    time_sink->enable_grid(true);
-    time_sink->set_y_label("Amplitud", "");
-    time_sink->set_line_label(0, "Bitstream");
-    time_sink->set_line_color(0, "blue");
-    time_sink->enable_control_panel(true);
-    time_sink->enable_tags(0, false);
-
-    // Mostrar GUI
-    time_sink->qwidget()->show();
+    gr::top_block_sptr tb_vista;
+    display_tap_c::sptr tap;
+    if (!headless) {
+        const int size = 1024; // Muestras para mostrar
+        const std::string name = "MSK en Banda Base";
+        const unsigned int nconnections = 1;
+
+        // Un cuadro de 'size' muestras cada 0.1 s de señal; el time_sink lo
+        // toma en su propio flujo
+        tap = display_tap_c::make(bb_rate, size, 0.10);
+        tb_vista = gr::make_top_block("Vista MSK en banda base");
+        auto vista = display_source_c::make(tap);
+
+        auto time_sink = gr::qtgui::time_sink_c::make(size, tap->tasa_vista(), name, nconnections, nullptr);
+        time_sink->set_update_time(0.10);
+        time_sink->set_y_axis(-1.5, 1.5);
+        time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
+        time_sink->enable_grid(true);
+        time_sink->set_y_label("Amplitud", "");
+        time_sink->set_line_label(0, "Bitstream");
+        time_sink->set_line_color(0, "blue");
+        time_sink->enable_control_panel(true);
+        time_sink->enable_tags(0, false);
+
+        // Mostrar GUI
+        time_sink->qwidget()->show();
+        tb_vista->connect(vista, 0, time_sink, 0);
+        tb->connect(demod.mult, 0, tap, 0);
+    }
 
     // Conectar bloques
-  
-    // Mezclar la señal MSK con el oscilador complejo
-    tb->connect(wav_source, 0, ff2c, 0);
-    tb->connect(zero_src,   0, ff2c, 1); // Parte imaginaria en cero
-    tb->connect(ff2c, 0, mixer, 0);
-    tb->connect(mixer_osc, 0, mixer, 1);
-    tb->connect(mixer, 0, lpf,0);
-    tb->connect(lpf,0,mult,0);
-    tb->connect(lpf,0,mult,1);
-    tb->connect(mult, 0, c2ff, 0);
-    tb->connect(c2ff, 0, goertzel, 0);
-    tb->connect(goertzel, 0, printer, 0);
-    tb->connect(mult, 0, time_sink, 0);
-   
-    // Iniciar flujo
-    tb->start();
-
-    // Correr loop de Qt
-    app.exec();
-
-    // Detener flujo cuando se cierre la ventana de Qt
-    tb->stop();
-    tb->wait();
+    conectar_demodulador(tb, wav_source, demod);
+    tb->connect(demod.goertzel, 0, printer, 0);
+    tb->connect(demod.goertzel, 1, printer_neg, 0);
+    std::vector<gr::basic_block_sptr> bloques = {
+        wav_source, demod.frontend, demod.mult, demod.goertzel, printer, printer_neg
+    };
+    if (tap) {
+        bloques.push_back(tap);
+    }
+    sched.aplicar(tb, bloques);
+
+    if (headless) {
+        // Procesar el archivo completo sin GUI ni throttle
+        ejecutar_headless(tb, wav_source, samp_rate, true);
+    } else {
+        // Iniciar flujo y el de la gráfica
+        tb->start();
+        tb_vista->start();
+
+        // Correr loop de Qt
+        app->exec();
+
+        // Detener flujos cuando se cierre la ventana de Qt
+        tb_vista->stop();
+        tb->stop();
+        tb_vista->wait();
+        tb->wait();
+
+        std::cout << "Cuadros de la gráfica: " << tap->cuadros()
+                  << ", descartados: " << tap->descartados() << std::endl;
+    }
+
+    std::cout << "Registros de fase escritos: " << printer->escritos()
+              << ", descartados: " << printer->descartados() << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,120 +1,506 @@
+// msk_wav_generator.cpp
+// Genera archivos WAV con bits aleatorios modulados en MSK sobre una
+// portadora en FI (msk_if_modulator [+ polyphase_resampler] + wav_sink).
+//
+// La tasa de bits es exacta para cualquier sample_rate: si sample_rate/bps es
+// entero se modula directo a sample_rate; si no (44100 Hz a 200 bps daría
+// 220.5 muestras por bit), se modula con un sps entero pequeño y un
+// remuestreador polifásico racional lleva la señal a sample_rate.
+//
+// Uso: ./msk_wav_generator [opciones] <duración_segundos> <sample_rate> <archivo_wav>
+//      ./msk_wav_generator [opciones] --lote manifiesto.txt
+//      ./msk_wav_generator [opciones] --rejilla "semilla=1:100 fs=44100,48000 bps=200 fc=800 dur=60"
+//
+// Opciones:
+//   --semilla N    semilla de los bits (un archivo); con 0 GNU Radio la toma del reloj
+//   --bps B        tasa de bits (200 por omisión; un archivo)
+//   --fc F         portadora en Hz (800 por omisión; un archivo)
+//   --sps N        muestras por bit del modulador, siempre con remuestreo
+//                  (automático por omisión)
+//   --pcm24 | --pcm32 | --float   formato del archivo (PCM de 16 bits por omisión)
+//   --dither       dither TPDF al convertir a PCM
+//   --hilos N      trabajos simultáneos en modo por lotes (todos los núcleos por omisión)
+//   --dir D        directorio de los archivos de --rejilla y del índice ("." por omisión)
+//   --gr-...       opciones del scheduler (bloques/opciones_scheduler.h; un archivo)
+//
+// Modo por lotes: cada trabajo (archivo, duración, fs, semilla, bps, fc) corre
+// en su propio flujo en un grupo de hilos. Las tablas de fase del modulador
+// y el banco del remuestreador se calculan una vez por configuración (fs,
+// bps, fc) y se comparten entre los trabajos. El manifiesto tiene una línea por archivo:
+//   archivo duración_s sample_rate [semilla] [bps] [fc]
+// (líneas vacías y con '#' se ignoran). --rejilla genera el producto
+// cartesiano de las listas dadas (valores separados por comas, o rangos
+// enteros a:b) con nombres msk_s<semilla>_fs<fs>_b<bps>_fc<fc>_d<dur>.wav.
+// En lote la semilla nunca se toma del reloj: sin semilla (o con 0) se usa
+// un hash del nombre del archivo, así que el lote se puede regenerar.
+// Al terminar se escribe <dir>/indice.csv con los parámetros (incluida la
+// semilla usada), el número de muestras y el CRC-32 (el de zlib) de cada archivo.
+
 #include <iostream>
 #include <thread>
 #include <chrono>
 
 #include <gnuradio/random.h>
 #include <gnuradio/top_block.h>
-#include <gnuradio/analog/sig_source.h>
 #include <gnuradio/analog/random_uniform_source.h>
-#include <gnuradio/blocks/uchar_to_float.h>
-#include <gnuradio/blocks/float_to_char.h>
-#include <gnuradio/blocks/add_const_ff.h>
-#include <gnuradio/blocks/multiply_const.h>
-#include <gnuradio/blocks/complex_to_float.h>
-#include <gnuradio/digital/cpmmod_bc.h>
-#include <gnuradio/blocks/multiply.h>
-#include <gnuradio/blocks/head.h>
-#include <gnuradio/blocks/wavfile_sink.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
 
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/msk_if_modulator.h"
+#include "../bloques/opciones_scheduler.h"
+#include "../bloques/polyphase_resampler.h"
+#include "../bloques/wav_sink.h"
 
-int main(int argc, char** argv) {
+// Fases del remuestreador como máximo (el banco ocupa interp * taps por fase)
+const int64_t MAX_INTERP = 4096;
 
-    /*************************************************/
-    /*   Parámetros por línea de comandos (CLI)      */
-    /*************************************************/
-    if (argc < 4) {
-        std::cerr << "Uso: " << argv[0] << " <duración_segundos> <sample_rate> <archivo_wav> " << std::endl;
-        return 1;
+// Un archivo a generar
+struct trabajo {
+    std::string archivo;
+    double duracion;
+    double samp_rate;
+    unsigned semilla = 0;
+    double bit_rate = 200.0;
+    double fc = 800.0;
+};
+
+// Resultado de un trabajo, para el índice
+struct resultado {
+    uint64_t muestras = 0;
+    uint32_t crc = 0;
+    std::string error;
+};
+
+// Cómo se genera la señal de un trabajo: el modulador trabaja a
+// fs_mod = sps * bit_rate (sps entero) y, si fs_mod no es la tasa del
+// archivo, un remuestreador polifásico interp/decim la lleva a samp_rate.
+// Las tablas y el banco se comparten entre trabajos con la misma configuración.
+struct diseno {
+    int sps = 0;
+    int interp = 1;
+    int decim = 1;
+    std::shared_ptr<const msk_if_modulator::tablas> tablas;
+    std::shared_ptr<const polyphase_resampler::banco> banco; // nullptr sin remuestreo
+
+    // Tasa de bits que queda en el archivo
+    double bps_efectivo(double samp_rate) const { return samp_rate * decim / interp / sps; }
+};
+
+// Hz en milésimas enteras, para la relación exacta entre tasas
+int64_t milesimas(double hz, const char* nombre) {
+    const double m = hz * 1000.0;
+    if (hz <= 0 || std::fabs(m - std::round(m)) > 1e-6 * m) {
+        throw std::invalid_argument(std::string(nombre) + " debe ser positivo y múltiplo de 0.001 Hz");
     }
-    // Duración en segundos y nombre de archivo WAV
-    int duracion_segundos = std::stoi(argv[1]);
-    double samp_rate = std::stod(argv[2]);
-    const char*  archivo_wav = argv[3];
-    
+    return std::llround(m);
+}
 
-    /*************************************************/
-    /*     Generación de flujo de bits aleatorios    */
-    /*************************************************/
-    auto tb = gr::make_top_block("Stream de bits aleatorios");
+// sps_pedido: muestras por símbolo del modulador. Con 0 se modula directo a
+// samp_rate cuando samp_rate/bit_rate es entero (como antes) y si no se elige
+// un sps pequeño seguido del remuestreador.
+diseno disenar(const trabajo& t, int sps_pedido) {
+    // Banda ocupada: portadora más lóbulo principal y primeros laterales
+    const double banda = t.fc + 2 * t.bit_rate;
+    if (t.samp_rate <= 2 * banda) {
+        throw std::invalid_argument("sample_rate debe ser mayor que 2*(fc + 2*bps) = " +
+                                    std::to_string(2 * banda));
+    }
+    diseno d;
+    const double directo = t.samp_rate / t.bit_rate;
+    if (sps_pedido == 0 && std::fabs(directo - std::round(directo)) < 1e-9 * directo) {
+        d.sps = static_cast<int>(std::round(directo));
+        d.tablas = msk_if_modulator::disenar(d.sps, t.samp_rate, t.fc);
+        return d;
+    }
+
+    // samp_rate / (sps * bit_rate) = interp / decim, exacta. Sin sps pedido
+    // se prueba de 4 a 8 veces la banda y se toma el de menor interp (el
+    // banco más chico).
+    const int64_t fs = milesimas(t.samp_rate, "sample_rate");
+    const int64_t bps = milesimas(t.bit_rate, "bps");
+    const int minimo = sps_pedido > 0 ? sps_pedido : std::max(4, static_cast<int>(std::ceil(4 * banda / t.bit_rate)));
+    const int maximo = sps_pedido > 0 ? sps_pedido : 2 * minimo;
+    int64_t mejor = 0;
+    for (int sps = minimo; sps <= maximo; sps++) {
+        const int64_t g = std::gcd(fs, sps * bps);
+        if (mejor == 0 || fs / g < mejor) {
+            mejor = fs / g;
+            d.sps = sps;
+            d.decim = static_cast<int>(sps * bps / g);
+        }
+    }
+    if (mejor > MAX_INTERP) {
+        throw std::invalid_argument("la relación entre sample_rate y bps*sps requiere interp = " +
+                                    std::to_string(mejor) + " (máximo " + std::to_string(MAX_INTERP) + ")");
+    }
+    d.interp = static_cast<int>(mejor);
+
+    const double fs_mod = t.bit_rate * d.sps;
+    if (fs_mod <= 2 * banda) {
+        throw std::invalid_argument("--sps demasiado bajo: sps*bps debe ser mayor que 2*(fc + 2*bps)");
+    }
+    // Paso hasta la banda ocupada; rechazo desde la primera imagen del
+    // modulador (fs_mod - banda) o desde lo que se plegaría a la salida
+    // (samp_rate - banda), lo que esté antes
+    const double paso = banda / fs_mod;
+    const double rechazo = (std::min(fs_mod, t.samp_rate) - banda) / fs_mod;
+    d.tablas = msk_if_modulator::disenar(d.sps, fs_mod, t.fc);
+    d.banco = polyphase_resampler::disenar(d.interp, d.decim,
+                                           polyphase_resampler::disenar_taps(d.interp, paso, rechazo));
+    return d;
+}
+
+// Bits aleatorios -> modulador MSK [-> remuestreador] -> WAV. Regresa las
+// muestras escritas; lanza std::runtime_error si falló la escritura.
+uint64_t generar(const trabajo& t,
+                 const diseno& d,
+                 wav_sink::formato fmt,
+                 bool dither,
+                 const opciones_scheduler* sched = nullptr) {
+    auto tb = gr::make_top_block("msk_wav_generator");
 
     // Crear fuente de bits aleatorios (uint8_t)
-    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, 0); // (min, max, seed)
+    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, t.semilla); // (min, max, seed)
 
-    // Convertir enteros a flotantes: (+/-1)
-    auto uchar_to_float = gr::blocks::uchar_to_float::make();
-    auto map_to_bipolar = gr::blocks::add_const_ff::make(-0.5);     // 0/1 -> -0.5/0.5
+    // Modulación MSK (h = 0.5) y conversión a Frecuencia Intermedia (IF) en un
+    // solo bloque: bits 0/1 -> parte real de la señal MSK mezclada con fc.
+    // Equivale a cpmmod_bc(LREC, 0.5, sps, 1) + sig_source_c + multiply_cc +
+    // complex_to_float (ver msk_modulator_bench.cpp).
+    auto msk_mod = msk_if_modulator::make(d.tablas);
 
-    // Escalamiento adecuado para el modulador de fase
-    auto scale_to_pm = gr::blocks::multiply_const_ff::make(2.0); // -0.5/0.5 -> -1/+1
-    auto bb_pm       = gr::blocks::float_to_char::make();
+    // Conversión vectorizada y escritura en un hilo aparte; el sumidero
+    // termina el flujo al recibir todas las muestras (RF64 si pasa de 4 GB)
+    const uint64_t num_muestras = static_cast<uint64_t>(t.samp_rate * t.duracion);
+    auto wav = wav_sink::make(t.archivo, 1, t.samp_rate, fmt, dither, num_muestras);
+
+    tb->connect(rand_src, 0, msk_mod, 0);
+    if (d.banco) {
+        auto resampler = polyphase_resampler::make(d.banco);
+        tb->connect(msk_mod, 0, resampler, 0);
+        tb->connect(resampler, 0, wav, 0);
+        if (sched) {
+            sched->aplicar(tb, { rand_src, msk_mod, resampler, wav });
+        }
+    } else {
+        tb->connect(msk_mod, 0, wav, 0);
+        if (sched) {
+            sched->aplicar(tb, { rand_src, msk_mod, wav });
+        }
+    }
+    tb->run();
+    if (!wav->error().empty()) {
+        throw std::runtime_error(wav->error());
+    }
+    return wav->muestras_escritas();
+}
 
-    // Convertidor de componentes IQ a FI
-    auto c2ff   = gr::blocks::complex_to_float::make();
+// CRC-32 (polinomio 0xEDB88320, como zlib.crc32) del archivo completo
+uint32_t crc32_archivo(const std::string& nombre) {
+    static const auto tabla = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    std::FILE* f = std::fopen(nombre.c_str(), "rb");
+    if (!f) {
+        throw std::runtime_error("no se pudo leer " + nombre);
+    }
+    std::vector<uint8_t> buffer(1 << 20);
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t n;
+    while ((n = std::fread(buffer.data(), 1, buffer.size(), f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            crc = tabla[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+        }
+    }
+    std::fclose(f);
+    return crc ^ 0xFFFFFFFFu;
+}
 
-    /*************************************************/
-    /*              Modulador MSK                    */
-    /*************************************************/
-    const double bit_rate = 200.0;
+// Semilla de un trabajo por lotes sin semilla: FNV-1a de 32 bits del nombre
+// del archivo (nunca 0, que GNU Radio tomaría del reloj)
+unsigned semilla_de_nombre(const std::string& archivo) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : archivo) {
+        h = (h ^ c) * 16777619u;
+    }
+    return h ? h : 1;
+}
 
-    // samples_per_sym debe ser un entero
-    int samples_per_sym = static_cast<int>(std::round(samp_rate / bit_rate));
-    if (samples_per_sym <= 0) {
-        std::cerr << "Error: sample_rate demasiado bajo para bit_rate=" << bit_rate << std::endl;
-        return 1;
+// archivo duración_s sample_rate [semilla] [bps] [fc], una línea por trabajo
+std::vector<trabajo> leer_manifiesto(const std::string& archivo) {
+    std::ifstream f(archivo);
+    if (!f) {
+        throw std::runtime_error("no se pudo abrir " + archivo);
+    }
+    std::vector<trabajo> r;
+    std::string linea;
+    for (int n = 1; std::getline(f, linea); n++) {
+        const size_t inicio = linea.find_first_not_of(" \t\r");
+        if (inicio == std::string::npos || linea[inicio] == '#') {
+            continue;
+        }
+        std::istringstream ss(linea);
+        trabajo t;
+        if (!(ss >> t.archivo >> t.duracion >> t.samp_rate)) {
+            throw std::runtime_error(archivo + ":" + std::to_string(n) +
+                                     ": se esperaba 'archivo duración_s sample_rate [semilla] [bps] [fc]'");
+        }
+        ss >> t.semilla >> t.bit_rate >> t.fc;
+        r.push_back(t);
     }
+    return r;
+}
 
-    //const double samp_rate = bit_rate * samples_per_sym;
+// "1,2,5" o "1:10" (enteros, inclusive) o una mezcla: "1:4,10"
+std::vector<double> leer_lista(const std::string& texto) {
+    std::vector<double> r;
+    std::istringstream ss(texto);
+    std::string elemento;
+    while (std::getline(ss, elemento, ',')) {
+        const size_t dos_puntos = elemento.find(':');
+        if (dos_puntos == std::string::npos) {
+            r.push_back(std::stod(elemento));
+        } else {
+            const long a = std::stol(elemento.substr(0, dos_puntos));
+            const long b = std::stol(elemento.substr(dos_puntos + 1));
+            for (long v = a; v <= b; v++) {
+                r.push_back(v);
+            }
+        }
+    }
+    return r;
+}
+
+// "semilla=... fs=... bps=... fc=... dur=...": producto cartesiano
+std::vector<trabajo> expandir_rejilla(const std::string& rejilla, const std::string& dir) {
+    std::map<std::string, std::vector<double>> listas = {
+        { "semilla", { 1 } }, { "fs", { 48000 } }, { "bps", { 200 } }, { "fc", { 800 } }, { "dur", { 60 } }
+    };
+    std::istringstream ss(rejilla);
+    std::string par;
+    while (ss >> par) {
+        const size_t igual = par.find('=');
+        if (igual == std::string::npos || !listas.count(par.substr(0, igual))) {
+            throw std::invalid_argument("--rejilla: se esperaba semilla=, fs=, bps=, fc= o dur=, no '" + par + "'");
+        }
+        listas[par.substr(0, igual)] = leer_lista(par.substr(igual + 1));
+    }
+
+    std::vector<trabajo> r;
+    char nombre[160];
+    for (double semilla : listas["semilla"])
+        for (double fs : listas["fs"])
+            for (double bps : listas["bps"])
+                for (double fc : listas["fc"])
+                    for (double dur : listas["dur"]) {
+                        std::snprintf(nombre, sizeof(nombre), "msk_s%u_fs%g_b%g_fc%g_d%g.wav",
+                                      static_cast<unsigned>(semilla), fs, bps, fc, dur);
+                        trabajo t;
+                        t.archivo = dir + "/" + nombre;
+                        t.duracion = dur;
+                        t.samp_rate = fs;
+                        t.semilla = static_cast<unsigned>(semilla);
+                        t.bit_rate = bps;
+                        t.fc = fc;
+                        r.push_back(t);
+                    }
+    return r;
+}
+
+// Corre los trabajos en 'hilos' hilos y escribe el índice
+int procesar_lote(const std::vector<trabajo>& trabajos,
+                  int hilos,
+                  int sps_pedido,
+                  wav_sink::formato fmt,
+                  bool dither,
+                  const std::string& indice) {
+    // Tablas del modulador y banco del remuestreador, una vez por
+    // configuración y antes de arrancar los hilos (después solo se leen)
+    typedef std::tuple<double, double, double> clave;
+    std::map<clave, diseno> disenos;
+    std::vector<resultado> resultados(trabajos.size());
+    for (const trabajo& t : trabajos) {
+        const clave k(t.samp_rate, t.bit_rate, t.fc);
+        if (!disenos.count(k)) {
+            disenos[k] = disenar(t, sps_pedido);
+        }
+    }
+    std::cout << "Generando " << trabajos.size() << " archivos (" << disenos.size()
+              << " configuraciones del modulador) en " << hilos << " hilos..." << std::endl;
+
+    std::atomic<size_t> siguiente{ 0 };
+    std::atomic<size_t> terminados{ 0 };
+    std::mutex mutex_consola;
+    auto trabajador = [&]() {
+        for (size_t i; (i = siguiente.fetch_add(1)) < trabajos.size();) {
+            const trabajo& t = trabajos[i];
+            resultado& r = resultados[i];
+            try {
+                r.muestras = generar(t, disenos.at(clave(t.samp_rate, t.bit_rate, t.fc)), fmt, dither);
+                r.crc = crc32_archivo(t.archivo);
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            const size_t hechos = ++terminados;
+            std::lock_guard<std::mutex> lock(mutex_consola);
+            if (!r.error.empty()) {
+                std::cerr << t.archivo << ": " << r.error << std::endl;
+            } else if (hechos % 100 == 0 || hechos == trabajos.size()) {
+                std::cout << "  " << hechos << "/" << trabajos.size() << std::endl;
+            }
+        }
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < hilos; i++) {
+        pool.emplace_back(trabajador);
+    }
+    for (auto& h : pool) {
+        h.join();
+    }
+    const double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
-    auto msk_mod = gr::digital::cpmmod_bc::make(
-        gr::analog::cpm::LREC, /* tipo de pulso rectangular -> MSK */
-        0.5,                   // h = 0.5 para MSK
-        samples_per_sym,       // muestras por símbolo
-        1                      // L=1 -> full response
-                               // beta no se usa en LREC
-    );
+    // Índice en el orden de los trabajos
+    std::FILE* f = std::fopen(indice.c_str(), "w");
+    if (!f) {
+        std::cerr << "No se pudo escribir " << indice << std::endl;
+        return 1;
+    }
+    std::fputs("archivo,semilla,sample_rate,bps,bps_efectivo,fc,duracion_s,muestras,crc32\n", f);
+    int errores = 0;
+    double muestras_totales = 0;
+    for (size_t i = 0; i < trabajos.size(); i++) {
+        const trabajo& t = trabajos[i];
+        const resultado& r = resultados[i];
+        if (!r.error.empty()) {
+            errores++;
+            continue;
+        }
+        const diseno& d = disenos.at(clave(t.samp_rate, t.bit_rate, t.fc));
+        std::fprintf(f, "%s,%u,%g,%g,%.6g,%g,%g,%llu,%08x\n", t.archivo.c_str(), t.semilla, t.samp_rate,
+                     t.bit_rate, d.bps_efectivo(t.samp_rate), t.fc, t.duracion, (unsigned long long)r.muestras,
+                     r.crc);
+        muestras_totales += r.muestras;
+    }
+    std::fclose(f);
 
-    // Conversión Banda Base a Frecuencia Intermedia (IF)
-    const float fc = 800; // Frecuencia de la portadora (Hz)
-    auto mixer_osc = gr::analog::sig_source_c::make(samp_rate, gr::analog::GR_COS_WAVE, fc, 1.0, 0.0);
+    std::cout << "Lote terminado en " << segundos << " s: " << trabajos.size() - errores
+              << " archivos, " << muestras_totales / segundos / 1e6 << " Mmuestras/s; índice en "
+              << indice << std::endl;
+    return errores ? 1 : 0;
+}
 
-    // Multiplicador complejo para mezclar la señal MSK con el oscilador
-    auto mixer = gr::blocks::multiply_cc::make();
+int main(int argc, char** argv) {
 
     /*************************************************/
-    /*        Limitador de muestras y sumidero       */
+    /*   Parámetros por línea de comandos (CLI)      */
     /*************************************************/
-    // Calcular número total de muestras
-    int num_muestras = static_cast<int>(samp_rate * duracion_segundos);
-
-    // Limitador de muestras
-    auto head = gr::blocks::head::make(sizeof(float), num_muestras);
-
-    // Sink WAV para la señal
-    auto wav_sink = gr::blocks::wavfile_sink::make(archivo_wav,
-                                                   1, /* Canales*/
-                                                   static_cast<int>(samp_rate),
-                                                   gr::blocks::FORMAT_WAV,
-                                                   gr::blocks::FORMAT_PCM_16 
-                                                ); 
-
-    // Conectar bloques
-    tb->connect(rand_src, 0, uchar_to_float, 0);
-    tb->connect(uchar_to_float, 0, map_to_bipolar, 0);
-    tb->connect(map_to_bipolar, 0, scale_to_pm, 0);
-    tb->connect(scale_to_pm, 0, bb_pm, 0);
-    tb->connect(bb_pm, 0, msk_mod, 0);
-    tb->connect(msk_mod, 0, mixer, 0);
-    tb->connect(mixer_osc, 0, mixer, 1);
-    tb->connect(mixer, 0, c2ff, 0); // Tomar parte real: y = I*cos(th) - Q*sin(th)
-    tb->connect(c2ff, 0, head, 0);
-    tb->connect(head, 0, wav_sink, 0);
-
-    // Ejecutar flujo
-    tb->start();
-    tb->wait();
-    tb->stop();
-
-    std::cout << "Archivo WAV generado: " << archivo_wav << " con " << num_muestras << " muestras." << std::endl;
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+    // Semilla de los bits; con 0 GNU Radio la toma del reloj. Con otra semilla
+    // msk_demod_bench --wav puede regenerar los bits y medir la BER.
+    const unsigned semilla = static_cast<unsigned>(tomar_valor(argc, argv, "--semilla", 0));
+    const double bit_rate = tomar_valor(argc, argv, "--bps", 200.0);
+    const double fc = tomar_valor(argc, argv, "--fc", 800.0); // Frecuencia de la portadora (Hz)
+    // Muestras por símbolo del modulador (0: automático, ver disenar())
+    const int sps_pedido = static_cast<int>(tomar_valor(argc, argv, "--sps", 0));
+    // Formato del archivo (PCM de 16 bits por omisión) y dither TPDF
+    const bool pcm24 = tomar_opcion(argc, argv, "--pcm24");
+    const bool pcm32 = tomar_opcion(argc, argv, "--pcm32");
+    const bool en_float = tomar_opcion(argc, argv, "--float");
+    const bool dither = tomar_opcion(argc, argv, "--dither");
+    // Modo por lotes
+    const std::string manifiesto = tomar_texto(argc, argv, "--lote", "");
+    const std::string rejilla = tomar_texto(argc, argv, "--rejilla", "");
+    const std::string dir = tomar_texto(argc, argv, "--dir", ".");
+    const int hilos = static_cast<int>(
+        tomar_valor(argc, argv, "--hilos", std::max(1u, std::thread::hardware_concurrency())));
+
+    const auto fmt = en_float ? wav_sink::formato::FLOAT
+                     : pcm32  ? wav_sink::formato::PCM32
+                     : pcm24  ? wav_sink::formato::PCM24
+                              : wav_sink::formato::PCM16;
+
+    if (!manifiesto.empty() || !rejilla.empty()) {
+        try {
+            std::vector<trabajo> trabajos =
+                manifiesto.empty() ? expandir_rejilla(rejilla, dir) : leer_manifiesto(manifiesto);
+            for (trabajo& t : trabajos) {
+                if (t.semilla == 0) {
+                    t.semilla = semilla_de_nombre(t.archivo);
+                }
+            }
+            return procesar_lote(trabajos, std::max(1, hilos), sps_pedido, fmt, dither, dir + "/indice.csv");
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (argc < 4) {
+        std::cerr << "Uso: " << argv[0] << " " << opciones_scheduler::AYUDA
+                  << " [--semilla N] [--bps B] [--fc F] [--sps N] [--pcm24 | --pcm32 | --float] [--dither]"
+                  << " <duración_segundos> <sample_rate> <archivo_wav>\n"
+                  << "     " << argv[0] << " [--hilos N] [--dir D] [--sps N] [formato] --lote manifiesto.txt\n"
+                  << "     " << argv[0] << " [--hilos N] [--dir D] [--sps N] [formato] --rejilla"
+                  << " \"semilla=1:10 fs=44100,48000 bps=200 fc=800 dur=60\"" << std::endl;
+        return 1;
+    }
+
+    // Duración en segundos y nombre de archivo WAV
+    trabajo t;
+    t.duracion = std::stod(argv[1]);
+    t.samp_rate = std::stod(argv[2]);
+    t.archivo = argv[3];
+    t.semilla = semilla;
+    t.bit_rate = bit_rate;
+    t.fc = fc;
+
+    diseno d;
+    try {
+        d = disenar(t, sps_pedido);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (d.banco) {
+        std::cout << "Modulación a " << t.bit_rate * d.sps << " Hz (" << d.sps
+                  << " muestras por bit) y remuestreo " << d.interp << "/" << d.decim << " ("
+                  << d.banco->ntaps << " taps por fase)" << std::endl;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    uint64_t muestras;
+    try {
+        muestras = generar(t, d, fmt, dither, &sched);
+    } catch (const std::exception& e) {
+        std::cerr << t.archivo << ": " << e.what() << std::endl;
+        return 1;
+    }
+    const double segundos =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Archivo WAV generado: " << t.archivo << " con " << muestras << " muestras en "
+              << segundos << " s (" << d.bps_efectivo(t.samp_rate) << " bps)." << std::endl;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,188 @@
+// pfb_frontend_bench.cpp
+// Compara el costo de llevar N estaciones a banda base con N bloques
+// freq_xlating_fir_filter_fcc (la cadena original de msk_phase_soundcard,
+// uno por estación leyendo la misma entrada) contra un solo pfb_frontend
+// con N salidas. La entrada es ruido a 48 kHz, sin GUI ni throttle.
+//
+// Antes de medir se verifica que ambos den la misma salida: tonos dentro
+// de la banda de cada estación (incluidas portadoras cerca del borde de su
+// canal del banco) deben salir con la misma amplitud, a menos de 0.25 dB.
+// Si no, el programa termina con código 1.
+// Uso: ./pfb_frontend_bench [segundos]
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/analog/noise_source.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/filter/freq_xlating_fir_filter.h>
+
+#include "../bloques/pfb_frontend.h"
+
+// Parámetros del demodulador (los mismos que msk_phase_soundcard)
+const double samp_rate = 48000;
+const float lpf_cutoff = 400.0f;
+const float lpf_trans  = 200.0f;
+const int decimation = 8;
+
+// N portadoras repartidas entre 1 kHz y fs/2 - 1 kHz
+std::vector<pfb_estacion> repartir_estaciones(int n) {
+    std::vector<pfb_estacion> r;
+    for (int i = 0; i < n; i++) {
+        const double fc = 1000.0 + (samp_rate / 2 - 2000.0) * (i + 0.5) / n;
+        r.push_back({ "e" + std::to_string(i), fc, 2 * lpf_cutoff, 200.0 });
+    }
+    return r;
+}
+
+// Taps de freq_xlating (los de msk_phase_soundcard)
+std::vector<gr_complex> taps_xlating() {
+    auto taps = gr::filter::firdes::low_pass(
+        1.0, samp_rate, lpf_cutoff, lpf_trans, gr::fft::window::win_type::WIN_HAMMING);
+    return std::vector<gr_complex>(taps.begin(), taps.end());
+}
+
+// Amplitud del tono de f Hz en y (tasa fs) sobre n muestras desde 'inicio'
+double amplitud(const std::vector<gr_complex>& y, size_t inicio, size_t n, double f, double fs) {
+    std::complex<double> acc = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc += std::complex<double>(y[inicio + i]) * std::polar(1.0, -2 * M_PI * f * i / fs);
+    }
+    return std::abs(acc) / n;
+}
+
+// Tonos en fc + {0, ±150, ±300} Hz de cada estación (la banda plana del
+// pasa-bajas de 400 Hz) por freq_xlating y por pfb_frontend; regresa la
+// mayor diferencia de amplitud en dB
+double verificar(const std::vector<pfb_estacion>& estaciones) {
+    const double desvios[] = { -300, -150, 0, 150, 300 };
+    const double segundos = 2.0;
+    std::vector<float> x(static_cast<size_t>(segundos * samp_rate), 0.0f);
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        for (size_t j = 0; j < 5; j++) {
+            const double f = estaciones[s].fc + desvios[j];
+            const double fase = 0.7 * (5 * s + j);
+            for (size_t i = 0; i < x.size(); i++) {
+                x[i] += 0.1f * std::cos(2 * M_PI * f * i / samp_rate + fase);
+            }
+        }
+    }
+
+    auto tb = gr::make_top_block("verificacion");
+    auto src = gr::blocks::vector_source_f::make(x);
+    auto canalizador = pfb_frontend::make(samp_rate, estaciones);
+    tb->connect(src, 0, canalizador, 0);
+    std::vector<gr::blocks::vector_sink_c::sptr> pfb, xlating;
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        pfb.push_back(gr::blocks::vector_sink_c::make());
+        tb->connect(canalizador, s, pfb.back(), 0);
+        auto filtro = gr::filter::freq_xlating_fir_filter_fcc::make(
+            decimation, taps_xlating(), estaciones[s].fc, samp_rate);
+        xlating.push_back(gr::blocks::vector_sink_c::make());
+        tb->connect(src, 0, filtro, 0);
+        tb->connect(filtro, 0, xlating.back(), 0);
+    }
+    tb->run();
+
+    // Un segundo exacto (ciclos enteros de cada tono) después del transitorio
+    const double fs_canal = canalizador->tasa_salida();
+    const size_t inicio = static_cast<size_t>(0.25 * fs_canal);
+    const size_t n = static_cast<size_t>(fs_canal);
+    double peor = 0;
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        const auto& a = pfb[s]->data();
+        const auto& b = xlating[s]->data();
+        if (a.size() < inicio + n || b.size() < inicio + n) {
+            throw std::runtime_error("verificar: faltan muestras de salida");
+        }
+        double peor_estacion = 0;
+        for (double d : desvios) {
+            const double db = 20 * std::log10(amplitud(a, inicio, n, d, fs_canal) /
+                                              amplitud(b, inicio, n, d, fs_canal));
+            peor_estacion = std::max(peor_estacion, std::abs(db));
+        }
+        std::printf("  %-5s fc %8.1f Hz  canal %2d (desvío %+7.1f Hz)  máx. diferencia %.3f dB\n",
+                    estaciones[s].nombre.c_str(), estaciones[s].fc, canalizador->canal(s),
+                    estaciones[s].fc - canalizador->canal(s) * samp_rate / canalizador->canales(),
+                    peor_estacion);
+        peor = std::max(peor, peor_estacion);
+    }
+    return peor;
+}
+
+// Un freq_xlating por estación
+double correr_freq_xlating(const std::vector<pfb_estacion>& estaciones, uint64_t muestras) {
+    auto tb = gr::make_top_block("xlating");
+    auto src = gr::analog::noise_source_f::make(gr::analog::GR_GAUSSIAN, 1.0);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    tb->connect(src, 0, head, 0);
+
+    const auto complex_taps = taps_xlating();
+    for (const pfb_estacion& e : estaciones) {
+        auto xlating = gr::filter::freq_xlating_fir_filter_fcc::make(
+            decimation, complex_taps, e.fc, samp_rate);
+        tb->connect(head, 0, xlating, 0);
+        tb->connect(xlating, 0, gr::blocks::null_sink::make(sizeof(gr_complex)), 0);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    tb->run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Un canalizador para todas
+double correr_pfb(const std::vector<pfb_estacion>& estaciones, uint64_t muestras) {
+    auto tb = gr::make_top_block("pfb");
+    auto src = gr::analog::noise_source_f::make(gr::analog::GR_GAUSSIAN, 1.0);
+    auto head = gr::blocks::head::make(sizeof(float), muestras);
+    auto canalizador = pfb_frontend::make(samp_rate, estaciones);
+    tb->connect(src, 0, head, 0);
+    tb->connect(head, 0, canalizador, 0);
+    for (size_t s = 0; s < estaciones.size(); s++) {
+        tb->connect(canalizador, s, gr::blocks::null_sink::make(sizeof(gr_complex)), 0);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    tb->run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    const double segundos = argc > 1 ? std::atof(argv[1]) : 600.0;
+    const uint64_t muestras = static_cast<uint64_t>(segundos * samp_rate);
+
+    auto muestra = pfb_frontend::make(samp_rate, repartir_estaciones(1));
+    std::cout << "pfb_frontend: " << muestra->canales() << " canales, " << muestra->ntaps()
+              << " taps, salida a " << muestra->tasa_salida() << " Hz" << std::endl;
+
+    // Las 5 estaciones repartidas quedan a 0, 200 y 1400 Hz del centro de
+    // su canal; "borde" cae justo a la mitad entre dos canales
+    auto prueba = repartir_estaciones(5);
+    prueba.push_back({ "borde", 10500.0, 2 * lpf_cutoff, 200.0 });
+    std::cout << "Verificación contra freq_xlating_fir_filter_fcc:" << std::endl;
+    const double diferencia = verificar(prueba);
+    if (diferencia > 0.25) {
+        std::cerr << "pfb_frontend difiere de freq_xlating en " << diferencia << " dB" << std::endl;
+        return 1;
+    }
+
+    std::cout << muestras << " muestras (" << segundos << " s de señal a " << samp_rate << " Hz)"
+              << std::endl;
+
+    std::printf("%10s %16s %16s %12s\n", "estaciones", "freq_xlating s", "pfb_frontend s", "aceleración");
+    for (int n : { 1, 2, 5, 10, 20 }) {
+        const auto estaciones = repartir_estaciones(n);
+        const double t_xlating = correr_freq_xlating(estaciones, muestras);
+        const double t_pfb = correr_pfb(estaciones, muestras);
+        std::printf("%10d %16.3f %16.3f %11.1fx\n", n, t_xlating, t_pfb, t_xlating / t_pfb);
+    }
+    return 0;
+}
@@ -4,16 +4,24 @@
 
 #include <gnuradio/random.h>
 #include <gnuradio/top_block.h>
-#include <gnuradio/analog/random_uniform_source.h>
-#include <gnuradio/blocks/uchar_to_float.h>
-#include <gnuradio/blocks/add_const_ff.h>
-#include <gnuradio/blocks/multiply_const.h>
+#include <gnuradio/blocks/null_sink.h>
 
 #include <gnuradio/qtgui/time_sink_f.h>
 #include <QWidget>
 #include <QApplication>
 
+#include <memory>
 
+#include "../bloques/bit_source.h"
+#include "../bloques/ejecucion_headless.h"
+#include "../bloques/opciones_scheduler.h"
+
+// Con --headless no se abre ventana y el flujo corre sin throttle hasta
+// Ctrl+C (SIGINT) o SIGTERM. Acepta las opciones --gr-* de
+// bloques/opciones_scheduler.h (buffers, afinidad, tiempo real).
+//
+// --semilla N fija la secuencia (la misma en cada corrida); --prbs 9|15|23|31
+// usa una secuencia PRBS en lugar de xoshiro256**.
 int main(int argc, char** argv) {
     /*********************************************/
     /*          Generación de escalares          */
@@ -30,55 +38,78 @@ int main(int argc, char** argv) {
     /*     Generación de flujo de bits aleatorios    */
     /*************************************************/
 
-     // Inicializar Qt GUI
-     QApplication app(argc, argv);
+    // Inicializar Qt GUI (solo si hay ventana)
+    const bool headless = tomar_opcion(argc, argv, "--headless");
+    const auto sched = opciones_scheduler::tomar(argc, argv);
+    const uint64_t semilla = static_cast<uint64_t>(tomar_valor(argc, argv, "--semilla", 1));
+    const int prbs = static_cast<int>(tomar_valor(argc, argv, "--prbs", 0));
+    std::unique_ptr<QApplication> app;
+    if (!headless) {
+        app.reset(new QApplication(argc, argv));
+    }
      auto tb = gr::make_top_block("Stream de bits aleatorios");
 
-    // Crear fuente de bits aleatorios (uint8_t)
-    auto rand_src = gr::analog::random_uniform_source_b::make(0, 2, 0); // (min, max, seed)
-
-    // Convert enteros a flotantes: (+/-1)
-    auto uchar_to_float = gr::blocks::uchar_to_float::make();
-    auto map_to_bipolar = gr::blocks::add_const_ff::make(-0.5);     // 0/1 -> -0.5/0.5
-
-    // Escalamiento adacuado para el modulador de fase del próximo programa
-    auto scale_to_pm = gr::blocks::multiply_const_ff::make(2.0); // -0.5/0.5 -> -1/+1
+    // Fuente de bits aleatorios ya como símbolos +/-1 (float), la escala
+    // adecuada para el modulador de fase del próximo programa
+    bit_source::generador gen = bit_source::generador::XOSHIRO;
+    switch (prbs) {
+    case 0: break;
+    case 9: gen = bit_source::generador::PRBS9; break;
+    case 15: gen = bit_source::generador::PRBS15; break;
+    case 23: gen = bit_source::generador::PRBS23; break;
+    case 31: gen = bit_source::generador::PRBS31; break;
+    default:
+        std::cerr << "--prbs debe ser 9, 15, 23 o 31" << std::endl;
+        return 1;
+    }
+    auto bits = bit_source::make(gen, bit_source::formato::SIMBOLOS_F, semilla);
+
+    const double samp_rate = 1000.0;  // Tasa nominal (solo escala el eje de tiempo)
 
     // Crear visualizador en tiempo (QT GUI Time Sink)
-    const int size = 1024; // Muestras para mostrar
-    const double samp_rate = 1000.0; 
-    const std::string name = "Flujo de bits aleatorios";
-    const unsigned int nconnections = 1;
-
-    auto time_sink = gr::qtgui::time_sink_f::make(size, samp_rate, name, nconnections, nullptr);
-    time_sink->set_update_time(0.10);    
-    time_sink->set_y_axis(-1.5, 1.5);   
-    time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
-    time_sink->enable_grid(true);
-    time_sink->set_y_label("Amplitud", "");
-    time_sink->set_line_label(0, "Bitstream");
-    time_sink->set_line_color(0, "blue");
-    time_sink->enable_control_panel(true);
-    time_sink->enable_tags(0, false);
-
-    // Mostrar GUI
-    time_sink->qwidget()->show();
+    gr::block_sptr sink;
+    if (!headless) {
+        const int size = 1024; // Muestras para mostrar
+        const std::string name = "Flujo de bits aleatorios";
+        const unsigned int nconnections = 1;
+
+        auto time_sink = gr::qtgui::time_sink_f::make(size, samp_rate, name, nconnections, nullptr);
+        time_sink->set_update_time(0.10);
+        time_sink->set_y_axis(-1.5, 1.5);
+        time_sink->enable_autoscale(false);  // Mantener rango de ejes fijos
+        time_sink->enable_grid(true);
+        time_sink->set_y_label("Amplitud", "");
+        time_sink->set_line_label(0, "Bitstream");
+        time_sink->set_line_color(0, "blue");
+        time_sink->enable_control_panel(true);
+        time_sink->enable_tags(0, false);
+
+        // Mostrar GUI
+        time_sink->qwidget()->show();
+        sink = time_sink;
+    } else {
+        // Sin ventana la salida se descarta; solo se mide el rendimiento
+        sink = gr::blocks::null_sink::make(sizeof(float));
+    }
 
     // Conectar bloques
-    tb->connect(rand_src, 0, uchar_to_float, 0);
-    tb->connect(uchar_to_float, 0, map_to_bipolar, 0);
-    tb->connect(map_to_bipolar, 0, scale_to_pm, 0);
-    tb->connect(scale_to_pm, 0, time_sink, 0);
-
-    // Iniciar flowgraph
-    tb->start();
-
-    // Correr loop de Qt
-    app.exec();
-
-    // Detener flujo cuando se cierre la ventana de Qt
-    tb->stop();
-    tb->wait();
+    tb->connect(bits, 0, sink, 0);
+    sched.aplicar(tb, { bits, sink });
+
+    if (headless) {
+        // Generar hasta recibir una señal de terminación
+        ejecutar_headless(tb, bits, samp_rate, false);
+    } else {
+        // Iniciar flowgraph
+        tb->start();
+
+        // Correr loop de Qt
+        app->exec();
+
+        // Detener flujo cuando se cierre la ventana de Qt
+        tb->stop();
+        tb->wait();
+    }
 
     return 0;
 }
@@ -7,7 +7,13 @@
 #include <thread>
 #include <iostream>
 
-int main() {
+#include "bloques/opciones_scheduler.h"
+
+// Acepta las opciones --gr-* de bloques/opciones_scheduler.h, por ejemplo
+// para comprobar que el usuario puede pedir prioridad de tiempo real:
+//   ./verify_gnu_radio --gr-tiempo-real --gr-cpus 1
+int main(int argc, char** argv) {
+    const auto sched = opciones_scheduler::tomar(argc, argv);
     std::cout << "Iniciando flowgraph de GNU Radio..." << std::endl;
 
     double samp_rate = 32000;
@@ -33,6 +39,7 @@ int main() {
     // (0 es el puerto de salida, 0 es el puerto de entrada)
     tb->connect(src, 0, throttle, 0);
     tb->connect(throttle, 0, sink, 0);
+    sched.aplicar(tb, { src, throttle, sink });
 
     // Crear e iniciar el hilo del flowgraph
     tb->start();